@@ -2,6 +2,7 @@
 * @file BoardModel.cpp
 */
 #include "BoardModel.hpp"
+#include "Materials.hpp"
 
 using peek::PI;
 
@@ -21,9 +22,15 @@ namespace quarto {
 	const unsigned int BoardModel::numBoardBorderConcentricSegments = 5;
 	const unsigned int BoardModel::numBoardBorderSegments = 20;
 	
-	BoardModel::BoardModel() {
+	BoardModel::BoardModel(const MeshData::list &meshes) {
+		setOrigin(Point3d(0.0, 0.0, 0.0));
 
-		generateModel();
+		static const SurfaceMaterial *const materials[NUM_MESH_MATERIALS] = { &boardSurfMaterial, &boardGrooveMaterial };
+
+		reserveMeshes(meshes.size());
+		for(MeshData::list::const_iterator i = meshes.begin(); i != meshes.end(); ++i) {
+			addMesh(TriangleMesh::handle(new TriangleMesh(*i)), materials, NUM_MESH_MATERIALS);
+		}
 	}
 
 	/**
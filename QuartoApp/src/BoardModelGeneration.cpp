@@ -2,22 +2,10 @@
 * @file BoardModelGeneration.cpp
 */
 #include "BoardModel.hpp"
-#include "Materials.hpp"
-#include <Triangle.hpp>
-#include <Quadrilateral.hpp>
-#include <TriangleFan.hpp>
-#include <TriangleStrip.hpp>
-#include <SmoothMesh.hpp>
+#include "UnitCircleTable.hpp"
 
 using peek::PI;
 using peek::Vector3d;
-using peek::parametricUnitCircle;
-using peek::Primitive;
-using peek::Triangle;
-using peek::Quadrilateral;
-using peek::TriangleFan;
-using peek::TriangleStrip;
-using peek::SmoothMesh;
 
 namespace {
 
@@ -31,161 +19,196 @@ namespace {
 	const double boardRadius = BoardModel::boardRadius;
 	const double markerSpacing = BoardModel::markerSpacing;
 	const unsigned int markerMatrixSize = BoardModel::markerMatrixSize;
-	const unsigned int numMarkerQuarterSegments = BoardModel::numMarkerQuarterSegments;
-	const unsigned int numMarkerConcentricSegments = BoardModel::numMarkerConcentricSegments;
-	const unsigned int numMarkerBorderConcentricSegments = BoardModel::numMarkerBorderConcentricSegments;
-	const unsigned int numBoardBorderConcentricSegments = BoardModel::numBoardBorderConcentricSegments;
-	const unsigned int numBoardBorderSegments = BoardModel::numBoardBorderSegments;
+
+	const Vector3d up(0.0, 0.0, 1.0);
 	
-	void generateMarkerMeshes(Model *pModel);
-	void generateMarkerBorderMeshes(Model *pModel);
-	void generateMarkerBoundingBoxMeshes(Model *pModel);
-	void generateInterMarkerBoundingBoxMeshes(Model *pModel);
-	void generateBoardBorderMesh(Model *pModel);
-	void generateBoardBorderPaddingMesh(Model *pModel);
-
-	unsigned int markerCenterIndex;
-	void generateMarkerCenterVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex markerCenterVert(unsigned int i, unsigned int j);
-
-	unsigned int markerConcentricIndex;
-	void generateMarkerConcentricVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex markerConcentricVert(unsigned int i, unsigned int j,
-		unsigned int k, unsigned int l);
-	inline Vertex3d::listIndex markerEdgeVert(unsigned int i, unsigned int j,
-		unsigned int k);
-
-	unsigned int markerBorderIndex;
-	void generateMarkerBorderVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex markerBorderVert(unsigned int i, unsigned int j,
-		unsigned int k, unsigned int l);
-
-	unsigned int markerBorderEdgeIndex;
-	void generateMarkerBorderEdgeVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex markerBorderEdgeVert(unsigned int i, unsigned int j,
-		unsigned int k);
-
-	unsigned int markerBoundingBoxIndex;
-	void generateMarkerBoundingBoxVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex markerBoundingBoxVert(unsigned int i, unsigned int j,
-		unsigned int k, int l);
-
-	unsigned int boardBorderIndex;
-	void generateBoardBorderVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex boardBorderVert(unsigned int k, unsigned int l);
-
-	unsigned int boardBorderInsideIndex;
-	void generateBoardBorderInsideVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex boardBorderInsideVert(unsigned int k);
-
-	unsigned int boardBorderOutsideIndex;
-	void generateBoardBorderOutsideVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex boardBorderOutsideVert(unsigned int k);
-
-	unsigned int boardEdgeTopIndex;
-	void generateBoardEdgeTopVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex boardEdgeTopVert(unsigned int k);
-
-	unsigned int markerMatrixPerimeterIndex;
-	void generateMarkerMatrixPerimeterVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex markerMatrixPerimeterVert(unsigned int l);
-
-	void generateMarkerMeshes(Model *pModel) {
+	/**
+	 * @param n The side of the board, counterclockwise from the first corner
+	 * @param numSegments The number of points around the corner
+	 * @param cornerAngle The portion of the circle each rounded corner spans
+	 * @return The points around the board's nth corner
+	 */
+	const UnitCircleTable &getBoardCornerCircle(unsigned int n, unsigned int numSegments, double cornerAngle) {
+		return UnitCircleTable::get(numSegments, cornerAngle / (double)numSegments,
+			(double)n * 0.25 - cornerAngle / 2.0);
+	}
+
+	/**
+	 * @param n The side of the board, counterclockwise from the first corner
+	 * @param numSegments The number of points along the side
+	 * @return The points along the board's nth side, which starts where the nth corner ends
+	 */
+	const UnitCircleTable &getBoardSideCircle(unsigned int n, unsigned int numSegments, double cornerAngle, double sideAngle) {
+		return UnitCircleTable::get(numSegments, sideAngle / (double)numSegments, (double)n * 0.25 + cornerAngle / 2.0);
+	}
+
+	/**
+	 * @brief Generates the mesh of the board
+	 *
+	 * Each board gets its own generator, so boards can be generated alongside
+	 * other models. The segment counts are those of the generator's level of
+	 * detail.
+	 *
+	 * The surface and the grooves share one pool of vertices, each ring of
+	 * which is generated once. Where a groove meets the surface the groove
+	 * keeps its own ring, at the same points, so the crease stays sharp;
+	 * faces of one material that meet share their vertices. The surface is
+	 * flat, and each groove is an arc swept around a marker or the board, so
+	 * every vertex is given the exact normal of its surface.
+	 */
+	class BoardGenerator {
+	public:
+
+		explicit BoardGenerator(unsigned int level);
+
+		void generate(MeshData::list &meshes);
+
+	private:
+
+		const unsigned int numMarkerQuarterSegments;
+		const unsigned int numMarkerConcentricSegments;
+		const unsigned int numMarkerBorderConcentricSegments;
+		const unsigned int numBoardBorderConcentricSegments;
+
+		/** A whole turn around a marker, starting at its first vertex */
+		const UnitCircleTable &markerCircle;
+		/** The corners of a marker's bounding box */
+		const UnitCircleTable &quarterCircle;
+
+		void generateMarkerFaces(MeshData &mesh);
+		void generateMarkerBorderFaces(MeshData &mesh);
+		void generateMarkerBoundingBoxFaces(MeshData &mesh);
+		void generateInterMarkerBoundingBoxFaces(MeshData &mesh);
+		void generateBoardBorderFaces(MeshData &mesh);
+		void generateBoardBorderPaddingFaces(MeshData &mesh);
+
+		unsigned int markerCenterIndex;
+		void generateMarkerCenterVerts(MeshData &mesh);
+		inline Vertex3d::listIndex markerCenterVert(unsigned int i, unsigned int j) const;
+
+		unsigned int markerConcentricIndex;
+		void generateMarkerConcentricVerts(MeshData &mesh);
+		inline Vertex3d::listIndex markerConcentricVert(unsigned int i, unsigned int j,
+			unsigned int k, unsigned int l) const;
+		inline Vertex3d::listIndex markerEdgeVert(unsigned int i, unsigned int j,
+			unsigned int k) const;
+
+		unsigned int markerBorderIndex;
+		void generateMarkerBorderVerts(MeshData &mesh);
+		inline Vertex3d::listIndex markerBorderVert(unsigned int i, unsigned int j,
+			unsigned int k, unsigned int l) const;
+
+		unsigned int markerBorderEdgeIndex;
+		void generateMarkerBorderEdgeVerts(MeshData &mesh);
+		inline Vertex3d::listIndex markerBorderEdgeVert(unsigned int i, unsigned int j,
+			unsigned int k) const;
+
+		unsigned int markerBoundingBoxIndex;
+		void generateMarkerBoundingBoxVerts(MeshData &mesh);
+		inline Vertex3d::listIndex markerBoundingBoxVert(unsigned int i, unsigned int j,
+			unsigned int k, int l) const;
+
+		unsigned int boardBorderIndex;
+		void generateBoardBorderVerts(MeshData &mesh);
+		inline Vertex3d::listIndex boardBorderVert(unsigned int k, unsigned int l) const;
+
+		unsigned int boardBorderInsideIndex;
+		void generateBoardBorderInsideVerts(MeshData &mesh);
+		inline Vertex3d::listIndex boardBorderInsideVert(unsigned int k) const;
+
+		unsigned int boardBorderOutsideIndex;
+		void generateBoardBorderOutsideVerts(MeshData &mesh);
+		inline Vertex3d::listIndex boardBorderOutsideVert(unsigned int k) const;
+
+		unsigned int boardEdgeTopIndex;
+		void generateBoardEdgeTopVerts(MeshData &mesh);
+		inline Vertex3d::listIndex boardEdgeTopVert(unsigned int k) const;
+
+		/** The marker border edge and bounding box vertices around the whole matrix of markers */
+		std::vector<Vertex3d::listIndex> markerMatrixPerimeter;
+		void mapMarkerMatrixPerimeterVerts();
+		inline Vertex3d::listIndex markerMatrixPerimeterVert(unsigned int l) const;
+
+	};
+
+	BoardGenerator::BoardGenerator(unsigned int level)
+		: numMarkerQuarterSegments(getEvenDetailSegments(BoardModel::numMarkerQuarterSegments, level, 2)),
+		numMarkerConcentricSegments(getDetailSegments(BoardModel::numMarkerConcentricSegments, level, 1)),
+		numMarkerBorderConcentricSegments(getDetailSegments(BoardModel::numMarkerBorderConcentricSegments, level, 2)),
+		numBoardBorderConcentricSegments(getDetailSegments(BoardModel::numBoardBorderConcentricSegments, level, 2)),
+		markerCircle(UnitCircleTable::get(numMarkerQuarterSegments * 4, -0.125)),
+		quarterCircle(UnitCircleTable::get(4)) {
+	}
+
+	void BoardGenerator::generate(MeshData::list &meshes) {
 
 		// Generate vertices...
-		Vertex3d::list verts;
-		generateMarkerCenterVerts(verts);
-		generateMarkerConcentricVerts(verts);
+		MeshData mesh;
+		generateMarkerCenterVerts(mesh);
+		generateMarkerConcentricVerts(mesh);
+		generateMarkerBorderVerts(mesh);
+		generateMarkerBorderEdgeVerts(mesh);
+		generateMarkerBoundingBoxVerts(mesh);
+		generateBoardBorderVerts(mesh);
+		generateBoardBorderInsideVerts(mesh);
+		mapMarkerMatrixPerimeterVerts();
 
 		// Generate faces...
-		
-		Primitive::list primitives;
+		mesh.setMaterial(BoardModel::SURFACE_MATERIAL);
+		generateMarkerFaces(mesh);
+		generateMarkerBoundingBoxFaces(mesh);
+		generateInterMarkerBoundingBoxFaces(mesh);
+		generateBoardBorderPaddingFaces(mesh);
+
+		mesh.setMaterial(BoardModel::GROOVE_MATERIAL);
+		generateMarkerBorderFaces(mesh);
+		generateBoardBorderFaces(mesh);
+
+		meshes.push_back(mesh);
+	}
 
+	void BoardGenerator::generateMarkerFaces(MeshData &mesh) {
 		for(unsigned int i = 0; i < markerMatrixSize; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize; j++) {
-				TriangleFan::handle triangleFan(new TriangleFan());
+				mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
 
-				triangleFan->addVertex(markerCenterVert(i, j));
+				mesh.addIndex(markerCenterVert(i, j));
 				for(unsigned int k = 0; k <= (numMarkerQuarterSegments * 4); k++) {
-					triangleFan->addVertex(markerConcentricVert(i, j, k, 0));
+					mesh.addIndex(markerConcentricVert(i, j, k, 0));
 				}
 
-				primitives.push_back(triangleFan);
-
 				for(unsigned int l = 0; l < numMarkerConcentricSegments-1; l++) {
-					TriangleStrip::handle triangleStrip(new TriangleStrip());
+					mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 					for(unsigned int k = 0; k <= (numMarkerQuarterSegments * 4); k++) {
-						triangleStrip->addVertex(markerConcentricVert(i, j, k, l));
-						triangleStrip->addVertex(markerConcentricVert(i, j, k, l+1));
+						mesh.addIndex(markerConcentricVert(i, j, k, l));
+						mesh.addIndex(markerConcentricVert(i, j, k, l+1));
 					}
-
-					primitives.push_back(triangleStrip);
 				}
 			}
 		}
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, boardSurfMaterial)));
 	}
 
-	void generateMarkerBorderMeshes(Model *pModel) {
-
-		// Generate vertices...
-		Vertex3d::list verts;
-		generateMarkerConcentricVerts(verts);
-		generateMarkerBorderVerts(verts);
-		generateMarkerBorderEdgeVerts(verts);
-
-		// Generate faces...
-		
-		Primitive::list primitives;
-
+	/**
+	 * The groove's first and last rings lie on the marker's edge and on the
+	 * marker border's edge, but are the groove's own vertices.
+	 */
+	void BoardGenerator::generateMarkerBorderFaces(MeshData &mesh) {
 		for(unsigned int i = 0; i < markerMatrixSize; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize; j++) {
-				TriangleStrip::handle triangleStrip(new TriangleStrip());
-				for(unsigned int k = 0; k <= (numMarkerQuarterSegments * 4); k++) {
-					triangleStrip->addVertex(markerEdgeVert(i, j, k));
-					triangleStrip->addVertex(markerBorderVert(i, j, k, 1));
-				}
-
-				primitives.push_back(triangleStrip);
-
-				for(unsigned int l = 1; l < numMarkerBorderConcentricSegments-1; l++) {
-					triangleStrip = TriangleStrip::handle(new TriangleStrip());
+				for(unsigned int l = 0; l < numMarkerBorderConcentricSegments; l++) {
+					mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 					for(unsigned int k = 0; k <= (numMarkerQuarterSegments * 4); k++) {
-						triangleStrip->addVertex(markerBorderVert(i, j, k, l));
-						triangleStrip->addVertex(markerBorderVert(i, j, k, l+1));
+						mesh.addIndex(markerBorderVert(i, j, k, l));
+						mesh.addIndex(markerBorderVert(i, j, k, l+1));
 					}
-
-					primitives.push_back(triangleStrip);
-				}
-
-				triangleStrip = TriangleStrip::handle(new TriangleStrip());
-
-				for(unsigned int k = 0; k <= (numMarkerQuarterSegments * 4); k++) {
-					triangleStrip->addVertex(markerBorderVert(i, j, k, numMarkerBorderConcentricSegments-1));
-					triangleStrip->addVertex(markerBorderEdgeVert(i, j, k));
 				}
-
-				primitives.push_back(triangleStrip);
 			}
 		}
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, boardGrooveMaterial)));
 	}
 
-	void generateMarkerBoundingBoxMeshes(Model *pModel) {
-
-		// Generate vertices...
-		Vertex3d::list verts;
-		generateMarkerBorderEdgeVerts(verts);
-		generateMarkerBoundingBoxVerts(verts);
-
-		// Generate faces...
-		
-		Primitive::list primitives;
-
+	void BoardGenerator::generateMarkerBoundingBoxFaces(MeshData &mesh) {
 		for(unsigned int i = 0; i < markerMatrixSize; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize; j++) {
 				for(unsigned int k = 0; k < 4; k++) {
@@ -196,121 +219,81 @@ namespace {
 						(i == 0 && j == x && k == 2))
 						continue;
 
-					TriangleStrip::handle triangleStrip(new TriangleStrip());
+					mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 					
 					for(unsigned int l = 0; l <= numMarkerQuarterSegments; l++) {
 						int h = ((int) numMarkerQuarterSegments) / 2;
 						int g = (int)l - (int)h;
 
-						triangleStrip->addVertex(markerBoundingBoxVert(i, j, k, g));
+						mesh.addIndex(markerBoundingBoxVert(i, j, k, g));
 						if (l == 0 || l == numMarkerQuarterSegments) continue;
-						triangleStrip->addVertex(markerBorderEdgeVert(i, j, k*numMarkerQuarterSegments+l));
+						mesh.addIndex(markerBorderEdgeVert(i, j, k*numMarkerQuarterSegments+l));
 					}
-
-					primitives.push_back(triangleStrip);
 				}
 			}
 		}
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, boardSurfMaterial)));
 	}
 
-	void generateInterMarkerBoundingBoxMeshes(Model *pModel) {
-
-		// Generate vertices...
-		Vertex3d::list verts;
-		generateMarkerBorderEdgeVerts(verts);
-		generateMarkerBoundingBoxVerts(verts);
-
-		// Generate faces...
-		
-		Primitive::list primitives;
-
+	void BoardGenerator::generateInterMarkerBoundingBoxFaces(MeshData &mesh) {
 		for(unsigned int i = 0; i < markerMatrixSize-1; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize-1; j++) {
 				Vertex3d::listIndex v1 = markerBoundingBoxVert(i, j, 1, 0);
 				Vertex3d::listIndex v2 = markerBoundingBoxVert(i+1, j, 2, 0);
 				Vertex3d::listIndex v3 = markerBoundingBoxVert(i+1, j+1, 3, 0);
 				Vertex3d::listIndex v4 = markerBoundingBoxVert(i, j+1, 0, 0);
-				primitives.push_back(Quadrilateral::handle(new Quadrilateral(v1, v2, v3, v4)));
+				mesh.addQuadrilateral(v1, v2, v3, v4);
 			}
 		}
 
 		for(unsigned int i = 0; i < markerMatrixSize-1; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize; j++) {
-				TriangleStrip::handle triangleStrip(new TriangleStrip());
+				mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 				for(unsigned int k = 0; k <= numMarkerQuarterSegments; k++) {
-					triangleStrip->addVertex(markerBoundingBoxVert(i, j, 0, k));
-					triangleStrip->addVertex(markerBoundingBoxVert(i+1, j, 3, -(int)k));
+					mesh.addIndex(markerBoundingBoxVert(i, j, 0, k));
+					mesh.addIndex(markerBoundingBoxVert(i+1, j, 3, -(int)k));
 				}
-
-				primitives.push_back(triangleStrip);
 			}
 		}
 
 		for(unsigned int i = 0; i < markerMatrixSize; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize-1; j++) {
-				TriangleStrip::handle triangleStrip(new TriangleStrip());
+				mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 				for(unsigned int k = 0; k <= numMarkerQuarterSegments; k++) {
-					triangleStrip->addVertex(markerBoundingBoxVert(i, j, 1, k));
-					triangleStrip->addVertex(markerBoundingBoxVert(i, j+1, 0, -(int)k));
+					mesh.addIndex(markerBoundingBoxVert(i, j, 1, k));
+					mesh.addIndex(markerBoundingBoxVert(i, j+1, 0, -(int)k));
 				}
-
-				primitives.push_back(triangleStrip);
 			}
 		}
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, boardSurfMaterial)));
 	}
 
-	void generateBoardBorderMesh(Model *pModel) {
-
-		// Generate vertices...
-		Vertex3d::list verts;
-		generateBoardBorderVerts(verts);
-
-		// Generate faces...
-		
-		Primitive::list primitives;
-
+	void BoardGenerator::generateBoardBorderFaces(MeshData &mesh) {
 		unsigned int numBoardBorderSegments = 4*((markerMatrixSize-1)*(numMarkerQuarterSegments+1) + numMarkerQuarterSegments);
 		for(unsigned int l = 0; l < numBoardBorderConcentricSegments; l++) {
-			TriangleStrip::handle triangleStrip(new TriangleStrip());
+			mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 			
 			for(unsigned int k = 0; k <= numBoardBorderSegments; k++) {
-				triangleStrip->addVertex(boardBorderVert(k, l));
-				triangleStrip->addVertex(boardBorderVert(k, l+1));
+				mesh.addIndex(boardBorderVert(k, l));
+				mesh.addIndex(boardBorderVert(k, l+1));
 			}
-
-			primitives.push_back(triangleStrip);
 		}
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, boardGrooveMaterial)));
 	}
 
-	void generateBoardBorderPaddingMesh(Model *pModel) {
-
-		// Generate vertices...
-		Vertex3d::list verts;
-		generateMarkerMatrixPerimeterVerts(verts);
-		generateBoardBorderInsideVerts(verts);
-
-		// Generate faces...
-		
-		Primitive::list primitives;
-
+	/**
+	 * The padding's inner edge is the marker matrix's perimeter, whose
+	 * vertices the markers' bounding box faces also use. Its outer edge lies
+	 * on the board border groove but is the padding's own.
+	 */
+	void BoardGenerator::generateBoardBorderPaddingFaces(MeshData &mesh) {
 		unsigned int numBoardBorderSegments = 4 * ((markerMatrixSize-1)*(numMarkerQuarterSegments+1) + numMarkerQuarterSegments);
-		TriangleStrip::handle triangleStrip(new TriangleStrip());	
+		mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 		for(unsigned int i = 0; i <= numBoardBorderSegments; i++) {
-			triangleStrip->addVertex(markerMatrixPerimeterVert(i));
-			triangleStrip->addVertex(boardBorderInsideVert(i));
+			mesh.addIndex(markerMatrixPerimeterVert(i));
+			mesh.addIndex(boardBorderInsideVert(i));
 		}
 
-		primitives.push_back(triangleStrip);
-
 		/*
 		unsigned int numBoardBorderSegments = 4*(3*markerMatrixSize-3 + numMarkerQuarterSegments);
 		for(unsigned int n = 0; n < 4; n++) {
@@ -348,15 +331,13 @@ namespace {
 			faces.push_back(Triangle(v3, v2, v4));
 		}
 		*/
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, boardSurfMaterial)));
 	}
 
-	void generateMarkerCenterVerts(Vertex3d::list &verts) {
-		markerCenterIndex = (unsigned int)verts.size();
+	void BoardGenerator::generateMarkerCenterVerts(MeshData &mesh) {
+		this->markerCenterIndex = (unsigned int)mesh.getNumVertices();
 		for(unsigned int i = 0; i < markerMatrixSize; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize; j++) {
-				verts.push_back(BoardModel::getMarkerPosition(i, j));
+				mesh.addVertex(BoardModel::getMarkerPosition(i, j), up);
 			}
 		}
 	}
@@ -366,25 +347,24 @@ namespace {
 	 * @param j The j-coordinate of the desired marker
 	 * @return The index of the requested marker center vertex
 	 */
-	inline Vertex3d::listIndex markerCenterVert(unsigned int i, unsigned int j) {
-		return markerCenterIndex
+	inline Vertex3d::listIndex BoardGenerator::markerCenterVert(unsigned int i, unsigned int j) const {
+		return this->markerCenterIndex
 			+ (i % markerMatrixSize) * markerMatrixSize 
 			+ (j % markerMatrixSize);
 	}
 
-	void generateMarkerConcentricVerts(Vertex3d::list &verts) {
+	void BoardGenerator::generateMarkerConcentricVerts(MeshData &mesh) {
 		double r = markerRadius / (double) numMarkerConcentricSegments;
 
-		markerConcentricIndex = (unsigned int)verts.size();
+		this->markerConcentricIndex = (unsigned int)mesh.getNumVertices();
 		for(unsigned int i = 0; i < markerMatrixSize; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize; j++) {
 				Point3d markerCenterPoint = BoardModel::getMarkerPosition(i, j);
 				for(unsigned int k = 0; k < (numMarkerQuarterSegments * 4); k++) {
-					double t = (double)k/(double)(numMarkerQuarterSegments * 4) - 0.125;
 					for (unsigned int l = 1; l < numMarkerConcentricSegments; l++) {
-						verts.push_back(markerCenterPoint + ((double)l*r) * parametricUnitCircle(t));
+						mesh.addVertex(markerCenterPoint + ((double)l*r) * this->markerCircle[k], up);
 					}
-					verts.push_back(markerCenterPoint + markerRadius * parametricUnitCircle(t));
+					mesh.addVertex(markerCenterPoint + markerRadius * this->markerCircle[k], up);
 				}
 			}
 		}
@@ -397,8 +377,8 @@ namespace {
 	 * @param l The index of the marker's desired concentric ring
 	 * @return The index of the requested marker edge vertex
 	 */
-	inline Vertex3d::listIndex markerConcentricVert(unsigned int i, unsigned int j, unsigned int k, unsigned int l) {
-		return markerConcentricIndex
+	inline Vertex3d::listIndex BoardGenerator::markerConcentricVert(unsigned int i, unsigned int j, unsigned int k, unsigned int l) const {
+		return this->markerConcentricIndex
 			+ (i % markerMatrixSize) * markerMatrixSize * numMarkerQuarterSegments * 4 * numMarkerConcentricSegments
 			+ (j % markerMatrixSize) * numMarkerQuarterSegments * 4 * numMarkerConcentricSegments
 			+ (k % (numMarkerQuarterSegments * 4)) * numMarkerConcentricSegments
@@ -411,28 +391,33 @@ namespace {
 	 * @param k The index of the marker's desired edge vertex
 	 * @return The index of the requested marker edge vertex
 	 */
-	inline Vertex3d::listIndex markerEdgeVert(unsigned int i, unsigned int j, unsigned int k) {
+	inline Vertex3d::listIndex BoardGenerator::markerEdgeVert(unsigned int i, unsigned int j, unsigned int k) const {
 		return markerConcentricVert(i, j, k, numMarkerConcentricSegments-1);
 	}
 
-	void generateMarkerBorderVerts(Vertex3d::list &verts) {
+	/**
+	 * The groove's profile is an arc whose center lies above the board, so
+	 * its normal points from each vertex toward the arc's center.
+	 */
+	void BoardGenerator::generateMarkerBorderVerts(MeshData &mesh) {
 		static const double markerBorderRadius = sqrt(pow(markerBorderThickness/2.0, 2.0) + pow(markerBorderDepthOffset, 2.0));
 		static const double d = acos(markerBorderDepthOffset / markerBorderRadius) / (2.0 * PI);
+		const UnitCircleTable &profile = UnitCircleTable::get(numMarkerBorderConcentricSegments + 1,
+			2.0 * d / (double)numMarkerBorderConcentricSegments, 0.25 - d);
 
-		markerBorderIndex = (unsigned int)verts.size();
+		this->markerBorderIndex = (unsigned int)mesh.getNumVertices();
 		for(unsigned int i = 0; i < markerMatrixSize; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize; j++) {
 				Point3d markerCenterPoint = BoardModel::getMarkerPosition(i, j);
 				for(unsigned int k = 0; k < (numMarkerQuarterSegments * 4); k++) {
-					double t = (double)k / (double)(numMarkerQuarterSegments * 4) - 0.125;
 					for(unsigned int l = 0; l <= numMarkerBorderConcentricSegments; l++) {
-						double u = (double)l / (double)numMarkerBorderConcentricSegments;
-						Vector3d v = markerBorderRadius * parametricUnitCircle(2.0 * u * d + (0.25 - d));
+						Vector3d v = markerBorderRadius * profile[l];
 						double radius = markerRadius + markerBorderThickness/2.0 - v.x;
 						double dip = markerBorderDepthOffset - v.y;
-						verts.push_back(markerCenterPoint
-							+ radius * parametricUnitCircle(t)
-							+ Vector3d(0, 0, dip));
+						Vector3d normal(profile[l].x * this->markerCircle[k].x, profile[l].x * this->markerCircle[k].y, profile[l].y);
+						mesh.addVertex(markerCenterPoint
+							+ radius * this->markerCircle[k]
+							+ Vector3d(0, 0, dip), normal);
 					}
 				}
 			}
@@ -446,24 +431,23 @@ namespace {
 	 * @param l The border-index of the marker's desired border vertex
 	 * @return The index of the requested marker border vertex
 	 */
-	inline Vertex3d::listIndex markerBorderVert(unsigned int i, unsigned int j, unsigned int k, unsigned int l) {
-		return markerBorderIndex
+	inline Vertex3d::listIndex BoardGenerator::markerBorderVert(unsigned int i, unsigned int j, unsigned int k, unsigned int l) const {
+		return this->markerBorderIndex
 			+ (i % markerMatrixSize) * markerMatrixSize * numMarkerQuarterSegments * 4 * (numMarkerBorderConcentricSegments+1)
 			+ (j % markerMatrixSize) * numMarkerQuarterSegments * 4 * (numMarkerBorderConcentricSegments+1)
 			+ (k % (numMarkerQuarterSegments * 4)) * (numMarkerBorderConcentricSegments+1)
 			+ (l % (numMarkerBorderConcentricSegments+1));
 	}
 
-	void generateMarkerBorderEdgeVerts(Vertex3d::list &verts) {
+	void BoardGenerator::generateMarkerBorderEdgeVerts(MeshData &mesh) {
 		double radius = markerRadius + markerBorderThickness;
 
-		markerBorderEdgeIndex = (unsigned int)verts.size();
+		this->markerBorderEdgeIndex = (unsigned int)mesh.getNumVertices();
 		for(unsigned int i = 0; i < markerMatrixSize; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize; j++) {
 				Point3d markerCenterPoint = BoardModel::getMarkerPosition(i, j);
 				for(unsigned int k = 0; k < (numMarkerQuarterSegments * 4); k++) {
-					double t = (double)k / (double)(numMarkerQuarterSegments * 4) - 0.125;
-					verts.push_back(markerCenterPoint + radius * parametricUnitCircle(t));
+					mesh.addVertex(markerCenterPoint + radius * this->markerCircle[k], up);
 				}
 			}
 		}
@@ -475,30 +459,28 @@ namespace {
 	 * @param k The theta-index of the marker's desired border edge vertex
 	 * @return The index of the requested marker border edge vertex
 	 */
-	inline Vertex3d::listIndex markerBorderEdgeVert(unsigned int i, unsigned int j, unsigned int k) {
-		return markerBorderEdgeIndex
+	inline Vertex3d::listIndex BoardGenerator::markerBorderEdgeVert(unsigned int i, unsigned int j, unsigned int k) const {
+		return this->markerBorderEdgeIndex
 			+ (i % markerMatrixSize) * markerMatrixSize * numMarkerQuarterSegments * 4
 			+ (j % markerMatrixSize) * numMarkerQuarterSegments * 4
 			+ (k % (numMarkerQuarterSegments * 4));
 	}
 
-	void generateMarkerBoundingBoxVerts(Vertex3d::list &verts) {
+	void BoardGenerator::generateMarkerBoundingBoxVerts(MeshData &mesh) {
 		static const double r = sqrt(2.0 * pow(markerRadius + markerBorderThickness, 2.0));
 
-		markerBoundingBoxIndex = (unsigned int)verts.size();
+		this->markerBoundingBoxIndex = (unsigned int)mesh.getNumVertices();
 		for(unsigned int i = 0; i < markerMatrixSize; i++) {
 			for(unsigned int j = 0; j < markerMatrixSize; j++) {
 				Point3d markerCenterPoint = BoardModel::getMarkerPosition(i, j);
 				for(unsigned int k = 0; k < 4; k++) {
-					double t1 = (double)k / 4.0;
-					double t2 = (double)(k+1) / 4.0;
-					Point3d p1 = markerCenterPoint + r * parametricUnitCircle(t1);
-					Point3d p2 = markerCenterPoint + r * parametricUnitCircle(t2);
+					Point3d p1 = markerCenterPoint + r * this->quarterCircle[k];
+					Point3d p2 = markerCenterPoint + r * this->quarterCircle[k+1];
 					Vector3d v = p2 - p1;
 
 					for(unsigned int l = 0; l < numMarkerQuarterSegments; l++) {
 						double s = (double) l / (double) numMarkerQuarterSegments;
-						verts.push_back(p1 + s * v);
+						mesh.addVertex(p1 + s * v, up);
 					}
 				}
 			}
@@ -512,7 +494,7 @@ namespace {
 	 * @param l The index of the desired vertex along the requested side
 	 * @return The index of the requested marker bounding box vertex
 	 */
-	inline Vertex3d::listIndex markerBoundingBoxVert(unsigned int i, unsigned int j, unsigned int k, int l) {
+	inline Vertex3d::listIndex BoardGenerator::markerBoundingBoxVert(unsigned int i, unsigned int j, unsigned int k, int l) const {
 		int m = (k % 4) * numMarkerQuarterSegments + (l);
 
 		while(m < 0) {
@@ -521,45 +503,51 @@ namespace {
 
 		m %= 4 * numMarkerQuarterSegments;
 
-		return markerBoundingBoxIndex
+		return this->markerBoundingBoxIndex
 			+ (i % markerMatrixSize) * markerMatrixSize * 4 * numMarkerQuarterSegments
 			+ (j % markerMatrixSize) * 4 * numMarkerQuarterSegments
 			+ m;
 	}
 
-	void generateBoardBorderVerts(Vertex3d::list &verts) {
+	/**
+	 * As for the markers' grooves, the normal points toward the center of
+	 * the groove's profile.
+	 */
+	void BoardGenerator::generateBoardBorderVerts(MeshData &mesh) {
 		static const double cornerAngle = 0.03125; // Portion of cicle from 0 to 1
 		static const double sideAngle = 0.25 - cornerAngle; // Portion of circle from 0 to 1
 		static const double boardBorderRadius = sqrt(pow(boardBorderThickness/2.0, 2.0) + pow(boardBorderDepthOffset, 2.0));
 		static const double d = acos(boardBorderDepthOffset / boardBorderRadius) / (2.0 * PI);
+		const UnitCircleTable &profile = UnitCircleTable::get(numBoardBorderConcentricSegments + 1,
+			2.0 * d / (double)numBoardBorderConcentricSegments, 0.25 - d);
 
-		boardBorderIndex = (unsigned int)verts.size();
+		this->boardBorderIndex = (unsigned int)mesh.getNumVertices();
 		Point3d boardCenterPoint;
 		for(unsigned int n = 0; n < 4; n++) {
+			const UnitCircleTable &corner = getBoardCornerCircle(n, numMarkerQuarterSegments, cornerAngle);
 			for(unsigned int k = 0; k < numMarkerQuarterSegments; k++) {
-				double t = (double)k / (double)numMarkerQuarterSegments;
 				for(unsigned int l = 0; l <= numBoardBorderConcentricSegments; l++) {
-					double u = (double)l / (double)numBoardBorderConcentricSegments;
-					Vector3d v = boardBorderRadius * parametricUnitCircle(2.0 * u * d + (0.25 - d));
+					Vector3d v = boardBorderRadius * profile[l];
 					double radius = boardRadius + boardBorderThickness/2.0 - v.x;
 					double dip = boardBorderDepthOffset - v.y;
-					verts.push_back(boardCenterPoint
-						+ radius * parametricUnitCircle((double)n * 0.25 + t * cornerAngle - cornerAngle / 2.0)
-						+ Vector3d(0, 0, dip));
+					Vector3d normal(profile[l].x * corner[k].x, profile[l].x * corner[k].y, profile[l].y);
+					mesh.addVertex(boardCenterPoint
+						+ radius * corner[k]
+						+ Vector3d(0, 0, dip), normal);
 				}
 			}
 
 			unsigned int numBoardBorderSideSegments = (markerMatrixSize-1)*(numMarkerQuarterSegments+1);
+			const UnitCircleTable &side = getBoardSideCircle(n, numBoardBorderSideSegments, cornerAngle, sideAngle);
 			for(unsigned int k = 0; k < numBoardBorderSideSegments; k++) {
-				double t = (double)k / (double)numBoardBorderSideSegments;
 				for(unsigned int l = 0; l <= numBoardBorderConcentricSegments; l++) {
-					double u = (double)l / (double)numBoardBorderConcentricSegments;
-					Vector3d v = boardBorderRadius * parametricUnitCircle(2.0 * u * d + (0.25 - d));
+					Vector3d v = boardBorderRadius * profile[l];
 					double radius = boardRadius + boardBorderThickness/2.0 - v.x;
 					double dip = boardBorderDepthOffset - v.y;
-					verts.push_back(boardCenterPoint
-						+ radius * parametricUnitCircle((double)n * 0.25 + t * sideAngle + cornerAngle / 2.0)
-						+ Vector3d(0, 0, dip));
+					Vector3d normal(profile[l].x * side[k].x, profile[l].x * side[k].y, profile[l].y);
+					mesh.addVertex(boardCenterPoint
+						+ radius * side[k]
+						+ Vector3d(0, 0, dip), normal);
 				}
 			}
 		}
@@ -570,31 +558,30 @@ namespace {
 	 * @param l The concentric-index of the board's desired border vertex
 	 * @return The index of the requested marker border  vertex
 	 */
-	inline Vertex3d::listIndex boardBorderVert(unsigned int k, unsigned int l) {
+	inline Vertex3d::listIndex BoardGenerator::boardBorderVert(unsigned int k, unsigned int l) const {
 		unsigned int numBoardBorderSegments = 4*((markerMatrixSize-1)*(numMarkerQuarterSegments+1) + numMarkerQuarterSegments);
-		return boardBorderIndex
+		return this->boardBorderIndex
 			+ (k % numBoardBorderSegments) * (numBoardBorderConcentricSegments+1)
 			+ (l % (numBoardBorderConcentricSegments+1));
 	}
 
-	void generateBoardBorderInsideVerts(Vertex3d::list &verts) {
+	void BoardGenerator::generateBoardBorderInsideVerts(MeshData &mesh) {
 		double radius = boardRadius;
 		static const double cornerAngle = 0.03125; // Portion of cicle from 0 to 1
 		static const double sideAngle = 0.25 - cornerAngle; // Portion of circle from 0 to 1
 
-		boardBorderInsideIndex = (unsigned int)verts.size();
+		this->boardBorderInsideIndex = (unsigned int)mesh.getNumVertices();
 		Point3d boardCenterPoint;
 		for(unsigned int n = 0; n < 4; n++) {
+			const UnitCircleTable &corner = getBoardCornerCircle(n, numMarkerQuarterSegments, cornerAngle);
 			for(unsigned int k = 0; k < numMarkerQuarterSegments; k++) {
-				double t = (double)k / (double)numMarkerQuarterSegments;
-				verts.push_back(boardCenterPoint
-					+ radius * parametricUnitCircle((double)n * 0.25 + t * cornerAngle - cornerAngle / 2.0));
+				mesh.addVertex(boardCenterPoint + radius * corner[k], up);
 			}
 			//for(unsigned int k = 0; k < (3 * (numMarkerQuarterSegments+1) + 1); k++) {
-			for(unsigned int k = 0; k < (markerMatrixSize-1)*(numMarkerQuarterSegments+1); k++) {
-				double t = (double)k / ((markerMatrixSize-1)*(numMarkerQuarterSegments+1));
-				verts.push_back(boardCenterPoint
-					+ radius * parametricUnitCircle((double)n * 0.25 + t * sideAngle + cornerAngle / 2.0));
+			unsigned int numSideSegments = (markerMatrixSize-1)*(numMarkerQuarterSegments+1);
+			const UnitCircleTable &side = getBoardSideCircle(n, numSideSegments, cornerAngle, sideAngle);
+			for(unsigned int k = 0; k < numSideSegments; k++) {
+				mesh.addVertex(boardCenterPoint + radius * side[k], up);
 			}
 		}
 	}
@@ -603,28 +590,27 @@ namespace {
 	 * @param k The theta-index of the board's desired border inside vertex
 	 * @return The index of the requested marker border inside vertex
 	 */
-	inline Vertex3d::listIndex boardBorderInsideVert(unsigned int k) {
+	inline Vertex3d::listIndex BoardGenerator::boardBorderInsideVert(unsigned int k) const {
 		unsigned int numBoardBorderSegments = 4 * ((markerMatrixSize-1)*(numMarkerQuarterSegments+1) + numMarkerQuarterSegments);
-		return boardBorderInsideIndex + (k % numBoardBorderSegments);
+		return this->boardBorderInsideIndex + (k % numBoardBorderSegments);
 	}
 
-	void generateBoardBorderOutsideVerts(Vertex3d::list &verts) {
+	void BoardGenerator::generateBoardBorderOutsideVerts(MeshData &mesh) {
 		double radius = boardRadius + boardBorderThickness;
 		static const double cornerAngle = 0.03125; // Portion of cicle from 0 to 1
 		static const double sideAngle = 0.25 - cornerAngle; // Portion of circle from 0 to 1
 
-		boardBorderOutsideIndex = (unsigned int)verts.size();
+		this->boardBorderOutsideIndex = (unsigned int)mesh.getNumVertices();
 		Point3d boardCenterPoint;
 		for(unsigned int n = 0; n < 4; n++) {
+			const UnitCircleTable &corner = getBoardCornerCircle(n, numMarkerQuarterSegments, cornerAngle);
 			for(unsigned int k = 0; k < numMarkerQuarterSegments; k++) {
-				double t = (double)k / (double)numMarkerQuarterSegments;
-				verts.push_back(boardCenterPoint
-					+ radius * parametricUnitCircle((double)n * 0.25 + t * cornerAngle - cornerAngle / 2.0));
+				mesh.addVertex(boardCenterPoint + radius * corner[k], up);
 			}
-			for(unsigned int k = 0; k < 2 * (3 * markerMatrixSize - 3); k++) {
-				double t = (double)k / (double)(2 * (3 * markerMatrixSize - 3));
-				verts.push_back(boardCenterPoint
-					+ radius * parametricUnitCircle((double)n * 0.25 + t * sideAngle + cornerAngle / 2.0));
+			unsigned int numSideSegments = 2 * (3 * markerMatrixSize - 3);
+			const UnitCircleTable &side = getBoardSideCircle(n, numSideSegments, cornerAngle, sideAngle);
+			for(unsigned int k = 0; k < numSideSegments; k++) {
+				mesh.addVertex(boardCenterPoint + radius * side[k], up);
 			}
 		}
 	}
@@ -633,28 +619,27 @@ namespace {
 	 * @param k The theta-index of the board's desired border outside vertex
 	 * @return The index of the requested marker border outside vertex
 	 */
-	inline Vertex3d::listIndex boardBorderOutsideVert(unsigned int k) {
+	inline Vertex3d::listIndex BoardGenerator::boardBorderOutsideVert(unsigned int k) const {
 		unsigned int numBoardBorderSegments = 4*(2*(3*markerMatrixSize-3) + numMarkerQuarterSegments);
-		return boardBorderOutsideIndex + (k % numBoardBorderSegments);
+		return this->boardBorderOutsideIndex + (k % numBoardBorderSegments);
 	}
 
-	void generateBoardEdgeTopVerts(Vertex3d::list &verts) {
+	void BoardGenerator::generateBoardEdgeTopVerts(MeshData &mesh) {
 		double radius = boardRadius + boardBorderThickness;
 		static const double cornerAngle = 0.03125; // Portion of cicle from 0 to 1
 		static const double sideAngle = 0.25 - cornerAngle; // Portion of circle from 0 to 1
 
-		boardEdgeTopIndex = (unsigned int)verts.size();
+		this->boardEdgeTopIndex = (unsigned int)mesh.getNumVertices();
 		Point3d boardCenterPoint;
 		for(unsigned int n = 0; n < 4; n++) {
+			const UnitCircleTable &corner = getBoardCornerCircle(n, numMarkerQuarterSegments, cornerAngle);
 			for(unsigned int k = 0; k < numMarkerQuarterSegments; k++) {
-				double t = (double)k / (double)numMarkerQuarterSegments;
-				verts.push_back(boardCenterPoint
-					+ radius * parametricUnitCircle((double)n * 0.25 + t * cornerAngle - cornerAngle / 2.0));
+				mesh.addVertex(boardCenterPoint + radius * corner[k], up);
 			}
-			for(unsigned int k = 0; k < 2 * (3 * markerMatrixSize - 3); k++) {
-				double t = (double)k / (double)(2 * (3 * markerMatrixSize - 3));
-				verts.push_back(boardCenterPoint
-					+ radius * parametricUnitCircle((double)n * 0.25 + t * sideAngle + cornerAngle / 2.0));
+			unsigned int numSideSegments = 2 * (3 * markerMatrixSize - 3);
+			const UnitCircleTable &side = getBoardSideCircle(n, numSideSegments, cornerAngle, sideAngle);
+			for(unsigned int k = 0; k < numSideSegments; k++) {
+				mesh.addVertex(boardCenterPoint + radius * side[k], up);
 			}
 		}
 	}
@@ -663,40 +648,33 @@ namespace {
 	 * @param k The theta-index of the board's desired border outside vertex
 	 * @return The index of the requested marker border outside vertex
 	 */
-	inline Vertex3d::listIndex boardEdgeTopVert(unsigned int k) {
+	inline Vertex3d::listIndex BoardGenerator::boardEdgeTopVert(unsigned int k) const {
 		unsigned int numBoardBorderSegments = 4*(2*(3*markerMatrixSize-3) + numMarkerQuarterSegments);
-		return boardBorderOutsideIndex + (k % numBoardBorderSegments);
+		return this->boardBorderOutsideIndex + (k % numBoardBorderSegments);
 	}
 
-	void generateMarkerMatrixPerimeterVerts(Vertex3d::list &verts) {
-		static const double r = sqrt(2.0 * pow(markerRadius + markerBorderThickness, 2.0));
-		static const double r2 = markerRadius + markerBorderThickness;
-
-		markerMatrixPerimeterIndex = (unsigned int)verts.size();
+	/**
+	 * Walks the perimeter counterclockwise, around each corner marker's
+	 * border edge and then along the bounding boxes of the markers on the
+	 * side, where the last point of a box's side is the first of its next.
+	 */
+	void BoardGenerator::mapMarkerMatrixPerimeterVerts() {
+		this->markerMatrixPerimeter.clear();
+		this->markerMatrixPerimeter.reserve(4*((markerMatrixSize-1)*(numMarkerQuarterSegments+1) + numMarkerQuarterSegments));
 		for(unsigned int n = 0; n < 4; n++) {
 			unsigned int i = (n == 2 || n == 3) ? 0 : markerMatrixSize-1;
 			unsigned int j = (n == 0 || n == 3) ? 0 : markerMatrixSize-1;
-			Point3d markerCenterPoint = BoardModel::getMarkerPosition(i, j);
 			
 			for(unsigned int k = 0; k < numMarkerQuarterSegments; k++) {
-					double t = (double)k / (double)(numMarkerQuarterSegments * 4) + (double)n * 0.25 - 0.125;
-					verts.push_back(markerCenterPoint + r2 * parametricUnitCircle(t));
+				this->markerMatrixPerimeter.push_back(markerBorderEdgeVert(i, j, n * numMarkerQuarterSegments + k));
 			}
 			
 			for(unsigned int k = 0; k < markerMatrixSize; k++) {
-				markerCenterPoint = BoardModel::getMarkerPosition(i, j);
-				double t1 = (double)n*0.25;
-				double t2 = (double)(n+1)*0.25;
-				Point3d p1 = markerCenterPoint + r * parametricUnitCircle(t1);
-				Point3d p2 = markerCenterPoint + r * parametricUnitCircle(t2);
-				Vector3d v = p2 - p1;
-
 				for(unsigned int l = 0; l <= numMarkerQuarterSegments; l++) {
 					if(k == 0 && l < (numMarkerQuarterSegments/2)) continue;
 					if(k == markerMatrixSize-1 && l >= (numMarkerQuarterSegments/2)) continue;
 
-					double s = (double) l / (double) numMarkerQuarterSegments;
-					verts.push_back(p1 + s * v);
+					this->markerMatrixPerimeter.push_back(markerBoundingBoxVert(i, j, n, (int)l));
 				}
 				int delta = (n == 0 || n == 3) ? 1 : -1;
 				if(n % 2 == 0) {
@@ -714,25 +692,20 @@ namespace {
 	 * @param k The index of the desired marker matrix perimeter vertex
 	 * @return The index of the requested marker matrix perimeter vertex
 	 */
-	inline Vertex3d::listIndex markerMatrixPerimeterVert(unsigned int k) {
-		unsigned int numBoardBorderSegments = 4*((markerMatrixSize-1)*(numMarkerQuarterSegments+1) + numMarkerQuarterSegments);
-		return markerMatrixPerimeterIndex + (k % numBoardBorderSegments);
+	inline Vertex3d::listIndex BoardGenerator::markerMatrixPerimeterVert(unsigned int k) const {
+		return this->markerMatrixPerimeter[k % this->markerMatrixPerimeter.size()];
 	}
 
 }
 
 namespace quarto {
 
-	void BoardModel::generateModel() {
-		Model *pModel = this;
-		pModel->setOrigin(Point3d(0.0, 0.0, 0.0));
-
-		generateMarkerMeshes(pModel);
-		generateMarkerBorderMeshes(pModel);
-		generateMarkerBoundingBoxMeshes(pModel);
-		generateInterMarkerBoundingBoxMeshes(pModel);
-		generateBoardBorderMesh(pModel);
-		generateBoardBorderPaddingMesh(pModel);
+	void BoardModel::generateMeshes(MeshData::list &meshes) {
+		for(unsigned int level = 0; level < numDetailLevels; level++) {
+			BoardGenerator generator(level);
+			generator.generate(meshes);
+			meshes.back().setLevel(level);
+		}
 	}
 
 }
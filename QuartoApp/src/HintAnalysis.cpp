@@ -0,0 +1,58 @@
+/**
+* @file HintAnalysis.cpp
+*/
+#include "HintAnalysis.hpp"
+#include <boost/bind.hpp>
+#include <SDL.h>
+
+namespace quarto {
+
+	HintAnalysis::HintAnalysis(const Position &position, TranspositionTable &table, const SearchLimits &limits)
+		: position(position), limits(limits), search(table), safePieces(0), finished(false), cancelled(false) {
+	}
+
+	/**
+	 * @param game A game waiting for a piece to be chosen or placed
+	 * @param table The table to share with other analyses; it must outlive the analysis thread
+	 * @param limits The limits of the search
+	 * @return The running analysis, to be joined before the table is destroyed
+	 */
+	HintAnalysis::handle HintAnalysis::start(const Game &game, TranspositionTable &table, const SearchLimits &limits) {
+		handle analysis(new HintAnalysis(Position(game), table, limits));
+		analysis->thread.reset(new boost::thread(boost::bind(&HintAnalysis::run, analysis)));
+		return analysis;
+	}
+
+	void HintAnalysis::cancel() {
+		this->cancelled = true;
+		this->search.stop();
+	}
+
+	void HintAnalysis::join() {
+		this->thread->join();
+	}
+
+	/**
+	 * Runs on the analysis thread. When a result is ready the render loop is
+	 * woken with an expose event, since SDL_PushEvent() is safe to call from
+	 * any thread.
+	 */
+	void HintAnalysis::run(handle analysis) {
+		analysis->result = analysis->search.run(analysis->position, analysis->limits);
+
+		// A winning placement leaves nothing to give
+		Position after = analysis->position;
+		Move move = analysis->result.move;
+		if(move.square == Move::NONE || !after.place(move.square))
+			analysis->safePieces = after.getAvailablePieces() & (boost::uint16_t)~after.getUnsafePieces();
+
+		analysis->finished.store(true, boost::memory_order_release);
+
+		if(!analysis->cancelled) {
+			SDL_Event event;
+			event.type = SDL_VIDEOEXPOSE;
+			SDL_PushEvent(&event);
+		}
+	}
+
+}
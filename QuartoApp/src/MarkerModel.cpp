@@ -2,15 +2,26 @@
 * @file MarkerModel.cpp
 */
 #include "MarkerModel.hpp"
+#include "Materials.hpp"
 
 namespace quarto {
 
 	const double MarkerModel::markerRadius = 1.85;
 	const unsigned int MarkerModel::numMarkerQuarterSegments = 10;
 
+	/**
+	 * Markers are drawn unlit, in the current color, so their material only
+	 * matters to the debugging views.
+	 */
 	MarkerModel::MarkerModel() {
+		setOrigin(Point3d(0.0, 0.0, 0.0));
 
-		generateModel();
+		MeshData::list meshes;
+		generateMeshes(meshes);
+		reserveMeshes(meshes.size());
+		for(MeshData::list::const_iterator i = meshes.begin(); i != meshes.end(); ++i) {
+			addMesh(TriangleMesh::handle(new TriangleMesh(*i)), markerMaterial);
+		}
 	}
 
 }
@@ -1,78 +1,82 @@
 /**
-* @file BoardModelGeneration.cpp
+* @file MarkerModelGeneration.cpp
 */
 #include "MarkerModel.hpp"
-#include <Triangle.hpp>
-#include <TriangleFan.hpp>
-#include <SmoothMesh.hpp>
-
-/* Implementation dependencies */
-using peek::Vector3d;
-using peek::parametricUnitCircle;
-using peek::Primitive;
-using peek::Triangle;
-using peek::TriangleFan;
-using peek::SmoothMesh;
+#include "UnitCircleTable.hpp"
 
 namespace {
 
 	using namespace quarto;
 
 	const double markerRadius = MarkerModel::markerRadius;
-	const unsigned int numMarkerQuarterSegments = MarkerModel::numMarkerQuarterSegments;
-	
-	void generateMarkerMeshes(Model *pModel);
 
-	unsigned int markerCenterIndex;
-	void generateMarkerCenterVert(Vertex3d::list &verts);
-	inline Vertex3d::listIndex markerCenterVert();
+	/**
+	 * @brief Generates the mesh of a marker: a disc, as one fan around its
+	 * center
+	 */
+	class MarkerGenerator {
+	public:
+
+		explicit MarkerGenerator(unsigned int level);
+
+		void generate(MeshData::list &meshes);
+
+	private:
+
+		const unsigned int numMarkerQuarterSegments;
+
+		const UnitCircleTable &markerCircle;
+
+		Vertex3d::listIndex markerCenterIndex;
+		void generateMarkerCenterVert(MeshData &mesh);
+		inline Vertex3d::listIndex markerCenterVert() const;
 
-	unsigned int markerIndex;
-	void generateMarkerVerts(Vertex3d::list &verts);
-	inline Vertex3d::listIndex markerVert(unsigned int i);
+		Vertex3d::listIndex markerIndex;
+		void generateMarkerVerts(MeshData &mesh);
+		inline Vertex3d::listIndex markerVert(unsigned int i) const;
 
-	void generateMarkerMeshes(Model *pModel) {
+	};
+
+	MarkerGenerator::MarkerGenerator(unsigned int level)
+		: numMarkerQuarterSegments(getEvenDetailSegments(MarkerModel::numMarkerQuarterSegments, level, 2)),
+		markerCircle(UnitCircleTable::get(numMarkerQuarterSegments * 4, -0.125)) {
+	}
+
+	void MarkerGenerator::generate(MeshData::list &meshes) {
 
 		// Generate vertices...
-		Vertex3d::list verts;
-		generateMarkerCenterVert(verts);
-		generateMarkerVerts(verts);
+		MeshData mesh;
+		generateMarkerCenterVert(mesh);
+		generateMarkerVerts(mesh);
 
 		// Generate faces...
-		
-		Primitive::list primitives;
-		TriangleFan::handle triangleFan(new TriangleFan());
-		triangleFan->addVertex(markerCenterVert());
+
+		mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+		mesh.addIndex(markerCenterVert());
 
 		for(unsigned int i = 0; i <= (numMarkerQuarterSegments * 4); i++) {
-			triangleFan->addVertex(markerVert(i));
+			mesh.addIndex(markerVert(i));
 		}
 
-		primitives.push_back(triangleFan);
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives)));
+		meshes.push_back(mesh);
 	}
 
-	void generateMarkerCenterVert(Vertex3d::list &verts) {
-		markerCenterIndex = (unsigned int)verts.size();
-		verts.push_back(Point3d());
+	void MarkerGenerator::generateMarkerCenterVert(MeshData &mesh) {
+		this->markerCenterIndex = mesh.addVertex(Point3d(), Vector3d(0.0, 0.0, 1.0));
 	}
 
 	/**
 	 * @return The index of the marker center vertex
 	 */
-	inline Vertex3d::listIndex markerCenterVert() {
-		return markerCenterIndex;
+	inline Vertex3d::listIndex MarkerGenerator::markerCenterVert() const {
+		return this->markerCenterIndex;
 	}
 
-	void generateMarkerVerts(Vertex3d::list &verts) {
-		double r = markerRadius;
-
-		markerIndex = (unsigned int)verts.size();
+	void MarkerGenerator::generateMarkerVerts(MeshData &mesh) {
+		this->markerIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		Point3d markerCenterPoint;
 		for(unsigned int i = 0; i < (numMarkerQuarterSegments * 4); i++) {
-			double t = (double)i/(double)(numMarkerQuarterSegments * 4) - 0.125;
-			verts.push_back(markerCenterPoint + markerRadius * parametricUnitCircle(t));
+			mesh.addVertex(markerCenterPoint + markerRadius * this->markerCircle[i], Vector3d(0.0, 0.0, 1.0));
 		}
 	}
 
@@ -80,19 +84,23 @@ namespace {
 	 * @param i The theta-index of the marker's desired vertex
 	 * @return The index of the requested marker vertex
 	 */
-	inline Vertex3d::listIndex markerVert(unsigned int i) {
-		return markerIndex + (i % (numMarkerQuarterSegments * 4));
+	inline Vertex3d::listIndex MarkerGenerator::markerVert(unsigned int i) const {
+		return this->markerIndex + (i % (numMarkerQuarterSegments * 4));
 	}
 
 }
 
 namespace quarto {
 
-	void MarkerModel::generateModel() {
-		Model *pModel = this;
-		pModel->setOrigin(Point3d(0.0, 0.0, 0.0));
-
-		generateMarkerMeshes(pModel);
+	void MarkerModel::generateMeshes(MeshData::list &meshes) {
+		for(unsigned int level = 0; level < numDetailLevels; level++) {
+			std::size_t first = meshes.size();
+			MarkerGenerator generator(level);
+			generator.generate(meshes);
+			for(std::size_t i = first; i < meshes.size(); i++) {
+				meshes[i].setLevel(level);
+			}
+		}
 	}
 
 }
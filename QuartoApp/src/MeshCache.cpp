@@ -0,0 +1,314 @@
+/**
+* @file MeshCache.cpp
+*/
+#include "MeshCache.hpp"
+#include "BoardModel.hpp"
+#include "PieceModel.hpp"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using boost::interprocess::file_mapping;
+using boost::interprocess::mapped_region;
+using boost::interprocess::read_only;
+
+namespace {
+
+	using namespace quarto;
+
+	const char fileMagic[8] = { 'Q', 'U', 'A', 'R', 'T', 'O', 'M', 'C' };
+
+	/** Raised whenever the layout of the file changes */
+	const boost::uint32_t FILE_VERSION = 5;
+
+	/** Raised whenever a generator changes the meshes it makes without a constant changing */
+	const boost::uint32_t GENERATOR_VERSION = 5;
+
+	struct FileHeader {
+		char magic[8];
+		boost::uint32_t version;
+		boost::uint32_t numMeshes;
+		boost::uint64_t key;
+		boost::uint64_t fileSize;
+	};
+
+	/**
+	 * @brief Where one mesh lies in the file: its positions at offset, then
+	 * its normals if it has them, then its indices, then its ranges
+	 */
+	struct MeshEntry {
+		boost::uint32_t model;
+		boost::uint32_t level;
+		boost::uint32_t numVertices;
+		boost::uint32_t numIndices;
+		boost::uint32_t numRanges;
+		/** 1 if the mesh has normals, else 0 */
+		boost::uint32_t hasNormals;
+		boost::uint64_t offset;
+	};
+
+	/** @return The number of floats stored for each vertex of a mesh */
+	inline boost::uint64_t getVertexSize(const MeshEntry &entry) {
+		return (entry.hasNormals ? 6 : 3);
+	}
+
+	inline boost::uint64_t getMeshSize(const MeshEntry &entry) {
+		return (boost::uint64_t)entry.numVertices * getVertexSize(entry) * sizeof(float) +
+			(boost::uint64_t)entry.numIndices * sizeof(boost::uint32_t) + (boost::uint64_t)entry.numRanges * sizeof(MeshData::Range);
+	}
+
+	/**
+	 * @brief FNV-1a over the bytes of each value added
+	 */
+	class KeyHash {
+	public:
+
+		KeyHash() : hash(0xCBF29CE484222325ULL) {}
+
+		template<typename T>
+		void add(const T &value) {
+			const unsigned char *c = (const unsigned char *)&value;
+			for(std::size_t i = 0; i < sizeof(value); i++) {
+				this->hash ^= c[i];
+				this->hash *= 0x100000001B3ULL;
+			}
+		}
+
+		inline boost::uint64_t get() const { return hash; }
+
+	private:
+		boost::uint64_t hash;
+	};
+
+	/**
+	 * @return false if a range has an unknown type, runs past the indices, or
+	 * is too short for its type, if an index is past the vertices, or if the
+	 * level of detail or the normals flag is unknown
+	 */
+	bool isValidMesh(const MeshEntry &entry, const boost::uint32_t *indices, const MeshData::Range *ranges) {
+		if(entry.level >= numDetailLevels || entry.hasNormals > 1)
+			return false;
+		for(boost::uint32_t i = 0; i < entry.numIndices; i++) {
+			if(indices[i] >= entry.numVertices)
+				return false;
+		}
+		for(boost::uint32_t i = 0; i < entry.numRanges; i++) {
+			const MeshData::Range &range = ranges[i];
+			if(range.type >= MeshData::NUM_PRIMITIVE_TYPES || range.first > entry.numIndices || range.count > entry.numIndices - range.first)
+				return false;
+			if((range.type == MeshData::TRIANGLE && range.count != 3) || (range.type == MeshData::QUADRILATERAL && range.count != 4) ||
+					(range.type == MeshData::TRIANGLE_LIST && range.count % 3 != 0))
+				return false;
+		}
+		return true;
+	}
+
+}
+
+namespace quarto {
+
+	MeshCache::MeshCache(const std::string &filename) : filename(filename) {
+	}
+
+	/**
+	 * Every index is checked against its mesh's vertices here, so a
+	 * corrupted cache is treated as stale rather than drawn.
+	 */
+	bool MeshCache::open() {
+		this->mapping.reset();
+
+		boost::shared_ptr<mapped_region> region;
+		try {
+			file_mapping file(this->filename.c_str(), read_only);
+			region.reset(new mapped_region(file, read_only));
+		} catch(const boost::interprocess::interprocess_exception &) {
+			return false;
+		}
+
+		boost::uint64_t size = region->get_size();
+		if(size < sizeof(FileHeader))
+			return false;
+
+		const char *base = (const char *)region->get_address();
+		const FileHeader *header = (const FileHeader *)base;
+		if(std::memcmp(header->magic, fileMagic, sizeof(header->magic)) != 0 ||
+				header->version != FILE_VERSION ||
+				header->key != getKey() ||
+				header->fileSize != size ||
+				header->numMeshes > (size - sizeof(FileHeader)) / sizeof(MeshEntry))
+			return false;
+
+		const MeshEntry *entries = (const MeshEntry *)(base + sizeof(FileHeader));
+		for(boost::uint32_t i = 0; i < header->numMeshes; i++) {
+			const MeshEntry &entry = entries[i];
+			if(entry.offset % sizeof(boost::uint32_t) != 0 || entry.offset > size ||
+					getMeshSize(entry) > size - entry.offset)
+				return false;
+
+			const char *data = base + entry.offset;
+			const boost::uint32_t *indices = (const boost::uint32_t *)(data + entry.numVertices * getVertexSize(entry) * sizeof(float));
+			const MeshData::Range *ranges = (const MeshData::Range *)(indices + entry.numIndices);
+			if(!isValidMesh(entry, indices, ranges))
+				return false;
+		}
+
+		this->mapping = region;
+		return true;
+	}
+
+	void MeshCache::close() {
+		this->mapping.reset();
+	}
+
+	bool MeshCache::hasMeshes(unsigned int model) const {
+		if(!this->mapping)
+			return false;
+
+		const char *base = (const char *)this->mapping->get_address();
+		const FileHeader *header = (const FileHeader *)base;
+		const MeshEntry *entries = (const MeshEntry *)(base + sizeof(FileHeader));
+		for(boost::uint32_t i = 0; i < header->numMeshes; i++) {
+			if(entries[i].model == model)
+				return true;
+		}
+		return false;
+	}
+
+	bool MeshCache::getMeshes(unsigned int model, MeshData::list &meshes) const {
+		if(!this->mapping)
+			return false;
+
+		const char *base = (const char *)this->mapping->get_address();
+		const FileHeader *header = (const FileHeader *)base;
+		const MeshEntry *entries = (const MeshEntry *)(base + sizeof(FileHeader));
+
+		bool found = false;
+		for(boost::uint32_t i = 0; i < header->numMeshes; i++) {
+			const MeshEntry &entry = entries[i];
+			if(entry.model != model)
+				continue;
+
+			const float *positions = (const float *)(base + entry.offset);
+			const float *normals = (entry.hasNormals ? positions + entry.numVertices * 3 : NULL);
+			const boost::uint32_t *indices = (const boost::uint32_t *)(positions + entry.numVertices * getVertexSize(entry));
+			const MeshData::Range *ranges = (const MeshData::Range *)(indices + entry.numIndices);
+			meshes.push_back(MeshData(entry.level, this->mapping, positions, normals, entry.numVertices,
+				indices, entry.numIndices, ranges, entry.numRanges));
+			found = true;
+		}
+		return found;
+	}
+
+	/**
+	 * Every array is a multiple of four bytes long, so the arrays that follow
+	 * the header and the mesh entries stay aligned without padding.
+	 */
+	bool MeshCache::write(const std::vector<MeshData::list> &models) const {
+		std::vector<MeshEntry> entries;
+		for(std::size_t m = 0; m < models.size(); m++) {
+			for(MeshData::list::const_iterator i = models[m].begin(); i != models[m].end(); ++i) {
+				MeshEntry entry;
+				std::memset(&entry, 0, sizeof(entry));
+				entry.model = (boost::uint32_t)m;
+				entry.level = i->getLevel();
+				entry.numVertices = (boost::uint32_t)i->getNumVertices();
+				entry.numIndices = (boost::uint32_t)i->getNumIndices();
+				entry.numRanges = (boost::uint32_t)i->getNumRanges();
+				entry.hasNormals = (i->getNormals() != NULL ? 1 : 0);
+				entries.push_back(entry);
+			}
+		}
+
+		boost::uint64_t offset = sizeof(FileHeader) + entries.size() * sizeof(MeshEntry);
+		for(std::vector<MeshEntry>::iterator i = entries.begin(); i != entries.end(); ++i) {
+			i->offset = offset;
+			offset += getMeshSize(*i);
+		}
+
+		FileHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, fileMagic, sizeof(header.magic));
+		header.version = FILE_VERSION;
+		header.numMeshes = (boost::uint32_t)entries.size();
+		header.key = getKey();
+		header.fileSize = offset;
+
+		std::string tempFilename = this->filename + ".tmp";
+		{
+			std::ofstream out(tempFilename.c_str(), std::ios::binary | std::ios::trunc);
+			out.write((const char *)&header, sizeof(header));
+			if(!entries.empty())
+				out.write((const char *)&entries[0], (std::streamsize)(entries.size() * sizeof(MeshEntry)));
+			for(std::size_t m = 0; m < models.size(); m++) {
+				for(MeshData::list::const_iterator i = models[m].begin(); i != models[m].end(); ++i) {
+					out.write((const char *)i->getPositions(), (std::streamsize)(i->getNumVertices() * 3 * sizeof(float)));
+					if(i->getNormals() != NULL)
+						out.write((const char *)i->getNormals(), (std::streamsize)(i->getNumVertices() * 3 * sizeof(float)));
+					out.write((const char *)i->getIndices(), (std::streamsize)(i->getNumIndices() * sizeof(boost::uint32_t)));
+					out.write((const char *)i->getRanges(), (std::streamsize)(i->getNumRanges() * sizeof(MeshData::Range)));
+				}
+			}
+			out.close();
+			if(!out) {
+				std::remove(tempFilename.c_str());
+				return false;
+			}
+		}
+
+		// Removing the old cache first is only needed where rename will not replace a file
+		if(std::rename(tempFilename.c_str(), this->filename.c_str()) == 0)
+			return true;
+		std::remove(this->filename.c_str());
+		if(std::rename(tempFilename.c_str(), this->filename.c_str()) == 0)
+			return true;
+		std::remove(tempFilename.c_str());
+		return false;
+	}
+
+	/**
+	 * Hashes the sizes of the file's records too, so a build that lays them
+	 * out differently never reads another's cache.
+	 */
+	boost::uint64_t MeshCache::getKey() {
+		KeyHash hash;
+		hash.add(GENERATOR_VERSION);
+		hash.add((boost::uint32_t)sizeof(MeshEntry));
+		hash.add((boost::uint32_t)sizeof(MeshData::Range));
+		hash.add(numDetailLevels);
+
+		hash.add(BoardModel::markerRadius);
+		hash.add(BoardModel::markerBorderThickness);
+		hash.add(BoardModel::markerBorderDepthOffset);
+		hash.add(BoardModel::markerSpacing);
+		hash.add(BoardModel::boardRadius);
+		hash.add(BoardModel::boardBorderThickness);
+		hash.add(BoardModel::boardBorderDepthOffset);
+		hash.add(BoardModel::markerMatrixSize);
+		hash.add(BoardModel::numMarkerQuarterSegments);
+		hash.add(BoardModel::numMarkerConcentricSegments);
+		hash.add(BoardModel::numMarkerBorderConcentricSegments);
+		hash.add(BoardModel::numBoardBorderConcentricSegments);
+		hash.add(BoardModel::numBoardBorderSegments);
+
+		hash.add(PieceModel::radius);
+		hash.add(PieceModel::edgeRadius);
+		hash.add(PieceModel::holeRadius);
+		hash.add(PieceModel::shortHeight);
+		hash.add(PieceModel::tallHeight);
+		hash.add(PieceModel::beltHeight);
+		hash.add(PieceModel::beltRadius);
+		hash.add(PieceModel::holeDepth);
+		hash.add(PieceModel::holeCenterDepth);
+		hash.add(PieceModel::numShoulderSegments);
+		hash.add(PieceModel::numBeltSegments);
+		hash.add(PieceModel::numCylinderSegments);
+		hash.add(PieceModel::numCorners);
+		hash.add(PieceModel::numCornerSegments);
+		hash.add(PieceModel::numQuarterHoleSegments);
+
+		return hash.get();
+	}
+
+}
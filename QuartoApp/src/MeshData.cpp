@@ -0,0 +1,225 @@
+/**
+* @file MeshData.cpp
+*/
+#include "MeshData.hpp"
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace {
+
+	using namespace quarto;
+
+	inline std::size_t getNumRangeTriangles(const MeshData::Range &range) {
+		if(range.type == MeshData::QUADRILATERAL)
+			return 2;
+		if(range.type == MeshData::TRIANGLE_LIST)
+			return range.count / 3;
+		return (range.count < 3 ? 0 : range.count - 2);
+	}
+
+}
+
+namespace quarto {
+
+	MeshData::MeshData(unsigned int material, unsigned int level)
+		: material(material), level(level), numVertices(0), numIndices(0), numRanges(0),
+		mappedPositions(NULL), mappedNormals(NULL), mappedIndices(NULL), mappedRanges(NULL) {
+	}
+
+	MeshData::MeshData(unsigned int level, const boost::shared_ptr<boost::interprocess::mapped_region> &region,
+		const float *positions, const float *normals, std::size_t numVertices,
+		const boost::uint32_t *indices, std::size_t numIndices,
+		const Range *ranges, std::size_t numRanges)
+		: material(0), level(level), numVertices(numVertices), numIndices(numIndices), numRanges(numRanges),
+		mapping(region), mappedPositions(positions), mappedNormals(normals), mappedIndices(indices), mappedRanges(ranges) {
+	}
+
+	/**
+	 * Positions are kept as floats, which is all the precision GL draws with.
+	 */
+	Vertex3d::listIndex MeshData::addVertex(const Point3d &p) {
+		this->positionStorage.push_back((float)p.x);
+		this->positionStorage.push_back((float)p.y);
+		this->positionStorage.push_back((float)p.z);
+		return (Vertex3d::listIndex)this->numVertices++;
+	}
+
+	Vertex3d::listIndex MeshData::addVertex(const Point3d &p, const Vector3d &n) {
+		this->normalStorage.push_back((float)n.x);
+		this->normalStorage.push_back((float)n.y);
+		this->normalStorage.push_back((float)n.z);
+		return addVertex(p);
+	}
+
+	void MeshData::beginPrimitive(PrimitiveType type) {
+		Range range;
+		range.type = type;
+		range.material = this->material;
+		range.first = (boost::uint32_t)this->numIndices;
+		range.count = 0;
+		this->rangeStorage.push_back(range);
+		this->numRanges++;
+	}
+
+	void MeshData::addIndex(Vertex3d::listIndex index) {
+		this->indexStorage.push_back((boost::uint32_t)index);
+		this->rangeStorage.back().count++;
+		this->numIndices++;
+	}
+
+	void MeshData::addTriangle(Vertex3d::listIndex v1, Vertex3d::listIndex v2, Vertex3d::listIndex v3) {
+		beginPrimitive(TRIANGLE);
+		addIndex(v1);
+		addIndex(v2);
+		addIndex(v3);
+	}
+
+	void MeshData::addQuadrilateral(Vertex3d::listIndex v1, Vertex3d::listIndex v2, Vertex3d::listIndex v3, Vertex3d::listIndex v4) {
+		beginPrimitive(QUADRILATERAL);
+		addIndex(v1);
+		addIndex(v2);
+		addIndex(v3);
+		addIndex(v4);
+	}
+
+	const float *MeshData::getPositions() const {
+		if(this->mapping)
+			return this->mappedPositions;
+		return (this->positionStorage.empty() ? NULL : &this->positionStorage[0]);
+	}
+
+	/**
+	 * A mesh some of whose vertices were added without normals has none.
+	 */
+	const float *MeshData::getNormals() const {
+		if(this->mapping)
+			return this->mappedNormals;
+		if(this->normalStorage.empty() || this->normalStorage.size() != this->positionStorage.size())
+			return NULL;
+		return &this->normalStorage[0];
+	}
+
+	const boost::uint32_t *MeshData::getIndices() const {
+		if(this->mapping)
+			return this->mappedIndices;
+		return (this->indexStorage.empty() ? NULL : &this->indexStorage[0]);
+	}
+
+	const MeshData::Range *MeshData::getRanges() const {
+		if(this->mapping)
+			return this->mappedRanges;
+		return (this->rangeStorage.empty() ? NULL : &this->rangeStorage[0]);
+	}
+
+	unsigned int MeshData::getNumMaterials() const {
+		const Range *ranges = getRanges();
+		unsigned int numMaterials = 0;
+		for(std::size_t i = 0; i < this->numRanges; i++) {
+			if(ranges[i].material >= numMaterials)
+				numMaterials = ranges[i].material + 1;
+		}
+		return numMaterials;
+	}
+
+	std::size_t MeshData::getNumTriangles() const {
+		const Range *ranges = getRanges();
+		std::size_t numTriangles = 0;
+		for(std::size_t i = 0; i < this->numRanges; i++) {
+			numTriangles += getNumRangeTriangles(ranges[i]);
+		}
+		return numTriangles;
+	}
+
+	/**
+	 * Every other triangle of a strip is wound backwards, as GL does, so all
+	 * of a strip's triangles face the same way.
+	 */
+	void MeshData::getTriangles(unsigned int material, std::vector<boost::uint32_t> &triangles) const {
+		const boost::uint32_t *indices = getIndices();
+		const Range *ranges = getRanges();
+		for(std::size_t i = 0; i < this->numRanges; i++) {
+			if(ranges[i].material != material)
+				continue;
+			const boost::uint32_t *v = indices + ranges[i].first;
+			std::size_t numRangeTriangles = getNumRangeTriangles(ranges[i]);
+			for(std::size_t j = 0; j < numRangeTriangles; j++) {
+				if(ranges[i].type == TRIANGLE_LIST) {
+					triangles.push_back(v[3 * j]);
+					triangles.push_back(v[3 * j + 1]);
+					triangles.push_back(v[3 * j + 2]);
+				} else if(ranges[i].type == TRIANGLE_STRIP) {
+					triangles.push_back(v[(j % 2 == 0) ? j : j + 1]);
+					triangles.push_back(v[(j % 2 == 0) ? j + 1 : j]);
+					triangles.push_back(v[j + 2]);
+				} else {
+					// Fans, triangles and quadrilaterals all fan out from their first vertex
+					triangles.push_back(v[0]);
+					triangles.push_back(v[j + 1]);
+					triangles.push_back(v[j + 2]);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Each material's triangles are drawn by a call of their own, so each
+	 * list is ordered, and its misses counted, as if it began with an empty
+	 * cache.
+	 */
+	void MeshData::optimize(VertexCacheStats &stats) {
+		std::vector<boost::uint32_t> triangles;
+		triangles.reserve(3 * getNumTriangles());
+		std::vector<Range> ranges;
+
+		unsigned int numMaterials = getNumMaterials();
+		for(unsigned int m = 0; m < numMaterials; m++) {
+			std::vector<boost::uint32_t> part;
+			getTriangles(m, part);
+			if(part.empty())
+				continue;
+
+			stats.numTriangles += part.size() / 3;
+			stats.missesBefore += countVertexCacheMisses(part, this->numVertices);
+			optimizeVertexCache(part, this->numVertices);
+
+			Range range;
+			range.type = TRIANGLE_LIST;
+			range.material = m;
+			range.first = (boost::uint32_t)triangles.size();
+			range.count = (boost::uint32_t)part.size();
+			ranges.push_back(range);
+			triangles.insert(triangles.end(), part.begin(), part.end());
+		}
+
+		std::vector<boost::uint32_t> remap;
+		std::size_t numUsed = optimizeVertexFetch(triangles, remap, this->numVertices);
+		for(std::vector<Range>::const_iterator i = ranges.begin(); i != ranges.end(); ++i) {
+			std::vector<boost::uint32_t> part(triangles.begin() + i->first, triangles.begin() + i->first + i->count);
+			stats.missesAfter += countVertexCacheMisses(part, numUsed);
+		}
+
+		bool hasNormals = (getNormals() != NULL);
+		std::vector<float> positions(3 * numUsed);
+		std::vector<float> normals(hasNormals ? 3 * numUsed : 0);
+		for(std::size_t i = 0; i < this->numVertices; i++) {
+			if(remap[i] != unusedVertex) {
+				positions[3 * remap[i]] = this->positionStorage[3 * i];
+				positions[3 * remap[i] + 1] = this->positionStorage[3 * i + 1];
+				positions[3 * remap[i] + 2] = this->positionStorage[3 * i + 2];
+				if(hasNormals) {
+					normals[3 * remap[i]] = this->normalStorage[3 * i];
+					normals[3 * remap[i] + 1] = this->normalStorage[3 * i + 1];
+					normals[3 * remap[i] + 2] = this->normalStorage[3 * i + 2];
+				}
+			}
+		}
+
+		this->positionStorage.swap(positions);
+		this->normalStorage.swap(normals);
+		this->indexStorage.swap(triangles);
+		this->rangeStorage.swap(ranges);
+		this->numVertices = numUsed;
+		this->numIndices = this->indexStorage.size();
+		this->numRanges = this->rangeStorage.size();
+	}
+
+}
@@ -0,0 +1,214 @@
+/**
+* @file MeshModel.cpp
+*/
+#include "MeshModel.hpp"
+#include <GlWrappers.hpp>
+
+namespace {
+
+	using namespace quarto;
+
+	const double defaultNormalScale = 0.25;
+	const double normalScaleFactor = 2.0;
+
+	inline void drawTriangles(const TriangleMesh &mesh, std::size_t first, std::size_t count) {
+		glVertexPointer(3, GL_FLOAT, 0, mesh.getPositions());
+		glDrawElements(GL_TRIANGLES, (GLsizei)(3 * count), GL_UNSIGNED_INT, mesh.getTriangles() + 3 * first);
+	}
+
+}
+
+namespace quarto {
+
+	void SurfaceMaterial::apply() const {
+		glMaterialfv(GL_FRONT, GL_AMBIENT, this->ambient);
+		glMaterialfv(GL_FRONT, GL_DIFFUSE, this->diffuse);
+		glMaterialfv(GL_FRONT, GL_SPECULAR, this->specular);
+		glMaterialfv(GL_FRONT, GL_EMISSION, this->emission);
+		glMaterialf(GL_FRONT, GL_SHININESS, this->shininess);
+	}
+
+	MeshModel::MeshModel()
+		: boundingRadius(0.0), showSolidGeometry(true), showWireframe(false), showNormals(false), smoothShading(true),
+		normalScale(defaultNormalScale) {
+	}
+
+	void MeshModel::reserveMeshes(std::size_t numMeshes) {
+		this->meshes.reserve(numMeshes);
+		this->batches.reserve(numMeshes);
+	}
+
+	void MeshModel::addMesh(const TriangleMesh::handle &mesh, const SurfaceMaterial &material) {
+		const std::vector<TriangleMesh::Part> &parts = mesh->getParts();
+		this->meshes.push_back(mesh);
+		for(std::vector<TriangleMesh::Part>::const_iterator i = parts.begin(); i != parts.end(); ++i) {
+			Batch batch;
+			batch.mesh = mesh.get();
+			batch.first = i->first;
+			batch.count = i->count;
+			batch.material = &material;
+			this->batches.push_back(batch);
+		}
+
+		if(mesh->getBoundingRadius() > this->boundingRadius)
+			this->boundingRadius = mesh->getBoundingRadius();
+	}
+
+	void MeshModel::addMesh(const TriangleMesh::handle &mesh, const SurfaceMaterial *const *materials, unsigned int numMaterials) {
+		const std::vector<TriangleMesh::Part> &parts = mesh->getParts();
+		this->meshes.push_back(mesh);
+		for(std::vector<TriangleMesh::Part>::const_iterator i = parts.begin(); i != parts.end(); ++i) {
+			if(i->material >= numMaterials)
+				continue;
+			Batch batch;
+			batch.mesh = mesh.get();
+			batch.first = i->first;
+			batch.count = i->count;
+			batch.material = materials[i->material];
+			this->batches.push_back(batch);
+		}
+
+		if(mesh->getBoundingRadius() > this->boundingRadius)
+			this->boundingRadius = mesh->getBoundingRadius();
+	}
+
+	void MeshModel::draw() {
+		Point3d origin = getOrigin();
+		glPushMatrix();
+		glTranslated(origin.x, origin.y, origin.z);
+		glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+		glEnableClientState(GL_VERTEX_ARRAY);
+
+		unsigned int level = selectLevel();
+		if(this->showSolidGeometry)
+			drawSolidGeometry(level);
+		if(this->showWireframe)
+			drawWireframe(level);
+		if(this->showNormals)
+			drawNormals(level);
+
+		glPopClientAttrib();
+		glPopMatrix();
+	}
+
+	void MeshModel::pick() {
+		Point3d origin = getOrigin();
+		glPushMatrix();
+		glTranslated(origin.x, origin.y, origin.z);
+		glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+		glEnableClientState(GL_VERTEX_ARRAY);
+
+		for(std::vector<Batch>::const_iterator i = this->batches.begin(); i != this->batches.end(); ++i) {
+			if(i->mesh->getLevel() == 0)
+				drawTriangles(*i->mesh, i->first, i->count);
+		}
+
+		glPopClientAttrib();
+		glPopMatrix();
+	}
+
+	void MeshModel::toggleShowSolidGeometry() {
+		this->showSolidGeometry = !this->showSolidGeometry;
+	}
+
+	void MeshModel::toggleShowWireframe() {
+		this->showWireframe = !this->showWireframe;
+	}
+
+	void MeshModel::toggleShowNormals() {
+		this->showNormals = !this->showNormals;
+	}
+
+	void MeshModel::toggleSmoothShading() {
+		this->smoothShading = !this->smoothShading;
+	}
+
+	void MeshModel::decreaseNormalScale() {
+		this->normalScale /= normalScaleFactor;
+	}
+
+	void MeshModel::increaseNormalScale() {
+		this->normalScale *= normalScaleFactor;
+	}
+
+	/**
+	 * The model's origin is taken as the center of its bounding sphere, which
+	 * is as far from the eye as the modelview matrix's translation says. The
+	 * sphere's projected height is its diameter scaled by the projection's
+	 * vertical focal length and half the viewport's height, over the depth.
+	 */
+	unsigned int MeshModel::selectLevel() const {
+		GLdouble modelview[16];
+		GLdouble projection[16];
+		GLint viewport[4];
+		glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+		glGetDoublev(GL_PROJECTION_MATRIX, projection);
+		glGetIntegerv(GL_VIEWPORT, viewport);
+
+		double depth = -modelview[14];
+		if(depth <= this->boundingRadius)
+			return 0;
+
+		double projectedSize = this->boundingRadius * projection[5] * (double)viewport[3] / depth;
+		return selectDetailLevel(projectedSize);
+	}
+
+	/**
+	 * Flat shading lights each triangle with the normal of its last vertex,
+	 * since the vertices keep only their smooth normals.
+	 */
+	void MeshModel::drawSolidGeometry(unsigned int level) const {
+		glPushAttrib(GL_LIGHTING_BIT);
+		glShadeModel(this->smoothShading ? GL_SMOOTH : GL_FLAT);
+		glEnableClientState(GL_NORMAL_ARRAY);
+
+		for(std::vector<Batch>::const_iterator i = this->batches.begin(); i != this->batches.end(); ++i) {
+			if(i->mesh->getLevel() != level)
+				continue;
+			i->material->apply();
+			glNormalPointer(GL_FLOAT, 0, i->mesh->getNormals());
+			drawTriangles(*i->mesh, i->first, i->count);
+		}
+
+		glDisableClientState(GL_NORMAL_ARRAY);
+		glPopAttrib();
+	}
+
+	void MeshModel::drawWireframe(unsigned int level) const {
+		glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_POLYGON_BIT);
+		glDisable(GL_LIGHTING);
+		glColor3f(1.0f, 1.0f, 1.0f);
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		glEnable(GL_POLYGON_OFFSET_LINE);
+		glPolygonOffset(-1.0f, -1.0f);
+
+		for(std::vector<Batch>::const_iterator i = this->batches.begin(); i != this->batches.end(); ++i) {
+			if(i->mesh->getLevel() == level)
+				drawTriangles(*i->mesh, i->first, i->count);
+		}
+
+		glPopAttrib();
+	}
+
+	void MeshModel::drawNormals(unsigned int level) const {
+		glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+		glDisable(GL_LIGHTING);
+		glColor3f(0.2f, 0.5f, 0.8f);
+
+		glBegin(GL_LINES);
+		for(std::vector<TriangleMesh::handle>::const_iterator i = this->meshes.begin(); i != this->meshes.end(); ++i) {
+			if((*i)->getLevel() != level)
+				continue;
+			const float *p = (*i)->getPositions();
+			const float *n = (*i)->getNormals();
+			for(std::size_t j = 0; j < 3 * (*i)->getNumVertices(); j += 3) {
+				glVertex3f(p[j], p[j + 1], p[j + 2]);
+				glVertex3d(p[j] + this->normalScale * n[j], p[j + 1] + this->normalScale * n[j + 1], p[j + 2] + this->normalScale * n[j + 2]);
+			}
+		}
+		glEnd();
+
+		glPopAttrib();
+	}
+
+}
@@ -0,0 +1,152 @@
+/**
+* @file PackedMesh.cpp
+*/
+#include "PackedMesh.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	using namespace quarto;
+
+	const double maxPacked = 32767.0;
+
+	inline double signNotZero(double v) {
+		return (v < 0.0 ? -1.0 : 1.0);
+	}
+
+	inline boost::int16_t packSnorm(double v) {
+		v = std::max(-1.0, std::min(1.0, v));
+		return (boost::int16_t)std::floor(v * maxPacked + 0.5);
+	}
+
+	/** @return The angle between two unit vectors, which is accurate even when it is small */
+	double getAngle(const double a[3], const double b[3]) {
+		double cross[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+		double sine = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+		double cosine = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+		return std::atan2(sine, cosine);
+	}
+
+}
+
+namespace quarto {
+
+	PackedMesh::PackedMesh() : maxPositionError(0.0), maxNormalError(0.0) {
+		for(std::size_t i = 0; i < 3; i++) {
+			this->center[i] = 0.0f;
+			this->scale[i] = 0.0f;
+		}
+	}
+
+	bool PackedMesh::pack(const TriangleMesh &mesh) {
+		*this = PackedMesh();
+		if(mesh.getNumVertices() > 65536)
+			return false;
+
+		const float *positions = mesh.getPositions();
+		const float *normals = mesh.getNormals();
+
+		float low[3] = { 0.0f, 0.0f, 0.0f };
+		float high[3] = { 0.0f, 0.0f, 0.0f };
+		for(std::size_t i = 0; i < mesh.getNumVertices(); i++) {
+			for(std::size_t j = 0; j < 3; j++) {
+				float v = positions[3 * i + j];
+				if(i == 0 || v < low[j])
+					low[j] = v;
+				if(i == 0 || v > high[j])
+					high[j] = v;
+			}
+		}
+		for(std::size_t j = 0; j < 3; j++) {
+			this->center[j] = 0.5f * (low[j] + high[j]);
+			this->scale[j] = (float)(0.5 * ((double)high[j] - (double)low[j]) / maxPacked);
+		}
+
+		this->vertices.resize(mesh.getNumVertices());
+		for(std::size_t i = 0; i < mesh.getNumVertices(); i++) {
+			packPosition(positions + 3 * i, this->vertices[i]);
+			packNormal(normals + 3 * i, this->vertices[i]);
+		}
+
+		const boost::uint32_t *triangles = mesh.getTriangles();
+		this->indices.resize(3 * mesh.getNumTriangles());
+		for(std::size_t i = 0; i < this->indices.size(); i++) {
+			this->indices[i] = (boost::uint16_t)triangles[i];
+		}
+		return true;
+	}
+
+	std::size_t PackedMesh::getNumBytes() const {
+		return this->vertices.size() * sizeof(Vertex) + this->indices.size() * sizeof(boost::uint16_t);
+	}
+
+	void PackedMesh::unpackNormal(const boost::int16_t packed[2], double normal[3]) {
+		double x = packed[0] / maxPacked;
+		double y = packed[1] / maxPacked;
+		double z = 1.0 - std::fabs(x) - std::fabs(y);
+		if(z < 0.0) {
+			double foldedX = (1.0 - std::fabs(y)) * signNotZero(x);
+			y = (1.0 - std::fabs(x)) * signNotZero(y);
+			x = foldedX;
+		}
+		double length = std::sqrt(x * x + y * y + z * z);
+		normal[0] = x / length;
+		normal[1] = y / length;
+		normal[2] = z / length;
+	}
+
+	void PackedMesh::packPosition(const float *position, Vertex &vertex) {
+		double error = 0.0;
+		for(std::size_t j = 0; j < 3; j++) {
+			double offset = (double)position[j] - (double)this->center[j];
+			vertex.position[j] = (this->scale[j] > 0.0f ? packSnorm(offset / (this->scale[j] * maxPacked)) : 0);
+			double d = (double)vertex.position[j] * (double)this->scale[j] - offset;
+			error += d * d;
+		}
+		this->maxPositionError = std::max(this->maxPositionError, std::sqrt(error));
+	}
+
+	/**
+	 * Rounding each coordinate to the nearest step is not always the closest
+	 * encoding once the normal is unfolded, so the four encodings around the
+	 * exact one are tried and the best is kept. A zero normal, which only an
+	 * unused vertex has, packs as the +z axis.
+	 */
+	void PackedMesh::packNormal(const float *normal, Vertex &vertex) {
+		double n[3] = { normal[0], normal[1], normal[2] };
+		double l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+		if(l1 == 0.0) {
+			vertex.normal[0] = 0;
+			vertex.normal[1] = 0;
+			return;
+		}
+
+		double x = n[0] / l1;
+		double y = n[1] / l1;
+		if(n[2] < 0.0) {
+			double foldedX = (1.0 - std::fabs(y)) * signNotZero(x);
+			y = (1.0 - std::fabs(x)) * signNotZero(y);
+			x = foldedX;
+		}
+
+		double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		double unit[3] = { n[0] / length, n[1] / length, n[2] / length };
+		double bestError = 0.0;
+		for(int i = 0; i < 4; i++) {
+			double px = (i & 1 ? std::ceil(x * maxPacked) : std::floor(x * maxPacked));
+			double py = (i & 2 ? std::ceil(y * maxPacked) : std::floor(y * maxPacked));
+			boost::int16_t candidate[2] = { packSnorm(px / maxPacked), packSnorm(py / maxPacked) };
+			double unpacked[3];
+			unpackNormal(candidate, unpacked);
+			double error = getAngle(unit, unpacked);
+			if(i == 0 || error < bestError) {
+				bestError = error;
+				vertex.normal[0] = candidate[0];
+				vertex.normal[1] = candidate[1];
+			}
+		}
+		this->maxNormalError = std::max(this->maxNormalError, bestError);
+	}
+
+}
@@ -0,0 +1,32 @@
+/**
+* @file PieceGeometry.cpp
+*/
+#include "PieceGeometry.hpp"
+
+namespace quarto {
+
+	PieceGeometry::PieceGeometry(bool isRound, bool isTall, bool isHollow, const MeshData::list &meshes) {
+		this->round = isRound;
+		this->tall = isTall;
+		this->hollow = isHollow;
+		this->meshes.reserve(meshes.size());
+		for(MeshData::list::const_iterator i = meshes.begin(); i != meshes.end(); ++i) {
+			this->meshes.push_back(TriangleMesh::handle(new TriangleMesh(*i)));
+		}
+	}
+
+	void PieceGeometry::generateMeshes(bool isRound, bool isTall, bool isHollow, MeshData::list &meshes) {
+		for(unsigned int level = 0; level < numDetailLevels; level++) {
+			std::size_t first = meshes.size();
+			if(isRound) {
+				generateRoundMeshes(isTall, isHollow, level, meshes);
+			} else {
+				generateSquareMeshes(isTall, isHollow, level, meshes);
+			}
+			for(std::size_t i = first; i < meshes.size(); i++) {
+				meshes[i].setLevel(level);
+			}
+		}
+	}
+
+}
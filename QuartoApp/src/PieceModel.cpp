@@ -2,6 +2,7 @@
 * @file PieceModel.cpp
 */
 #include "PieceModel.hpp"
+#include "Materials.hpp"
 
 namespace quarto {
 
@@ -26,16 +27,20 @@ namespace quarto {
 	const unsigned int PieceModel::numCornerSegments = 10;
 	const unsigned int PieceModel::numQuarterHoleSegments = 10;
 	
-	PieceModel::PieceModel(bool isRound, bool isTall, bool isHollow, bool isWhite) {
-		this->round = isRound;
-		this->tall = isTall;
-		this->hollow = isHollow;
+	/**
+	 * The model draws the geometry's meshes themselves, in its own material,
+	 * so a piece allocates nothing but its list of meshes.
+	 */
+	PieceModel::PieceModel(const PieceGeometry::handle &geometry, bool isWhite) {
+		this->geometry = geometry;
 		this->white = isWhite;
+		setOrigin(Point3d(0.0, 0.0, 0.0));
 
-		if(isRound) {
-			generateRoundModel();
-		} else {
-			generateSquareModel();
+		const SurfaceMaterial &material = (isWhite ? whitePieceMaterial : blackPieceMaterial);
+		const TriangleMesh::list &meshes = geometry->getMeshes();
+		reserveMeshes(meshes.size());
+		for(TriangleMesh::list::const_iterator i = meshes.begin(); i != meshes.end(); ++i) {
+			addMesh(*i, material);
 		}
 	}
 
@@ -3,24 +3,150 @@
 */
 #include "QuartoApp.hpp"
 #include "Lights.hpp"
+#include "MeshCache.hpp"
+#include "PackedMesh.hpp"
 #include <GlWrappers.hpp>
-
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using std::cout;
+using std::endl;
 using peek::Camera;
 using peek::PerspectiveCamera;
 using peek::Point3d;
+using peek::Vector3d;
 using peek::parametricUnitCircle;
 using peek::SceneGraphNode;
 using peek::SceneGraphLeaf;
 
+namespace {
+
+	using namespace quarto;
+
+	/** The mesh cache, in the working directory */
+	const char *meshCacheFilename = "quarto-meshes.cache";
+
+	/**
+	 * @brief The size of some meshes drawn from floats and packed, and the
+	 * largest errors packing made
+	 */
+	struct PackedMeshStats {
+		PackedMeshStats() : numBytes(0), numPackedBytes(0), maxPositionError(0.0), maxNormalError(0.0) {}
+
+		std::size_t numBytes;
+		std::size_t numPackedBytes;
+		double maxPositionError;
+		double maxNormalError;
+
+		void add(const TriangleMesh &mesh, const PackedMesh &packed) {
+			this->numBytes += mesh.getNumVertices() * 6 * sizeof(float) + mesh.getNumTriangles() * 3 * sizeof(boost::uint32_t);
+			this->numPackedBytes += packed.getNumBytes();
+			this->maxPositionError = std::max(this->maxPositionError, packed.getMaxPositionError());
+			this->maxNormalError = std::max(this->maxNormalError, packed.getMaxNormalError());
+		}
+
+		void add(const PackedMeshStats &stats) {
+			this->numBytes += stats.numBytes;
+			this->numPackedBytes += stats.numPackedBytes;
+			this->maxPositionError = std::max(this->maxPositionError, stats.maxPositionError);
+			this->maxNormalError = std::max(this->maxNormalError, stats.maxNormalError);
+		}
+	};
+
+	/** @brief The models left to generate, shared by the threads generating them */
+	struct ModelJobs {
+		BoardModel::handle *boardModel;
+		PieceModel::list *pieceModels;
+		/** The cache to read meshes from, or NULL to generate them all */
+		const MeshCache *cache;
+		/** The meshes of each job, written to the cache afterwards */
+		std::vector<MeshData::list> meshes;
+		/** Whether any job generated its meshes rather than reading them */
+		boost::atomic<bool> generated;
+		/** The vertex cache misses of each job's generated meshes */
+		std::vector<VertexCacheStats> stats;
+		/** Whether to pack generated meshes to measure the packed format */
+		bool packMeshes;
+		/** The packed sizes of each job's generated meshes */
+		std::vector<PackedMeshStats> packedStats;
+		boost::atomic<unsigned int> next;
+	};
+
+	/**
+	 * Job 0 is the board, the largest, so it starts first. Job s + 1 is the
+	 * shape s, which both pieces 2s and 2s + 1 share; the bits of a piece's
+	 * index from the highest are round, tall, hollow and white. A job's
+	 * number is also the model number its meshes are cached under.
+	 */
+	void generateModelsWorker(ModelJobs *jobs) {
+		unsigned int numShapes = (unsigned int)jobs->pieceModels->size() / 2;
+		for(;;) {
+			unsigned int job = jobs->next.fetch_add(1);
+			if(job > numShapes)
+				break;
+
+			unsigned int s = job - 1;
+			MeshData::list &meshes = jobs->meshes[job];
+			if(jobs->cache == NULL || !jobs->cache->getMeshes(job, meshes)) {
+				meshes.clear();
+				if(job == 0)
+					BoardModel::generateMeshes(meshes);
+				else
+					PieceGeometry::generateMeshes((s & 4) != 0, (s & 2) != 0, (s & 1) != 0, meshes);
+				for(MeshData::list::iterator i = meshes.begin(); i != meshes.end(); ++i) {
+					i->optimize(jobs->stats[job]);
+					if(jobs->packMeshes) {
+						TriangleMesh triangleMesh(*i);
+						PackedMesh packed;
+						if(packed.pack(triangleMesh))
+							jobs->packedStats[job].add(triangleMesh, packed);
+					}
+				}
+				jobs->generated.store(true);
+			}
+
+			if(job == 0) {
+				*jobs->boardModel = BoardModel::handle(new BoardModel(meshes));
+			} else {
+				PieceGeometry::handle geometry(new PieceGeometry((s & 4) != 0, (s & 2) != 0, (s & 1) != 0, meshes));
+				jobs->pieceModels->at(2 * s) = PieceModel::handle(new PieceModel(geometry, false));
+				jobs->pieceModels->at(2 * s + 1) = PieceModel::handle(new PieceModel(geometry, true));
+			}
+		}
+	}
+
+}
+
 namespace quarto {
 
 	QuartoApp::QuartoApp() {
 		this->leftMouseButtonDown = false;
 		this->rightMouseButtonDown = false;
+		this->meshStats = false;
 		Camera::handle camera = PerspectiveCamera::handle(new PerspectiveCamera());
 		this->cameraRigging.reset(new FirstPersonCameraRigging(camera, Point3d(0, -30, 24), 90.0, 50.0));
 	}
 
+	QuartoApp::~QuartoApp() {
+		if(this->hint) {
+			this->hint->cancel();
+			this->cancelledHints.push_back(this->hint);
+			this->hint.reset();
+		}
+		for(vector<HintAnalysis::handle>::iterator i = this->cancelledHints.begin(); i != this->cancelledHints.end(); ++i) {
+			(*i)->join();
+		}
+	}
+
+	void QuartoApp::setMeshStats(bool meshStats) {
+		this->meshStats = meshStats;
+	}
+
 	void QuartoApp::run() {
 		generateModels();
 		buildSceneGraph();
@@ -52,6 +178,8 @@ namespace quarto {
 		// Draw the scene
 		this->sceneGraph->draw();
 
+		drawHint();
+
 		glFlush();
 	}
 
@@ -98,6 +226,7 @@ namespace quarto {
 			PieceModel::handle pieceModel = this->availablePieceModels.at(nearestHitName);
 
 			game.choosePiece(Piece(pieceModel->isRound(), pieceModel->isTall(), pieceModel->isHollow(), pieceModel->isWhite()));
+			cancelHint();
 		}
 	}
 
@@ -149,6 +278,7 @@ namespace quarto {
 			}
 
 			game.placePiece(nearestHitNameI, nearestHitNameJ);
+			cancelHint();
 
 			PieceModel::handle pieceModel = getPieceModel(game.getChosenPiece());
 			pieceModel->setOrigin(this->boardModel->getMarkerPosition(nearestHitNameI, nearestHitNameJ));
@@ -226,11 +356,15 @@ namespace quarto {
 			restartGame();
 			this->engine.invalidate();
 			break;
+		case QE_SHOW_HINT:
+			showHint();
+			break;
 		default: break;
 		}
 	}
 
 	void QuartoApp::restartGame() {
+		cancelHint();
 		this->game.reset();
 		placeModels();
 		calculateAvailablePieceModels();
@@ -239,6 +373,85 @@ namespace quarto {
 		this->game.printStateMessage();
 	}
 
+	/**
+	 * Starts analysing the current position in the background. The render loop
+	 * keeps running, and draw() highlights the result once it is ready.
+	 */
+	void QuartoApp::showHint() {
+		State state = this->game.getState();
+		if(state != P1_CHOOSE && state != P2_CHOOSE && state != P1_PLACE && state != P2_PLACE)
+			return;
+
+		cancelHint();
+
+		// Leave a core for rendering
+		unsigned int numCores = boost::thread::hardware_concurrency();
+		SearchLimits limits;
+		limits.milliseconds = 2000;
+		limits.threads = (numCores > 1 ? numCores - 1 : 1);
+
+		this->hint = HintAnalysis::start(this->game, this->hintTable, limits);
+	}
+
+	/**
+	 * Sets the current hint aside without waiting for its search to unwind.
+	 * Hints set aside earlier are joined once they have finished, so at most a
+	 * few searches are ever left to join.
+	 */
+	void QuartoApp::cancelHint() {
+		vector<HintAnalysis::handle> running;
+		for(vector<HintAnalysis::handle>::iterator i = this->cancelledHints.begin(); i != this->cancelledHints.end(); ++i) {
+			if((*i)->isFinished())
+				(*i)->join();
+			else
+				running.push_back(*i);
+		}
+		this->cancelledHints.swap(running);
+
+		if(this->hint) {
+			this->hint->cancel();
+			this->cancelledHints.push_back(this->hint);
+			this->hint.reset();
+			this->engine.invalidate();
+		}
+	}
+
+	/**
+	 * Highlights the suggested square and the pieces that are safe to give by
+	 * drawing an unlit marker beneath them.
+	 */
+	void QuartoApp::drawHint() {
+		if(!this->hint || !this->hint->isFinished())
+			return;
+
+		static const Vector3d lift(0.0, 0.0, 0.02);
+
+		glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+		glDisable(GL_LIGHTING);
+
+		Move move = this->hint->getMove();
+		if(move.square != Move::NONE) {
+			glColor3f(0.2f, 0.8f, 0.2f);
+			this->markerModel.setOrigin(this->boardModel->getMarkerPosition(move.square / 4, move.square % 4) + lift);
+			this->markerModel.draw();
+		}
+
+		boost::uint16_t safePieces = this->hint->getSafePieces();
+		for(unsigned int i = 0; i < Position::NUM_PIECES; i++) {
+			if((safePieces >> i) & 1) {
+				// The suggested piece matches the suggested square; the other safe pieces are blue
+				if(i == move.piece)
+					glColor3f(0.2f, 0.8f, 0.2f);
+				else
+					glColor3f(0.2f, 0.5f, 0.8f);
+				this->markerModel.setOrigin(getPieceModel(Piece::fromIndex(i))->getOrigin() + lift);
+				this->markerModel.draw();
+			}
+		}
+
+		glPopAttrib();
+	}
+
 	/*!
 	* @param buttonEvent The button event
 	*/
@@ -305,26 +518,71 @@ namespace quarto {
 		this->cameraRigging->getCamera()->setAspectRatio((double)sizeX/(double)sizeY);
 	}
 
+	/**
+	 * Generates the board and the eight piece shapes on up to one thread per
+	 * core. Models only fill in their meshes here; nothing touches OpenGL
+	 * until they are drawn. Meshes come from the mesh cache when it was
+	 * written for the current tessellation constants and holds every model.
+	 * Otherwise all of them are generated, optimized for the vertex cache
+	 * and cached; the cache is closed first, since its meshes would keep the
+	 * old file mapped. Statistics of generated meshes are only printed when
+	 * asked for.
+	 */
 	void QuartoApp::generateModels() {
-		this->boardModel = BoardModel::handle(new BoardModel());
-		
-		this->pieceModels.clear();
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(false, false, false, false)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(false, false, false, true)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(false, false, true, false)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(false, false, true, true)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(false, true, false, false)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(false, true, false, true)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(false, true, true, false)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(false, true, true, true)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(true, false, false, false)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(true, false, false, true)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(true, false, true, false)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(true, false, true, true)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(true, true, false, false)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(true, true, false, true)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(true, true, true, false)));
-		this->pieceModels.push_back(PieceModel::handle(new PieceModel(true, true, true, true)));
+		this->pieceModels.assign(Position::NUM_PIECES, PieceModel::handle());
+
+		unsigned int numJobs = 1 + Position::NUM_PIECES / 2;
+
+		MeshCache cache(meshCacheFilename);
+		ModelJobs jobs;
+		jobs.boardModel = &this->boardModel;
+		jobs.pieceModels = &this->pieceModels;
+		bool cached = cache.open();
+		for(unsigned int i = 0; i < numJobs && cached; i++) {
+			cached = cache.hasMeshes(i);
+		}
+		if(!cached)
+			cache.close();
+		jobs.cache = (cached ? &cache : NULL);
+		jobs.meshes.resize(numJobs);
+		jobs.stats.resize(numJobs);
+		jobs.packMeshes = this->meshStats;
+		jobs.packedStats.resize(numJobs);
+		jobs.generated.store(false);
+		jobs.next.store(0);
+
+		unsigned int numThreads = boost::thread::hardware_concurrency();
+		if(numThreads > numJobs)
+			numThreads = numJobs;
+
+		boost::thread_group threads;
+		for(unsigned int i = 1; i < numThreads; i++) {
+			threads.create_thread(boost::bind(&generateModelsWorker, &jobs));
+		}
+		generateModelsWorker(&jobs);
+		threads.join_all();
+
+		// A missing or stale cache is replaced; a failure only costs the next launch the generation
+		if(jobs.generated.load() && !cache.write(jobs.meshes))
+			std::cerr << "Could not write the mesh cache " << meshCacheFilename << endl;
+
+		if(jobs.generated.load() && this->meshStats) {
+			VertexCacheStats stats;
+			PackedMeshStats packedStats;
+			for(unsigned int i = 0; i < numJobs; i++) {
+				stats.add(jobs.stats[i]);
+				packedStats.add(jobs.packedStats[i]);
+			}
+			std::ostringstream report;
+			report << std::fixed << std::setprecision(3)
+				<< "Vertex cache misses per triangle: " << stats.getAcmrBefore()
+				<< " before optimizing, " << stats.getAcmrAfter() << " after" << endl
+				<< "Packed meshes: " << packedStats.numPackedBytes << " bytes instead of " << packedStats.numBytes
+				<< std::scientific << std::setprecision(2)
+				<< ", position error at most " << packedStats.maxPositionError
+				<< ", normal error at most " << packedStats.maxNormalError << " radians";
+			cout << report.str() << endl;
+		}
 	}
 
 	void QuartoApp::placeModels() {
@@ -397,6 +655,7 @@ namespace quarto {
 		this->engine.bindKey(SDLK_LEFTBRACKET, QE_DECREASE_NORMAL_SCALE);
 		this->engine.bindKey(SDLK_RIGHTBRACKET, QE_INCREASE_NORMAL_SCALE);
 		this->engine.bindKey(SDLK_r, QE_RESET_GAME);
+		this->engine.bindKey(SDLK_h, QE_SHOW_HINT);
 	}
 
 }
\ No newline at end of file
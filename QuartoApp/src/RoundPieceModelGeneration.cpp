@@ -2,20 +2,10 @@
 * @file RoundPieceModelGeneration.cpp
 */
 #include "PieceModel.hpp"
-#include "Materials.hpp"
-#include <Triangle.hpp>
-#include <TriangleFan.hpp>
-#include <TriangleStrip.hpp>
-#include <SmoothMesh.hpp>
+#include "UnitCircleTable.hpp"
 
 /* Implementation dependencies */
 using peek::Vector3d;
-using peek::parametricUnitCircle;
-using peek::Primitive;
-using peek::Triangle;
-using peek::TriangleFan;
-using peek::TriangleStrip;
-using peek::SmoothMesh;
 
 namespace {
 
@@ -30,266 +20,287 @@ namespace {
 	const double beltRadius = PieceModel::beltRadius;
 	const double holeDepth = PieceModel::holeDepth;
 	const double holeCenterDepth = PieceModel::holeCenterDepth;
-	const unsigned int numCylinderSegments = PieceModel::numCylinderSegments;
-	const unsigned int numShoulderSegments = PieceModel::numShoulderSegments;
-	const unsigned int numBeltSegments = PieceModel::numBeltSegments;
 
-	Material material;
-	double height;
-	bool notSolid;
-	
-	void generateBottomMesh(Model *pModel);
-	void generateTopMesh(Model *pModel);
-	void generateBeltMesh(Model *pModel);
-	void generateLegMesh(Model *pModel);
-	void generateHoleMeshes(Model *pModel);
-
-	Vertex3d::listIndex bottomCenterIndex;
-	void generateBottomCenterVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex bottomCenter();
-	Vertex3d::listIndex bottomEdgeIndex;
-	void generateBottomEdgeVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex bottomEdge(unsigned int i);
-
-	Vertex3d::listIndex topCenterIndex;
-	void generateTopCenterVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex topCenter();
-	Vertex3d::listIndex topCircleIndex;
-	void generateTopCircleVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex topCircle(unsigned int i);
-	Vertex3d::listIndex topShoulderIndex;
-	void generateShoulderVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex topShoulder(unsigned int i, unsigned int j);
-
-	Vertex3d::listIndex beltIndex;
-	void generateBeltVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex belt(unsigned int i, unsigned int j);
-	Vertex3d::listIndex beltTopIndex;
-	void generateBeltTopVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex beltTop(unsigned int i);
-	Vertex3d::listIndex beltBottomIndex;
-	void generateBeltBottomVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex beltBottom(unsigned int i);
-
-	Vertex3d::listIndex holeTopIndex;
-	void generateHoleTopVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex holeTop(unsigned int i);
-	Vertex3d::listIndex holeBottomIndex;
-	void generateHoleBottomVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex holeBottom(unsigned int i);
-	Vertex3d::listIndex holeBottomCenterIndex;
-	void generateHoleBottomCenterVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex holeBottomCenter();
-
-	void generateBottomMesh(Model *pModel) {
+	/** Pieces are generated around their own origin and moved into place when drawn */
+	const Point3d pieceOrigin(0.0, 0.0, 0.0);
+
+	const Vector3d up(0.0, 0.0, 1.0);
+	const Vector3d down(0.0, 0.0, -1.0);
+
+	/**
+	 * @brief Generates the meshes of a round piece
+	 *
+	 * Each geometry gets its own generator, so several can be generated at
+	 * once. The segment counts are those of the generator's level of detail.
+	 *
+	 * Every vertex gets the normal of the surface it was generated for, so a
+	 * ring where two surfaces meet at an edge is generated once for each.
+	 */
+	class RoundPieceGenerator {
+	public:
+
+		RoundPieceGenerator(double height, bool notSolid, unsigned int level);
+
+		void generate(MeshData::list &meshes);
+
+	private:
+
+		double height;
+		bool notSolid;
+
+		const unsigned int numCylinderSegments;
+		const unsigned int numShoulderSegments;
+		const unsigned int numBeltSegments;
+
+		const UnitCircleTable &cylinderCircle;
+		const UnitCircleTable &shoulderCircle;
+		const UnitCircleTable &beltCircle;
+
+		void generateBottomMesh(MeshData::list &meshes);
+		void generateTopMesh(MeshData::list &meshes);
+		void generateBeltMesh(MeshData::list &meshes);
+		void generateLegMesh(MeshData::list &meshes);
+		void generateHoleMeshes(MeshData::list &meshes);
+
+		Vertex3d::listIndex bottomCenterIndex;
+		void generateBottomCenterVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex bottomCenter() const;
+		Vertex3d::listIndex bottomEdgeIndex;
+		void generateBottomEdgeVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex bottomEdge(unsigned int i) const;
+		Vertex3d::listIndex legBottomIndex;
+		void generateLegBottomVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex legBottom(unsigned int i) const;
+
+		Vertex3d::listIndex topCenterIndex;
+		void generateTopCenterVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex topCenter() const;
+		Vertex3d::listIndex topCircleIndex;
+		void generateTopCircleVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex topCircle(unsigned int i) const;
+		Vertex3d::listIndex topShoulderIndex;
+		void generateShoulderVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex topShoulder(unsigned int i, unsigned int j) const;
+
+		Vertex3d::listIndex beltIndex;
+		void generateBeltVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex belt(unsigned int i, unsigned int j) const;
+		Vertex3d::listIndex beltTopIndex;
+		void generateBeltTopVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex beltTop(unsigned int i) const;
+		Vertex3d::listIndex beltBottomIndex;
+		void generateBeltBottomVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex beltBottom(unsigned int i) const;
+
+		Vertex3d::listIndex holeTopIndex;
+		void generateHoleTopVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex holeTop(unsigned int i) const;
+		Vertex3d::listIndex holeBottomIndex;
+		void generateHoleBottomVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex holeBottom(unsigned int i) const;
+		Vertex3d::listIndex holeBottomCenterIndex;
+		void generateHoleBottomCenterVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex holeBottomCenter() const;
+		Vertex3d::listIndex holeWallIndex;
+		void generateHoleWallVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex holeWall(unsigned int i, unsigned int j) const;
+
+	};
+
+	RoundPieceGenerator::RoundPieceGenerator(double height, bool notSolid, unsigned int level)
+		: height(height), notSolid(notSolid),
+		numCylinderSegments(getDetailSegments(PieceModel::numCylinderSegments, level, 8)),
+		numShoulderSegments(getDetailSegments(PieceModel::numShoulderSegments, level, 2)),
+		numBeltSegments(getDetailSegments(PieceModel::numBeltSegments, level, 2)),
+		cylinderCircle(UnitCircleTable::get(numCylinderSegments)),
+		shoulderCircle(UnitCircleTable::get(numShoulderSegments * 4)),
+		beltCircle(UnitCircleTable::get(numBeltSegments * 2)) {
+	}
+
+	void RoundPieceGenerator::generate(MeshData::list &meshes) {
+		generateBottomMesh(meshes);
+		generateTopMesh(meshes);
+		generateBeltMesh(meshes);
+		generateLegMesh(meshes);
+		generateHoleMeshes(meshes);
+	}
+
+	void RoundPieceGenerator::generateBottomMesh(MeshData::list &meshes) {
 
 		// Generate vertices...
-		Vertex3d::list verts;
-		generateBottomCenterVerts(verts, pModel->getOrigin());
-		generateBottomEdgeVerts(verts, pModel->getOrigin());
+		MeshData mesh;
+		generateBottomCenterVerts(mesh, pieceOrigin);
+		generateBottomEdgeVerts(mesh, pieceOrigin);
 
 		// Generate faces...
 		
-		Primitive::list primitives;
-		TriangleFan::handle triangleFan(new TriangleFan());
-		triangleFan->addVertex(bottomCenter());
+		mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+		mesh.addIndex(bottomCenter());
 
 		for(unsigned int i = 0; i <= numCylinderSegments; i++) {
-			triangleFan->addVertex(bottomEdge(numCylinderSegments-i));
+			mesh.addIndex(bottomEdge(numCylinderSegments-i));
 		}
 
-		primitives.push_back(triangleFan);
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 	}
 
-	void generateTopMesh(Model *pModel) {
+	void RoundPieceGenerator::generateTopMesh(MeshData::list &meshes) {
 
 		// Generate vertices...
 		
-		Vertex3d::list verts;
+		MeshData mesh;
 
-		if(notSolid) {
-			generateHoleTopVerts(verts, pModel->getOrigin());
+		if(this->notSolid) {
+			generateHoleTopVerts(mesh, pieceOrigin);
 		}
 		else {
-			generateTopCenterVerts(verts, pModel->getOrigin());
+			generateTopCenterVerts(mesh, pieceOrigin);
 		}
-		generateTopCircleVerts(verts, pModel->getOrigin());
-		generateShoulderVerts(verts, pModel->getOrigin());
-		generateBeltTopVerts(verts, pModel->getOrigin());
+		generateTopCircleVerts(mesh, pieceOrigin);
+		generateShoulderVerts(mesh, pieceOrigin);
+		generateBeltTopVerts(mesh, pieceOrigin);
 
 		// Generate faces...
-		
-		Primitive::list primitives;
 
-		TriangleStrip::handle triangleStrip;
-		TriangleFan::handle triangleFan;
-
-		if(notSolid) {
+		if(this->notSolid) {
 			// Top circle with a hole in the center...
-			triangleStrip = TriangleStrip::handle(new TriangleStrip());
+			mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 			for(unsigned int i = 0; i <= numCylinderSegments; i++) {
-				triangleStrip->addVertex(holeTop(i));
-				triangleStrip->addVertex(topCircle(i));
+				mesh.addIndex(holeTop(i));
+				mesh.addIndex(topCircle(i));
 			}
-
-			primitives.push_back(triangleStrip);
 		}
 		else {
 			// Top circle with no hole in the center...
-			triangleFan = TriangleFan::handle(new TriangleFan());
-			triangleFan->addVertex(topCenter());
+			mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+			mesh.addIndex(topCenter());
 			
 			for(unsigned int i = 0; i <= numCylinderSegments; i++) {
-				triangleFan->addVertex(topCircle(i));
+				mesh.addIndex(topCircle(i));
 			}
-
-			primitives.push_back(triangleFan);
 		}
 
 		// Shoulders...
 		for(unsigned int j = 0; j < numShoulderSegments-1; j++) {
-			triangleStrip = TriangleStrip::handle(new TriangleStrip());
+			mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 			for(unsigned int i = 0; i <= numCylinderSegments; i++) {
-				triangleStrip->addVertex(topShoulder(i, j));
-				triangleStrip->addVertex(topShoulder(i, j+1));
+				mesh.addIndex(topShoulder(i, j));
+				mesh.addIndex(topShoulder(i, j+1));
 			}
-
-			primitives.push_back(triangleStrip);
 		}
 
 		// Torso...
-		triangleStrip = TriangleStrip::handle(new TriangleStrip());
+		mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 		for(unsigned int i = 0; i <= numCylinderSegments; i++) {
-			triangleStrip->addVertex(topShoulder(i, numShoulderSegments-1));
-			triangleStrip->addVertex(beltTop(i));
+			mesh.addIndex(topShoulder(i, numShoulderSegments-1));
+			mesh.addIndex(beltTop(i));
 		}
 
-		primitives.push_back(triangleStrip);
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 	}
 
-	void generateBeltMesh(Model *pModel) {
+	void RoundPieceGenerator::generateBeltMesh(MeshData::list &meshes) {
 		
 		// Generate vertices...
 
-		Vertex3d::list verts;
-		generateBeltVerts(verts, pModel->getOrigin());
+		MeshData mesh;
+		generateBeltVerts(mesh, pieceOrigin);
 
 		// Generate faces...
 
-		Primitive::list primitives;
-
 		for(unsigned int j = 0; j < numBeltSegments;  j++) {
-			TriangleStrip::handle triangleStrip(new TriangleStrip());
+			mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 			
 			for(unsigned int i = 0; i <= numCylinderSegments;  i++) {
-				triangleStrip->addVertex(belt(i, j));
-				triangleStrip->addVertex(belt(i, j+1));
+				mesh.addIndex(belt(i, j));
+				mesh.addIndex(belt(i, j+1));
 			}
-			
-			primitives.push_back(triangleStrip);
 		}
 
 
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 
 	}
 
-	void generateLegMesh(Model *pModel) {
+	void RoundPieceGenerator::generateLegMesh(MeshData::list &meshes) {
 
 		// Generate vertices...
-		Vertex3d::list verts;
-		generateBeltBottomVerts(verts, pModel->getOrigin());
-		generateBottomEdgeVerts(verts, pModel->getOrigin());
+		MeshData mesh;
+		generateBeltBottomVerts(mesh, pieceOrigin);
+		generateLegBottomVerts(mesh, pieceOrigin);
 
 		// Generate faces...
-		Primitive::list primitives;
-		TriangleStrip::handle triangleStrip(new TriangleStrip());
+		mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 		for(unsigned int i = 0; i <= numCylinderSegments;  i++) {
-			triangleStrip->addVertex(beltBottom(i));
-			triangleStrip->addVertex(bottomEdge(i));
+			mesh.addIndex(beltBottom(i));
+			mesh.addIndex(legBottom(i));
 		}
 
-		primitives.push_back(triangleStrip);
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 
 	}
 
-	void generateHoleMeshes(Model *pModel) {
-		if(!notSolid) {
+	void RoundPieceGenerator::generateHoleMeshes(MeshData::list &meshes) {
+		if(!this->notSolid) {
 			return;
 		}
 
-		Vertex3d::list verts;
-		Primitive::list primitives;
+		MeshData mesh;
 
 		// Hole sides...
 
-		verts.clear();
-		generateHoleTopVerts(verts, pModel->getOrigin());
-		generateHoleBottomVerts(verts, pModel->getOrigin());
+		generateHoleWallVerts(mesh, pieceOrigin);
 
-		primitives.clear();
-		TriangleStrip::handle triangleStrip(new TriangleStrip());
+		mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 		for(unsigned int i = 0; i <= numCylinderSegments;  i++) {
-			triangleStrip->addVertex(holeBottom(i));
-			triangleStrip->addVertex(holeTop(i));
+			mesh.addIndex(holeWall(i, 0));
+			mesh.addIndex(holeWall(i, 1));
 		}
-
-		primitives.push_back(triangleStrip);
 		
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 
 		// Hole bottom...
 
-		verts.clear();
-		generateHoleBottomCenterVerts(verts, pModel->getOrigin());
-		generateHoleBottomVerts(verts, pModel->getOrigin());
+		mesh = MeshData();
+		generateHoleBottomCenterVerts(mesh, pieceOrigin);
+		generateHoleBottomVerts(mesh, pieceOrigin);
 
-		primitives.clear();
-		TriangleFan::handle triangleFan(new TriangleFan());
-		triangleFan->addVertex(holeBottomCenter());
+		mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+		mesh.addIndex(holeBottomCenter());
 
 		for(unsigned int i = 0; i <= numCylinderSegments;  i++) {
-			triangleFan->addVertex(holeBottom(i));
+			mesh.addIndex(holeBottom(i));
 		}
 
-		primitives.push_back(triangleFan);
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 
 	}
 
-	void generateBottomCenterVerts(Vertex3d::list &verts, Point3d origin) {
+	void RoundPieceGenerator::generateBottomCenterVerts(MeshData &mesh, Point3d origin) {
 		Point3d bottomCenterPoint = origin;
 
-		bottomCenterIndex = (Vertex3d::listIndex)verts.size();
-		verts.push_back(bottomCenterPoint);
+		this->bottomCenterIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		mesh.addVertex(bottomCenterPoint, down);
 	}
 
 	/**
 	 * @return The index of the bottom center vertex
 	 */
-	inline Vertex3d::listIndex bottomCenter() {
-		return bottomCenterIndex;
+	inline Vertex3d::listIndex RoundPieceGenerator::bottomCenter() const {
+		return this->bottomCenterIndex;
 	}
 
-	void generateBottomEdgeVerts(Vertex3d::list &verts, Point3d origin) {
+	void RoundPieceGenerator::generateBottomEdgeVerts(MeshData &mesh, Point3d origin) {
 		Point3d bottomCenterPoint = origin;
 
-		bottomEdgeIndex = (Vertex3d::listIndex)verts.size();
+		this->bottomEdgeIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int i = 0; i < numCylinderSegments; i++) {
-			double t = (double)i/(double)numCylinderSegments;
-			verts.push_back(bottomCenterPoint + radius * parametricUnitCircle(t));
+			mesh.addVertex(bottomCenterPoint + radius * this->cylinderCircle[i], down);
 		}
 	}
 
@@ -297,34 +308,53 @@ namespace {
  	 * @param i An index of a cylinder segment break (0 through numCylinderSegments-1)
 	 * @return The index of the requested bottom edge vertex
 	 */
-	inline Vertex3d::listIndex bottomEdge(unsigned int i) {
-		return bottomEdgeIndex + (i % numCylinderSegments);
+	inline Vertex3d::listIndex RoundPieceGenerator::bottomEdge(unsigned int i) const {
+		return this->bottomEdgeIndex + (i % numCylinderSegments);
+	}
+
+	/**
+	 * The leg's bottom ring lies on the bottom edge, but faces outward.
+	 */
+	void RoundPieceGenerator::generateLegBottomVerts(MeshData &mesh, Point3d origin) {
+		Point3d bottomCenterPoint = origin;
+
+		this->legBottomIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		for(unsigned int i = 0; i < numCylinderSegments; i++) {
+			mesh.addVertex(bottomCenterPoint + radius * this->cylinderCircle[i], this->cylinderCircle[i]);
+		}
+	}
+
+	/**
+ 	 * @param i An index of a cylinder segment break (0 through numCylinderSegments-1)
+	 * @return The index of the requested leg bottom vertex
+	 */
+	inline Vertex3d::listIndex RoundPieceGenerator::legBottom(unsigned int i) const {
+		return this->legBottomIndex + (i % numCylinderSegments);
 	}
 
-	void generateTopCenterVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d topCenterOffset = Vector3d(0, 0, height);
+	void RoundPieceGenerator::generateTopCenterVerts(MeshData &mesh, Point3d origin) {
+		Vector3d topCenterOffset = Vector3d(0, 0, this->height);
 		Point3d topCenterPoint = origin + topCenterOffset;
 
-		topCenterIndex = (Vertex3d::listIndex)verts.size();
-		verts.push_back(topCenterPoint);
+		this->topCenterIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		mesh.addVertex(topCenterPoint, up);
 	}
 
 	/**
 	 * @return The index of the top center vertex
 	 */
-	inline Vertex3d::listIndex topCenter() {
-		return bottomCenterIndex;
+	inline Vertex3d::listIndex RoundPieceGenerator::topCenter() const {
+		return this->topCenterIndex;
 	}
 
-	void generateTopCircleVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d topCenterOffset = Vector3d(0, 0, height);
+	void RoundPieceGenerator::generateTopCircleVerts(MeshData &mesh, Point3d origin) {
+		Vector3d topCenterOffset = Vector3d(0, 0, this->height);
 		Point3d topCenterPoint = origin + topCenterOffset;
 		double innerRadius = radius - edgeRadius;
 
-		topCircleIndex = (Vertex3d::listIndex)verts.size();
+		this->topCircleIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int i = 0; i < numCylinderSegments; i++) {
-			double t = (double)i/(double)numCylinderSegments;
-			verts.push_back(topCenterPoint + innerRadius * parametricUnitCircle(t));
+			mesh.addVertex(topCenterPoint + innerRadius * this->cylinderCircle[i], up);
 		}
 	}
 
@@ -332,26 +362,30 @@ namespace {
  	 * @param i An index of a cylinder segment break (0 through numCylinderSegments)
 	 * @return The index of the requested top circle vertex
 	 */
-	inline Vertex3d::listIndex topCircle(unsigned int i) {
-		return topCircleIndex + (i % numCylinderSegments);
+	inline Vertex3d::listIndex RoundPieceGenerator::topCircle(unsigned int i) const {
+		return this->topCircleIndex + (i % numCylinderSegments);
 	}
 	
-	void generateShoulderVerts(Vertex3d::list &verts, Point3d origin) {
-		Point3d topCenterPoint = origin + Vector3d(0, 0, height);
+	/**
+	 * The shoulder is a quarter of a torus, whose normal points from the
+	 * circle at the center of its tube.
+	 */
+	void RoundPieceGenerator::generateShoulderVerts(MeshData &mesh, Point3d origin) {
+		Point3d topCenterPoint = origin + Vector3d(0, 0, this->height);
 		double innerRadius = radius - edgeRadius;
 
-		topShoulderIndex = (Vertex3d::listIndex)verts.size();
+		this->topShoulderIndex = (Vertex3d::listIndex)mesh.getNumVertices();
  		for(unsigned int i = 0; i < numCylinderSegments; i++) {
-			double tI = (double)i/(double)numCylinderSegments;
 			for(unsigned int j = 0; j <= numShoulderSegments; j++) {
-				double tJ = (double)j / (double)(numShoulderSegments * 4);
-				Vector3d quarterUnitCircle = parametricUnitCircle(tJ);
-				Vector3d shoulderVector = parametricUnitCircle(tI);
+				Vector3d quarterUnitCircle = this->shoulderCircle[j];
+				Vector3d shoulderVector = this->cylinderCircle[i];
 				double curRadius = radius - ((1.0 - quarterUnitCircle.y) * edgeRadius);
 				shoulderVector.x *= curRadius;
 				shoulderVector.y *= curRadius;
 				shoulderVector.z -= edgeRadius * (1.0 - quarterUnitCircle.x);
-				verts.push_back(topCenterPoint + shoulderVector);
+				Vector3d normal(quarterUnitCircle.y * this->cylinderCircle[i].x, quarterUnitCircle.y * this->cylinderCircle[i].y,
+					quarterUnitCircle.x);
+				mesh.addVertex(topCenterPoint + shoulderVector, normal);
 			}
 		}
 	}
@@ -361,25 +395,29 @@ namespace {
 	 * @param j An index of a shoulder segment (0 through numShoulderSegments)
 	 * @return The index of the requested shoulder vertex
 	 */
-	inline Vertex3d::listIndex topShoulder(unsigned int i, unsigned int j) {
-		return topShoulderIndex
+	inline Vertex3d::listIndex RoundPieceGenerator::topShoulder(unsigned int i, unsigned int j) const {
+		return this->topShoulderIndex
 			+ (i % numCylinderSegments) * (numShoulderSegments+1)
 			+ (j % (numShoulderSegments+1));
 	}
 
-	void generateBeltVerts(Vertex3d::list &verts, Point3d origin) {
+	/**
+	 * The belt is a groove half a torus deep, whose normal points toward the
+	 * circle at the center of its tube.
+	 */
+	void RoundPieceGenerator::generateBeltVerts(MeshData &mesh, Point3d origin) {
 		Vector3d beltCenterOffset = Vector3d(0, 0, beltHeight);
 		Point3d beltCenterPoint = origin + beltCenterOffset;
 
-		beltIndex = (Vertex3d::listIndex)verts.size();
+		this->beltIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int i = 0; i < numCylinderSegments; i++) {
-			double t = (double)i/(double)numCylinderSegments;
 			for(unsigned int j = 0; j <= numBeltSegments; j++) {
-				double s = (double)j/(2.0*(double)numBeltSegments);
-				Vector3d v1 = beltRadius * parametricUnitCircle(s);
-				Vector3d v2 = (radius - v1.y) * parametricUnitCircle(t);
+				Vector3d v1 = beltRadius * this->beltCircle[j];
+				Vector3d v2 = (radius - v1.y) * this->cylinderCircle[i];
 				v2.z = v1.x;
-				verts.push_back(beltCenterPoint + v2);
+				Vector3d normal(this->beltCircle[j].y * this->cylinderCircle[i].x, this->beltCircle[j].y * this->cylinderCircle[i].y,
+					-this->beltCircle[j].x);
+				mesh.addVertex(beltCenterPoint + v2, normal);
 			}
 		}
 	}
@@ -389,20 +427,19 @@ namespace {
 	 * @param j An index of a belt segment break (0 through numBeltSegments)
 	 * @return The index of the requested belt vertex
 	 */
-	inline Vertex3d::listIndex belt(unsigned int i, unsigned int j) {
-		return beltIndex
+	inline Vertex3d::listIndex RoundPieceGenerator::belt(unsigned int i, unsigned int j) const {
+		return this->beltIndex
 			+ (i % numCylinderSegments) * (numBeltSegments + 1)
 			+ (j % (numBeltSegments + 1));
 	}
 
-	void generateBeltTopVerts(Vertex3d::list &verts, Point3d origin) {
+	void RoundPieceGenerator::generateBeltTopVerts(MeshData &mesh, Point3d origin) {
 		Vector3d beltTopCenterOffset = Vector3d(0, 0, beltHeight + beltRadius);
 		Point3d beltTopCenterPoint = origin + beltTopCenterOffset;
 
-		beltTopIndex = (Vertex3d::listIndex)verts.size();
+		this->beltTopIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int i = 0; i < numCylinderSegments; i++) {
-			double t = (double)i/(double)numCylinderSegments;
-			verts.push_back(beltTopCenterPoint + radius * parametricUnitCircle(t));
+			mesh.addVertex(beltTopCenterPoint + radius * this->cylinderCircle[i], this->cylinderCircle[i]);
 		}
 	}
 
@@ -410,18 +447,17 @@ namespace {
 	 * @param i An index of a cylinder segment break (0 through numCylinderSegments-1)
 	 * @return The index of the requested outer belt top vertex
 	 */
-	inline Vertex3d::listIndex beltTop(unsigned int i) {
-		return beltTopIndex + (i % numCylinderSegments);
+	inline Vertex3d::listIndex RoundPieceGenerator::beltTop(unsigned int i) const {
+		return this->beltTopIndex + (i % numCylinderSegments);
 	}
 
-	void generateBeltBottomVerts(Vertex3d::list &verts, Point3d origin) {
+	void RoundPieceGenerator::generateBeltBottomVerts(MeshData &mesh, Point3d origin) {
 		Vector3d beltBottomCenterOffset = Vector3d(0, 0, beltHeight - beltRadius);
 		Point3d beltBottomCenterPoint = origin + beltBottomCenterOffset;
 
-		beltBottomIndex = (Vertex3d::listIndex)verts.size();
+		this->beltBottomIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int i = 0; i < numCylinderSegments; i++) {
-			double t = (double)i/(double)numCylinderSegments;
-			verts.push_back(beltBottomCenterPoint + radius * parametricUnitCircle(t));
+			mesh.addVertex(beltBottomCenterPoint + radius * this->cylinderCircle[i], this->cylinderCircle[i]);
 		}
 	}
 
@@ -429,18 +465,17 @@ namespace {
 	 * @param i An index of a cylinder segment break (0 through numCylinderSegments-1)
 	 * @return The index of the requested outer belt bottom vertex
 	 */
-	inline Vertex3d::listIndex beltBottom(unsigned int i) {
-		return beltBottomIndex + (i % numCylinderSegments);
+	inline Vertex3d::listIndex RoundPieceGenerator::beltBottom(unsigned int i) const {
+		return this->beltBottomIndex + (i % numCylinderSegments);
 	}
 
-	void generateHoleTopVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d topCenterOffset = Vector3d(0, 0, height);
+	void RoundPieceGenerator::generateHoleTopVerts(MeshData &mesh, Point3d origin) {
+		Vector3d topCenterOffset = Vector3d(0, 0, this->height);
 		Point3d topCenterPoint = origin + topCenterOffset;
 
-		holeTopIndex = (Vertex3d::listIndex)verts.size();
+		this->holeTopIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int i = 0; i < numCylinderSegments; i++) {
-			double t = (double)i/(double)numCylinderSegments;
-			verts.push_back(topCenterPoint + holeRadius * parametricUnitCircle(t));
+			mesh.addVertex(topCenterPoint + holeRadius * this->cylinderCircle[i], up);
 		}
 	}
 
@@ -448,18 +483,23 @@ namespace {
 	 * @param i An index of a cylinder segment break (0 through numCylinderSegments-1)
 	 * @return The index of the requested hole-top vertex
 	 */
-	inline Vertex3d::listIndex holeTop(unsigned int i) {
-		return holeTopIndex + (i % numCylinderSegments);
+	inline Vertex3d::listIndex RoundPieceGenerator::holeTop(unsigned int i) const {
+		return this->holeTopIndex + (i % numCylinderSegments);
 	}
 
-	void generateHoleBottomVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d holeBottomCenterOffset = Vector3d(0, 0, height - holeDepth);
+	/**
+	 * The hole's bottom is a shallow cone, sloping down to its center.
+	 */
+	void RoundPieceGenerator::generateHoleBottomVerts(MeshData &mesh, Point3d origin) {
+		Vector3d holeBottomCenterOffset = Vector3d(0, 0, this->height - holeDepth);
 		Point3d holeBottomCenterPoint = origin + holeBottomCenterOffset;
+		double slope = (holeCenterDepth - holeDepth) / holeRadius;
+		double length = sqrt(1.0 + slope * slope);
 
-		holeBottomIndex = (Vertex3d::listIndex)verts.size();
+		this->holeBottomIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int i = 0; i < numCylinderSegments; i++) {
-			double t = (double)i/(double)numCylinderSegments;
-			verts.push_back(holeBottomCenterPoint + holeRadius * parametricUnitCircle(t));
+			Vector3d normal(-slope * this->cylinderCircle[i].x / length, -slope * this->cylinderCircle[i].y / length, 1.0 / length);
+			mesh.addVertex(holeBottomCenterPoint + holeRadius * this->cylinderCircle[i], normal);
 		}
 	}
 
@@ -467,41 +507,56 @@ namespace {
 	 * @param i An index of a cylinder segment break (0 through numCylinderSegments-1)
 	 * @return The index of the requested hole-bottom vertex
 	 */
-	inline Vertex3d::listIndex holeBottom(unsigned int i) {
-		return holeBottomIndex + (i % numCylinderSegments);
+	inline Vertex3d::listIndex RoundPieceGenerator::holeBottom(unsigned int i) const {
+		return this->holeBottomIndex + (i % numCylinderSegments);
 	}
 
-	void generateHoleBottomCenterVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d holeBottomCenterOffset = Vector3d(0, 0, height - holeCenterDepth);
+	void RoundPieceGenerator::generateHoleBottomCenterVerts(MeshData &mesh, Point3d origin) {
+		Vector3d holeBottomCenterOffset = Vector3d(0, 0, this->height - holeCenterDepth);
 
-		holeBottomCenterIndex = (Vertex3d::listIndex)verts.size();
-		verts.push_back(origin + holeBottomCenterOffset);
+		this->holeBottomCenterIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		mesh.addVertex(origin + holeBottomCenterOffset, up);
 	}
 
 	/**
 	 * @return The index of the hole bottom center vertex
 	 */
-	inline Vertex3d::listIndex holeBottomCenter() {
-		return holeBottomCenterIndex;
+	inline Vertex3d::listIndex RoundPieceGenerator::holeBottomCenter() const {
+		return this->holeBottomCenterIndex;
 	}
 
-}
+	/**
+	 * The wall's rings lie on the hole's top and bottom rings, but face the
+	 * hole's axis.
+	 */
+	void RoundPieceGenerator::generateHoleWallVerts(MeshData &mesh, Point3d origin) {
+		Vector3d holeBottomCenterOffset = Vector3d(0, 0, this->height - holeDepth);
+		Vector3d topCenterOffset = Vector3d(0, 0, this->height);
 
-namespace quarto {
+		this->holeWallIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		for(unsigned int i = 0; i < numCylinderSegments; i++) {
+			Vector3d normal(-this->cylinderCircle[i].x, -this->cylinderCircle[i].y, 0.0);
+			mesh.addVertex(origin + holeBottomCenterOffset + holeRadius * this->cylinderCircle[i], normal);
+			mesh.addVertex(origin + topCenterOffset + holeRadius * this->cylinderCircle[i], normal);
+		}
+	}
 
-	void PieceModel::generateRoundModel() {
-		Model *pModel = this;
-		pModel->setOrigin(Point3d(0.0, 0.0, 0.0));
+	/**
+	 * @param i An index of a cylinder segment break (0 through numCylinderSegments-1)
+	 * @param j 0 for the wall's bottom ring, 1 for its top
+	 * @return The index of the requested hole wall vertex
+	 */
+	inline Vertex3d::listIndex RoundPieceGenerator::holeWall(unsigned int i, unsigned int j) const {
+		return this->holeWallIndex + (i % numCylinderSegments) * 2 + (j % 2);
+	}
 
-		material = (this->white ? whitePieceMaterial : blackPieceMaterial);
-		height = (this->tall ? tallHeight : shortHeight);
-		notSolid = this->hollow;
+}
+
+namespace quarto {
 
-		generateBottomMesh(pModel);
-		generateTopMesh(pModel);
-		generateBeltMesh(pModel);
-		generateLegMesh(pModel);
-		generateHoleMeshes(pModel);
+	void PieceGeometry::generateRoundMeshes(bool isTall, bool isHollow, unsigned int level, MeshData::list &meshes) {
+		RoundPieceGenerator generator(isTall ? tallHeight : shortHeight, isHollow, level);
+		generator.generate(meshes);
 	}
 
 }
@@ -2,24 +2,12 @@
 * @file SquarePieceModelGeneration.cpp
 */
 #include "PieceModel.hpp"
-#include "Materials.hpp"
-#include <Triangle.hpp>
-#include <Quadrilateral.hpp>
-#include <TriangleFan.hpp>
-#include <TriangleStrip.hpp>
-#include <SmoothMesh.hpp>
+#include "UnitCircleTable.hpp"
 
 /* Implementation dependencies */
 using peek::Vertex3d;
 using peek::Vector3d;
 using peek::Point3d;
-using peek::parametricUnitCircle;
-using peek::Primitive;
-using peek::Triangle;
-using peek::Quadrilateral;
-using peek::TriangleFan;
-using peek::TriangleStrip;
-using peek::SmoothMesh;
 
 namespace {
 
@@ -35,86 +23,139 @@ namespace {
 	const double beltRadius = PieceModel::beltRadius;
 	const double holeDepth = PieceModel::holeDepth;
 	const double holeCenterDepth = PieceModel::holeCenterDepth;
-	const unsigned int numCornerSegments = PieceModel::numCornerSegments;
-	const unsigned int numShoulderSegments = PieceModel::numShoulderSegments;
-	const unsigned int numQuarterHoleSegments = PieceModel::numQuarterHoleSegments;
-	const unsigned int numBeltSegments = PieceModel::numBeltSegments;
-
-	Material material;
-	double height;
-	bool notSolid;
-	
-	void generateBottomMesh(Model *pModel);
-	void generateTopMesh(Model *pModel);
-	void generateBeltMesh(Model *pModel);
-	void generateLegMesh(Model *pModel);
-	void generateHoleMeshes(Model *pModel);
-
-	Point3d::list generateCornerPoints(Point3d center, double radius);
-
-	Vertex3d::listIndex bottomCenterIndex;
-	void generateBottomCenterVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex bottomCenter();
-	Vertex3d::listIndex bottomSquareCornerIndex;
-	void generateBottomSquareCornerVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex bottomSquareCorner(unsigned int c);
-	Vertex3d::listIndex bottomEdgeCornerIndex;
-	void generateBottomEdgeCornerVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex bottomEdgeCorner(unsigned int c, unsigned int i);
-
-	Vertex3d::listIndex topCenterIndex;
-	void generateTopCenterVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex topCenter();
-	Vertex3d::listIndex topSquareCornerIndex;
-	void generateTopSquareCornerVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex topSquareCorner(unsigned int c);
-	Vertex3d::listIndex topShoulderCornerIndex;
-	void generateShoulderCornerVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex topShoulderCorner(unsigned int c, unsigned int i, unsigned int j);
-
-	Vertex3d::listIndex beltIndex;
-	void generateBeltVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex belt(unsigned int c, unsigned int i, unsigned int j);
-	Vertex3d::listIndex beltTopIndex;
-	void generateBeltTopVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex beltTop(unsigned int c, unsigned int i);
-	Vertex3d::listIndex beltBottomIndex;
-	void generateBeltBottomVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex beltBottom(unsigned int c, unsigned int i);
-
-	Vertex3d::listIndex holeTopIndex;
-	void generateHoleTopVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex holeTopQuarter(unsigned int c, unsigned int i);
-	Vertex3d::listIndex holeBottomIndex;
-	void generateHoleBottomVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex holeBottomQuarter(unsigned int c, unsigned int i);
-	Vertex3d::listIndex holeBottomCenterIndex;
-	void generateHoleBottomCenterVerts(Vertex3d::list &verts, Point3d origin);
-	inline Vertex3d::listIndex holeBottomCenter();
-
-	void generateBottomMesh(Model *pModel) {
+
+	/** Pieces are generated around their own origin and moved into place when drawn */
+	const Point3d pieceOrigin(0.0, 0.0, 0.0);
+
+	const Vector3d up(0.0, 0.0, 1.0);
+	const Vector3d down(0.0, 0.0, -1.0);
+
+	/**
+	 * @brief Generates the meshes of a square piece
+	 *
+	 * Each geometry gets its own generator, so several can be generated at
+	 * once. The segment counts are those of the generator's level of detail.
+	 *
+	 * Every vertex gets the normal of the surface it was generated for, so a
+	 * ring where two surfaces meet at an edge is generated once for each.
+	 */
+	class SquarePieceGenerator {
+	public:
+
+		SquarePieceGenerator(double height, bool notSolid, unsigned int level);
+
+		void generate(MeshData::list &meshes);
+
+	private:
+
+		double height;
+		bool notSolid;
+
+		const unsigned int numCornerSegments;
+		const unsigned int numShoulderSegments;
+		const unsigned int numQuarterHoleSegments;
+		const unsigned int numBeltSegments;
+
+		/** A whole turn in numCornerSegments steps for each corner */
+		const UnitCircleTable &cornerCircle;
+		const UnitCircleTable &shoulderCircle;
+		const UnitCircleTable &beltCircle;
+		const UnitCircleTable &holeCircle;
+
+		void generateBottomMesh(MeshData::list &meshes);
+		void generateTopMesh(MeshData::list &meshes);
+		void generateBeltMesh(MeshData::list &meshes);
+		void generateLegMesh(MeshData::list &meshes);
+		void generateHoleMeshes(MeshData::list &meshes);
+
+		static Point3d::list generateCornerPoints(Point3d center, double radius);
+
+		Vertex3d::listIndex bottomCenterIndex;
+		void generateBottomCenterVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex bottomCenter() const;
+		Vertex3d::listIndex bottomSquareCornerIndex;
+		void generateBottomSquareCornerVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex bottomSquareCorner(unsigned int c) const;
+		Vertex3d::listIndex bottomEdgeCornerIndex;
+		void generateBottomEdgeCornerVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex bottomEdgeCorner(unsigned int c, unsigned int i) const;
+		Vertex3d::listIndex legBottomIndex;
+		void generateLegBottomVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex legBottom(unsigned int c, unsigned int i) const;
+
+		Vertex3d::listIndex topCenterIndex;
+		void generateTopCenterVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex topCenter() const;
+		Vertex3d::listIndex topSquareCornerIndex;
+		void generateTopSquareCornerVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex topSquareCorner(unsigned int c) const;
+		Vertex3d::listIndex topShoulderCornerIndex;
+		void generateShoulderCornerVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex topShoulderCorner(unsigned int c, unsigned int i, unsigned int j) const;
+
+		Vertex3d::listIndex beltIndex;
+		void generateBeltVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex belt(unsigned int c, unsigned int i, unsigned int j) const;
+		Vertex3d::listIndex beltTopIndex;
+		void generateBeltTopVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex beltTop(unsigned int c, unsigned int i) const;
+		Vertex3d::listIndex beltBottomIndex;
+		void generateBeltBottomVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex beltBottom(unsigned int c, unsigned int i) const;
+
+		Vertex3d::listIndex holeTopIndex;
+		void generateHoleTopVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex holeTopQuarter(unsigned int c, unsigned int i) const;
+		Vertex3d::listIndex holeBottomIndex;
+		void generateHoleBottomVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex holeBottomQuarter(unsigned int c, unsigned int i) const;
+		Vertex3d::listIndex holeBottomCenterIndex;
+		void generateHoleBottomCenterVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex holeBottomCenter() const;
+		Vertex3d::listIndex holeWallIndex;
+		void generateHoleWallVerts(MeshData &mesh, Point3d origin);
+		inline Vertex3d::listIndex holeWallQuarter(unsigned int c, unsigned int i, unsigned int j) const;
+
+	};
+
+	SquarePieceGenerator::SquarePieceGenerator(double height, bool notSolid, unsigned int level)
+		: height(height), notSolid(notSolid),
+		numCornerSegments(getDetailSegments(PieceModel::numCornerSegments, level, 2)),
+		numShoulderSegments(getDetailSegments(PieceModel::numShoulderSegments, level, 2)),
+		numQuarterHoleSegments(getDetailSegments(PieceModel::numQuarterHoleSegments, level, 2)),
+		numBeltSegments(getDetailSegments(PieceModel::numBeltSegments, level, 2)),
+		cornerCircle(UnitCircleTable::get(numCorners * numCornerSegments)),
+		shoulderCircle(UnitCircleTable::get(numShoulderSegments * 4)),
+		beltCircle(UnitCircleTable::get(numBeltSegments * 2)),
+		holeCircle(UnitCircleTable::get(numQuarterHoleSegments * 4)) {
+	}
+
+	void SquarePieceGenerator::generate(MeshData::list &meshes) {
+		generateBottomMesh(meshes);
+		generateTopMesh(meshes);
+		generateBeltMesh(meshes);
+		generateLegMesh(meshes);
+		generateHoleMeshes(meshes);
+	}
+
+	void SquarePieceGenerator::generateBottomMesh(MeshData::list &meshes) {
 
 		// Generate vertices...
-		Vertex3d::list verts;
-		generateBottomCenterVerts(verts, pModel->getOrigin());
-		generateBottomSquareCornerVerts(verts, pModel->getOrigin());
-		generateBottomEdgeCornerVerts(verts, pModel->getOrigin());
+		MeshData mesh;
+		generateBottomCenterVerts(mesh, pieceOrigin);
+		generateBottomSquareCornerVerts(mesh, pieceOrigin);
+		generateBottomEdgeCornerVerts(mesh, pieceOrigin);
 
 		// Generate faces...
-		
-		Primitive::list primitives;
-		TriangleFan::handle triangleFan;
-		
+
 		// Bottom square...
-		triangleFan = TriangleFan::handle(new TriangleFan());
-		triangleFan->addVertex(bottomCenter());
+		mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+		mesh.addIndex(bottomCenter());
 
 		for(unsigned int c = 0; c <= numCorners; c++) {
-			triangleFan->addVertex(bottomSquareCorner(numCorners-c));
+			mesh.addIndex(bottomSquareCorner(numCorners-c));
 		}
 
-		primitives.push_back(triangleFan);
-
 		// Edges...
 		for(unsigned int c = 0; c < numCorners; c++) {
 			// Edges (rectangles between the edge corners)...
@@ -122,239 +163,210 @@ namespace {
 			Vertex3d::listIndex v2 = bottomEdgeCorner(c+1, 0);
 			Vertex3d::listIndex v3 = bottomSquareCorner(c+1);
 			Vertex3d::listIndex v4 = bottomSquareCorner(c);
-			primitives.push_back(Quadrilateral::handle(new Quadrilateral(v4, v3, v2, v1)));
+			mesh.addQuadrilateral(v4, v3, v2, v1);
 
 			// Edge corners...
-			triangleFan = TriangleFan::handle(new TriangleFan());
-			triangleFan->addVertex(bottomSquareCorner(c));
+			mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+			mesh.addIndex(bottomSquareCorner(c));
 			for(unsigned int i = 0; i <= numCornerSegments; i++) {
-				triangleFan->addVertex(bottomEdgeCorner(c, numCornerSegments-i));
+				mesh.addIndex(bottomEdgeCorner(c, numCornerSegments-i));
 			}
-
-			primitives.push_back(triangleFan);
 		}
 
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 	}
 
-	void generateTopMesh(Model *pModel) {
+	void SquarePieceGenerator::generateTopMesh(MeshData::list &meshes) {
 
 		// Generate vertices...
 		
-		Vertex3d::list verts;
+		MeshData mesh;
 
-		if(notSolid) {
-			generateHoleTopVerts(verts, pModel->getOrigin());
+		if(this->notSolid) {
+			generateHoleTopVerts(mesh, pieceOrigin);
 		}
 		else {
-			generateTopCenterVerts(verts, pModel->getOrigin());
+			generateTopCenterVerts(mesh, pieceOrigin);
 		}
-		generateTopSquareCornerVerts(verts, pModel->getOrigin());
-		generateShoulderCornerVerts(verts, pModel->getOrigin());
-		generateBeltTopVerts(verts, pModel->getOrigin());
+		generateTopSquareCornerVerts(mesh, pieceOrigin);
+		generateShoulderCornerVerts(mesh, pieceOrigin);
+		generateBeltTopVerts(mesh, pieceOrigin);
 
 		// Generate faces...
-		
-		Primitive::list primitives;
 
-		if(notSolid) {
+		if(this->notSolid) {
 			// Top square with a hole in the center...
 			for(unsigned int c = 0; c < numCorners; c++) {
 				Vertex3d::listIndex v1 = topSquareCorner(c);
 				Vertex3d::listIndex v2 = topSquareCorner(c+1);
 				Vertex3d::listIndex v3 = holeTopQuarter(c+1, 0);
-				primitives.push_back(Triangle::handle(new Triangle(v1, v2, v3)));
+				mesh.addTriangle(v1, v2, v3);
 
-				TriangleFan::handle triangleFan(new TriangleFan());
-				triangleFan->addVertex(topSquareCorner(c));
+				mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+				mesh.addIndex(topSquareCorner(c));
 
 				for(unsigned int i = 0; i <= numQuarterHoleSegments; i++) {
-					triangleFan->addVertex(holeTopQuarter(c, numQuarterHoleSegments-i));
+					mesh.addIndex(holeTopQuarter(c, numQuarterHoleSegments-i));
 				}
-
-				primitives.push_back(triangleFan);
 			}
 		}
 		else {
 			// Top square with no hole in the center..
-			TriangleFan::handle triangleFan(new TriangleFan());
-			triangleFan->addVertex(topCenter());
+			mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+			mesh.addIndex(topCenter());
 
 			for(unsigned int c = 0; c <= numCorners; c++) {
-				triangleFan->addVertex(topSquareCorner(c));
+				mesh.addIndex(topSquareCorner(c));
 			}
-
-			primitives.push_back(triangleFan);
 		}
 
 		// Shoulder corners...
 		for(unsigned int c = 0; c < numCorners; c++) {
-			TriangleFan::handle triangleFan(new TriangleFan());
-			triangleFan->addVertex(topSquareCorner(c));
+			mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+			mesh.addIndex(topSquareCorner(c));
 			for(unsigned int i = 0; i <= numCornerSegments; i++) {
-				triangleFan->addVertex(topShoulderCorner(c, i, 0));
+				mesh.addIndex(topShoulderCorner(c, i, 0));
 			}
 
-			primitives.push_back(triangleFan);
-
 			for(unsigned int j = 0; j < numShoulderSegments-1; j++) {
-				TriangleStrip::handle triangleStrip(new TriangleStrip());
+				mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 				for(unsigned int i = 0; i <= numCornerSegments; i++) {
-					triangleStrip->addVertex(topShoulderCorner(c, i, j));
-					triangleStrip->addVertex(topShoulderCorner(c, i, j+1));
+					mesh.addIndex(topShoulderCorner(c, i, j));
+					mesh.addIndex(topShoulderCorner(c, i, j+1));
 				}
-				
-				primitives.push_back(triangleStrip);
 			}
 
 		}
 
 		// Shoulder edges...
 		for(unsigned int c = 0; c < numCorners; c++) {
-			TriangleStrip::handle triangleStrip(new TriangleStrip());
-			triangleStrip->addVertex(topSquareCorner(c+1));
-			triangleStrip->addVertex(topSquareCorner(c));
+			mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
+			mesh.addIndex(topSquareCorner(c+1));
+			mesh.addIndex(topSquareCorner(c));
 
 			for(unsigned int j = 0; j < numShoulderSegments; j++) {
-				triangleStrip->addVertex(topShoulderCorner(c+1, 0, j));
-				triangleStrip->addVertex(topShoulderCorner(c, numCornerSegments, j));
+				mesh.addIndex(topShoulderCorner(c+1, 0, j));
+				mesh.addIndex(topShoulderCorner(c, numCornerSegments, j));
 			}
-
-			primitives.push_back(triangleStrip);
 		}
 
 		// Torso...
-		TriangleStrip::handle triangleStrip(new TriangleStrip());
+		mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 		for(unsigned int c = 0; c < numCorners; c++) {
 			for(unsigned int i = 0; i < numCornerSegments; i++) {
-				triangleStrip->addVertex(topShoulderCorner(c, i, numShoulderSegments-1));
-				triangleStrip->addVertex(beltTop(c, i));
+				mesh.addIndex(topShoulderCorner(c, i, numShoulderSegments-1));
+				mesh.addIndex(beltTop(c, i));
 			}
 
 		}
 
 		// Last side...
-		triangleStrip->addVertex(topShoulderCorner(0, 0, numShoulderSegments-1));
-		triangleStrip->addVertex(beltTop(0, 0));
-		primitives.push_back(triangleStrip);
+		mesh.addIndex(topShoulderCorner(0, 0, numShoulderSegments-1));
+		mesh.addIndex(beltTop(0, 0));
 
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 	}
 
-	void generateBeltMesh(Model *pModel) {
+	void SquarePieceGenerator::generateBeltMesh(MeshData::list &meshes) {
 		
 		// Generate vertices...
 
-		Vertex3d::list verts;
-		generateBeltVerts(verts, pModel->getOrigin());
+		MeshData mesh;
+		generateBeltVerts(mesh, pieceOrigin);
 
 		// Generate faces...
 
-		Primitive::list primitives;
-
 		for(unsigned int j = 0; j < numBeltSegments;  j++) {
-			TriangleStrip::handle triangleStrip(new TriangleStrip());
+			mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 			for(unsigned int c = 0; c < numCorners; c++) {
 				for(unsigned int i = 0; i <= numCornerSegments;  i++) {
-					triangleStrip->addVertex(belt(c, i, j));
-					triangleStrip->addVertex(belt(c, i, j+1));
+					mesh.addIndex(belt(c, i, j));
+					mesh.addIndex(belt(c, i, j+1));
 				}
 			}
 
-			triangleStrip->addVertex(belt(0, 0, j));
-			triangleStrip->addVertex(belt(0, 0, j+1));
-
-			primitives.push_back(triangleStrip);
+			mesh.addIndex(belt(0, 0, j));
+			mesh.addIndex(belt(0, 0, j+1));
 		}
 
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 
 	}
 
-	void generateLegMesh(Model *pModel) {
+	void SquarePieceGenerator::generateLegMesh(MeshData::list &meshes) {
 
 		// Generate vertices...
-		Vertex3d::list verts;
-		generateBeltBottomVerts(verts, pModel->getOrigin());
-		generateBottomEdgeCornerVerts(verts, pModel->getOrigin());
+		MeshData mesh;
+		generateBeltBottomVerts(mesh, pieceOrigin);
+		generateLegBottomVerts(mesh, pieceOrigin);
 
 		// Generate faces...
-		Primitive::list primitives;
-		TriangleStrip::handle triangleStrip(new TriangleStrip());
+		mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 		for(unsigned int c = 0; c < numCorners; c++) {
 			for(unsigned int i = 0; i <= numCornerSegments;  i++) {
-				triangleStrip->addVertex(beltBottom(c, i));
-				triangleStrip->addVertex(bottomEdgeCorner(c, i));
+				mesh.addIndex(beltBottom(c, i));
+				mesh.addIndex(legBottom(c, i));
 			}
 		}
 
-		triangleStrip->addVertex(beltBottom(0, 0));
-		triangleStrip->addVertex(bottomEdgeCorner(0, 0));
+		mesh.addIndex(beltBottom(0, 0));
+		mesh.addIndex(legBottom(0, 0));
 
-		primitives.push_back(triangleStrip);
-
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 
 	}
 
-	void generateHoleMeshes(Model *pModel) {
-		if(!notSolid) {
+	void SquarePieceGenerator::generateHoleMeshes(MeshData::list &meshes) {
+		if(!this->notSolid) {
 			return;
 		}
 
-		Vertex3d::list verts;
-		Primitive::list primitives;
+		MeshData mesh;
 
 		// Hole sides...
 
-		verts.clear();
-		generateHoleTopVerts(verts, pModel->getOrigin());
-		generateHoleBottomVerts(verts, pModel->getOrigin());
+		generateHoleWallVerts(mesh, pieceOrigin);
 
-		primitives.clear();
-		TriangleStrip::handle triangleStrip(new TriangleStrip());
+		mesh.beginPrimitive(MeshData::TRIANGLE_STRIP);
 
 		for(unsigned int c = 0; c < numCorners; c++) {
 			for(unsigned int i = 0; i < numQuarterHoleSegments;  i++) {
-				triangleStrip->addVertex(holeBottomQuarter(c, i));
-				triangleStrip->addVertex(holeTopQuarter(c, i));
+				mesh.addIndex(holeWallQuarter(c, i, 0));
+				mesh.addIndex(holeWallQuarter(c, i, 1));
 			}
 		}
 
-		triangleStrip->addVertex(holeBottomQuarter(0, 0));
-		triangleStrip->addVertex(holeTopQuarter(0, 0));
-		primitives.push_back(triangleStrip);
+		mesh.addIndex(holeWallQuarter(0, 0, 0));
+		mesh.addIndex(holeWallQuarter(0, 0, 1));
 
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 
 		// Hole bottom...
 
-		verts.clear();
-		generateHoleBottomCenterVerts(verts, pModel->getOrigin());
-		generateHoleBottomVerts(verts, pModel->getOrigin());
+		mesh = MeshData();
+		generateHoleBottomCenterVerts(mesh, pieceOrigin);
+		generateHoleBottomVerts(mesh, pieceOrigin);
 
-		primitives.clear();
-		TriangleFan::handle triangleFan(new TriangleFan());
-		triangleFan->addVertex(holeBottomCenter());
+		mesh.beginPrimitive(MeshData::TRIANGLE_FAN);
+		mesh.addIndex(holeBottomCenter());
 
 		for(unsigned int c = 0; c < numCorners; c++) {
 			for(unsigned int i = 0; i < numQuarterHoleSegments;  i++) {
-				triangleFan->addVertex(holeBottomQuarter(c, i));
+				mesh.addIndex(holeBottomQuarter(c, i));
 			}
 		}
 
-		triangleFan->addVertex(holeBottomQuarter(0, 0));
-		primitives.push_back(triangleFan);
+		mesh.addIndex(holeBottomQuarter(0, 0));
 		
-		pModel->addMesh(SmoothMesh::handle(new SmoothMesh(verts, primitives, material)));
+		meshes.push_back(mesh);
 
 	}
 
-	Point3d::list generateCornerPoints(Point3d center, double radius) {
+	Point3d::list SquarePieceGenerator::generateCornerPoints(Point3d center, double radius) {
 		Point3d::list cornerPoints;
 		cornerPoints.push_back(Vertex3d(center.x + radius, center.y + radius, center.z));
 		cornerPoints.push_back(Vertex3d(center.x - radius, center.y + radius, center.z));
@@ -363,28 +375,28 @@ namespace {
 		return cornerPoints;
 	}
 
-	void generateBottomCenterVerts(Vertex3d::list &verts, Point3d origin) {
+	void SquarePieceGenerator::generateBottomCenterVerts(MeshData &mesh, Point3d origin) {
 		Point3d bottomCenterPoint = origin;
 
-		bottomCenterIndex = (Vertex3d::listIndex)verts.size();
-		verts.push_back(bottomCenterPoint);
+		this->bottomCenterIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		mesh.addVertex(bottomCenterPoint, down);
 	}
 
 	/**
 	 * @return The index of the bottom center vertex
 	 */
-	inline Vertex3d::listIndex bottomCenter() {
-		return bottomCenterIndex;
+	inline Vertex3d::listIndex SquarePieceGenerator::bottomCenter() const {
+		return this->bottomCenterIndex;
 	}
 
-	void generateBottomSquareCornerVerts(Vertex3d::list &verts, Point3d origin) {
+	void SquarePieceGenerator::generateBottomSquareCornerVerts(MeshData &mesh, Point3d origin) {
 		Point3d bottomCenterPoint = origin;
 		double innerRadius = radius - edgeRadius;
 
-		bottomSquareCornerIndex = (Vertex3d::listIndex)verts.size();
+		this->bottomSquareCornerIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		Point3d::list cornerPoints = generateCornerPoints(bottomCenterPoint, innerRadius);
 		for(unsigned int c = 0; c < numCorners; c++) {
-			verts.push_back(cornerPoints.at(c));
+			mesh.addVertex(cornerPoints.at(c), down);
 		}
 	}
 
@@ -392,20 +404,18 @@ namespace {
 	 * @param c A corner index (0 through 3)
 	 * @return The index of the vertex for the requested bottom square corner
 	 */
-	inline Vertex3d::listIndex bottomSquareCorner(unsigned int c) {
-		return bottomSquareCornerIndex + (c % numCorners);
+	inline Vertex3d::listIndex SquarePieceGenerator::bottomSquareCorner(unsigned int c) const {
+		return this->bottomSquareCornerIndex + (c % numCorners);
 	}
 
-	void generateBottomEdgeCornerVerts(Vertex3d::list &verts, Point3d origin) {
+	void SquarePieceGenerator::generateBottomEdgeCornerVerts(MeshData &mesh, Point3d origin) {
 		double innerRadius = radius - edgeRadius;
 		Point3d::list cornerPoints = generateCornerPoints(origin, innerRadius);
 
-		bottomEdgeCornerIndex = (Vertex3d::listIndex)verts.size();
+		this->bottomEdgeCornerIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int c = 0; c < numCorners; c++) {
-			double tStart = (double)c / (double)numCorners;
 			for(unsigned int i = 0; i <= numCornerSegments; i++) {
-				double t = tStart + ((double)i/(double)numCorners)/(double)numCornerSegments;
-				verts.push_back(cornerPoints.at(c) + edgeRadius * parametricUnitCircle(t));
+				mesh.addVertex(cornerPoints.at(c) + edgeRadius * this->cornerCircle[c * numCornerSegments + i], down);
 			}
 		}
 	}
@@ -415,36 +425,63 @@ namespace {
  	 * @param i An index of a corner segment break (0 through numCornerSegments)
 	 * @return The index of the requested bottom edge corner vertex
 	 */
-	inline Vertex3d::listIndex bottomEdgeCorner(unsigned int c, unsigned int i) {
-		return bottomEdgeCornerIndex
+	inline Vertex3d::listIndex SquarePieceGenerator::bottomEdgeCorner(unsigned int c, unsigned int i) const {
+		return this->bottomEdgeCornerIndex
+			+ (c % numCorners) * (numCornerSegments + 1)
+			+ (i % (numCornerSegments + 1));
+	}
+
+	/**
+	 * The leg's bottom ring lies on the bottom edge, but faces outward.
+	 */
+	void SquarePieceGenerator::generateLegBottomVerts(MeshData &mesh, Point3d origin) {
+		double innerRadius = radius - edgeRadius;
+		Point3d::list cornerPoints = generateCornerPoints(origin, innerRadius);
+
+		this->legBottomIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		for(unsigned int c = 0; c < numCorners; c++) {
+			for(unsigned int i = 0; i <= numCornerSegments; i++) {
+				const Vector3d &normal = this->cornerCircle[c * numCornerSegments + i];
+				mesh.addVertex(cornerPoints.at(c) + edgeRadius * normal, normal);
+			}
+		}
+	}
+
+	/**
+	 * @param c A corner index (0 through 3)
+ 	 * @param i An index of a corner segment break (0 through numCornerSegments)
+	 * @return The index of the requested leg bottom vertex
+	 */
+	inline Vertex3d::listIndex SquarePieceGenerator::legBottom(unsigned int c, unsigned int i) const {
+		return this->legBottomIndex
 			+ (c % numCorners) * (numCornerSegments + 1)
 			+ (i % (numCornerSegments + 1));
 	}
 
-	void generateTopCenterVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d topCenterOffset = Vector3d(0, 0, height);
+	void SquarePieceGenerator::generateTopCenterVerts(MeshData &mesh, Point3d origin) {
+		Vector3d topCenterOffset = Vector3d(0, 0, this->height);
 		Point3d topCenterPoint = origin + topCenterOffset;
 
-		topCenterIndex = (Vertex3d::listIndex)verts.size();
-		verts.push_back(topCenterPoint);
+		this->topCenterIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		mesh.addVertex(topCenterPoint, up);
 	}
 
 	/**
 	 * @return The index of the top center vertex
 	 */
-	inline Vertex3d::listIndex topCenter() {
-		return bottomCenterIndex;
+	inline Vertex3d::listIndex SquarePieceGenerator::topCenter() const {
+		return this->topCenterIndex;
 	}
 
-	void generateTopSquareCornerVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d topCenterOffset = Vector3d(0, 0, height);
+	void SquarePieceGenerator::generateTopSquareCornerVerts(MeshData &mesh, Point3d origin) {
+		Vector3d topCenterOffset = Vector3d(0, 0, this->height);
 		Point3d topCenterPoint = origin + topCenterOffset;
 		double innerRadius = radius - edgeRadius;
 
-		topSquareCornerIndex = (Vertex3d::listIndex)verts.size();
+		this->topSquareCornerIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		Point3d::list cornerPoints = generateCornerPoints(topCenterPoint, innerRadius);
 		for(unsigned int c = 0; c < numCorners; c++) {
-			verts.push_back(cornerPoints.at(c));
+			mesh.addVertex(cornerPoints.at(c), up);
 		}
 	}
 
@@ -452,28 +489,30 @@ namespace {
 	 * @param c A corner index (0 through 3)
 	 * @return The index of the vertex for the requested top square corner
 	 */
-	inline Vertex3d::listIndex topSquareCorner(unsigned int c) {
-		return topSquareCornerIndex + (c % numCorners);
+	inline Vertex3d::listIndex SquarePieceGenerator::topSquareCorner(unsigned int c) const {
+		return this->topSquareCornerIndex + (c % numCorners);
 	}
 	
-	void generateShoulderCornerVerts(Vertex3d::list &verts, Point3d origin) {
-		Point3d topCenterPoint = origin + Vector3d(0, 0, height);
+	/**
+	 * Each shoulder corner is a part of a torus, whose normal points from
+	 * the circle at the center of its tube.
+	 */
+	void SquarePieceGenerator::generateShoulderCornerVerts(MeshData &mesh, Point3d origin) {
+		Point3d topCenterPoint = origin + Vector3d(0, 0, this->height);
 		double innerRadius = radius - edgeRadius;
 		Point3d::list cornerPoints = generateCornerPoints(topCenterPoint, innerRadius);
 
-		topShoulderCornerIndex = (Vertex3d::listIndex)verts.size();
+		this->topShoulderCornerIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int c = 0; c < numCorners; c++) {
-			double tIStart = (double)c / (double)numCorners;
 			for(unsigned int i = 0; i <= numCornerSegments; i++) {
-				double tI = tIStart + ((double)i/(double)numCorners)/(double)numCornerSegments;
 				for(unsigned int j = 0; j < numShoulderSegments; j++) {
-					double tJ = (double)(j+1) / (double)(numShoulderSegments * 4);
-					Vector3d quarterUnitCircle = parametricUnitCircle(tJ);
-					Vector3d shoulderVector = parametricUnitCircle(tI);
+					Vector3d quarterUnitCircle = this->shoulderCircle[j+1];
+					Vector3d shoulderVector = this->cornerCircle[c * numCornerSegments + i];
+					Vector3d normal(quarterUnitCircle.y * shoulderVector.x, quarterUnitCircle.y * shoulderVector.y, quarterUnitCircle.x);
 					shoulderVector.x *= quarterUnitCircle.y * edgeRadius;
 					shoulderVector.y *= quarterUnitCircle.y * edgeRadius;
 					shoulderVector.z -= edgeRadius * (1.0 - quarterUnitCircle.x);
-					verts.push_back(cornerPoints.at(c) + shoulderVector);
+					mesh.addVertex(cornerPoints.at(c) + shoulderVector, normal);
 				}
 			}
 		}
@@ -485,30 +524,33 @@ namespace {
 	 * @param j An index of a shoulder segment (0 through numShoulderSegments)
 	 * @return The index of the requested shoulder corner vertex
 	 */
-	inline Vertex3d::listIndex topShoulderCorner(unsigned int c, unsigned int i, unsigned int j) {
-		return topShoulderCornerIndex
+	inline Vertex3d::listIndex SquarePieceGenerator::topShoulderCorner(unsigned int c, unsigned int i, unsigned int j) const {
+		return this->topShoulderCornerIndex
 			+ (c % numCorners) * (numCornerSegments + 1) * numShoulderSegments
 			+ (i % (numCornerSegments + 1)) * numShoulderSegments
 			+ (j % (numShoulderSegments));
 	}
 
-	void generateBeltVerts(Vertex3d::list &verts, Point3d origin) {
+	/**
+	 * The belt is a groove half a torus deep around each corner, whose
+	 * normal points toward the circle at the center of its tube.
+	 */
+	void SquarePieceGenerator::generateBeltVerts(MeshData &mesh, Point3d origin) {
 		Vector3d beltCenterOffset = Vector3d(0, 0, beltHeight);
 		Point3d beltCenterPoint = origin + beltCenterOffset;
 		double innerRadius = radius - edgeRadius;
 		Point3d::list cornerPoints = generateCornerPoints(beltCenterPoint, innerRadius);
 
-		beltIndex = (Vertex3d::listIndex)verts.size();
+		this->beltIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int c = 0; c < numCorners; c++) {
-			double tStart = (double)c / (double)numCorners;
 			for(unsigned int i = 0; i <= numCornerSegments; i++) {
-				double t = tStart + ((double)i/(double)numCorners)/(double)numCornerSegments;
 				for(unsigned int j = 0; j <= numBeltSegments; j++) {
-					double s = (double)j/(2.0*(double)numBeltSegments);
-					Vector3d v1 = beltRadius * parametricUnitCircle(s);
-					Vector3d v2 = (edgeRadius - v1.y) * parametricUnitCircle(t);
+					Vector3d v1 = beltRadius * this->beltCircle[j];
+					const Vector3d &direction = this->cornerCircle[c * numCornerSegments + i];
+					Vector3d v2 = (edgeRadius - v1.y) * direction;
 					v2.z = v1.x;
-					verts.push_back(cornerPoints.at(c) + v2);
+					Vector3d normal(this->beltCircle[j].y * direction.x, this->beltCircle[j].y * direction.y, -this->beltCircle[j].x);
+					mesh.addVertex(cornerPoints.at(c) + v2, normal);
 				}
 			}
 		}
@@ -520,25 +562,24 @@ namespace {
 	 * @param j An index of a belt segment break (0 through numBeltSegments)
 	 * @return The index of the requested belt vertex
 	 */
-	inline Vertex3d::listIndex belt(unsigned int c, unsigned int i, unsigned int j) {
-		return beltIndex
+	inline Vertex3d::listIndex SquarePieceGenerator::belt(unsigned int c, unsigned int i, unsigned int j) const {
+		return this->beltIndex
 			+ (c % numCorners) * (numCornerSegments + 1) * (numBeltSegments + 1)
 			+ (i % (numCornerSegments + 1)) * (numBeltSegments + 1)
 			+ (j % (numBeltSegments + 1));
 	}
 
-	void generateBeltTopVerts(Vertex3d::list &verts, Point3d origin) {
+	void SquarePieceGenerator::generateBeltTopVerts(MeshData &mesh, Point3d origin) {
 		Vector3d beltTopCenterOffset = Vector3d(0, 0, beltHeight + beltRadius);
 		Point3d beltTopCenterPoint = origin + beltTopCenterOffset;
 		double innerRadius = radius - edgeRadius;
 		Point3d::list cornerPoints = generateCornerPoints(beltTopCenterPoint, innerRadius);
 
-		beltTopIndex = (Vertex3d::listIndex)verts.size();
+		this->beltTopIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int c = 0; c < numCorners; c++) {
-			double tStart = (double)c / (double)numCorners;
 			for(unsigned int i = 0; i <= numCornerSegments; i++) {
-				double t = tStart + ((double)i/(double)numCorners)/(double)numCornerSegments;
-				verts.push_back(cornerPoints.at(c) + edgeRadius * parametricUnitCircle(t));
+				const Vector3d &normal = this->cornerCircle[c * numCornerSegments + i];
+				mesh.addVertex(cornerPoints.at(c) + edgeRadius * normal, normal);
 			}
 		}
 	}
@@ -548,24 +589,23 @@ namespace {
 	 * @param i An index of a corner segment break (0 through numCornerSegments)
 	 * @return The index of the requested outer belt top vertex
 	 */
-	inline Vertex3d::listIndex beltTop(unsigned int c, unsigned int i) {
-		return beltTopIndex
+	inline Vertex3d::listIndex SquarePieceGenerator::beltTop(unsigned int c, unsigned int i) const {
+		return this->beltTopIndex
 			+ (c % numCorners) * (numCornerSegments + 1)
 			+ (i % (numCornerSegments + 1));
 	}
 
-	void generateBeltBottomVerts(Vertex3d::list &verts, Point3d origin) {
+	void SquarePieceGenerator::generateBeltBottomVerts(MeshData &mesh, Point3d origin) {
 		Vector3d beltBottomCenterOffset = Vector3d(0, 0, beltHeight - beltRadius);
 		Point3d beltBottomCenterPoint = origin + beltBottomCenterOffset;
 		double innerRadius = radius - edgeRadius;
 		Point3d::list cornerPoints = generateCornerPoints(beltBottomCenterPoint, innerRadius);
 
-		beltBottomIndex = (Vertex3d::listIndex)verts.size();
+		this->beltBottomIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int c = 0; c < numCorners; c++) {
-			double tStart = (double)c / (double)numCorners;
 			for(unsigned int i = 0; i <= numCornerSegments; i++) {
-				double t = tStart + ((double)i/(double)numCorners)/(double)numCornerSegments;
-				verts.push_back(cornerPoints.at(c) + edgeRadius * parametricUnitCircle(t));
+				const Vector3d &normal = this->cornerCircle[c * numCornerSegments + i];
+				mesh.addVertex(cornerPoints.at(c) + edgeRadius * normal, normal);
 			}
 		}
 	}
@@ -575,20 +615,19 @@ namespace {
 	 * @param i An index of a corner segment break (0 through numCornerSegments)
 	 * @return The index of the requested outer belt bottom vertex
 	 */
-	inline Vertex3d::listIndex beltBottom(unsigned int c, unsigned int i) {
-		return beltBottomIndex
+	inline Vertex3d::listIndex SquarePieceGenerator::beltBottom(unsigned int c, unsigned int i) const {
+		return this->beltBottomIndex
 			+ (c % numCorners) * (numCornerSegments + 1)
 			+ (i % (numCornerSegments + 1));
 	}
 
-	void generateHoleTopVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d topCenterOffset = Vector3d(0, 0, height);
+	void SquarePieceGenerator::generateHoleTopVerts(MeshData &mesh, Point3d origin) {
+		Vector3d topCenterOffset = Vector3d(0, 0, this->height);
 		Point3d topCenterPoint = origin + topCenterOffset;
 
-		holeTopIndex = (Vertex3d::listIndex)verts.size();
+		this->holeTopIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int i = 0; i < numQuarterHoleSegments * 4; i++) {
-			double t = (double)i/(double)(numQuarterHoleSegments * 4);
-			verts.push_back(topCenterPoint + holeRadius * parametricUnitCircle(t));
+			mesh.addVertex(topCenterPoint + holeRadius * this->holeCircle[i], up);
 		}
 	}
 
@@ -597,21 +636,26 @@ namespace {
 	 * @param i An index of the quarter-hole (0 through numQuarterHoleSegments)
 	 * @return The index of the requested top quarter-hole vertex
 	 */
-	inline Vertex3d::listIndex holeTopQuarter(unsigned int c, unsigned int i) {
-		return holeTopIndex
+	inline Vertex3d::listIndex SquarePieceGenerator::holeTopQuarter(unsigned int c, unsigned int i) const {
+		return this->holeTopIndex
 			+ ((c % numCorners) * numQuarterHoleSegments
 			+ (i % (numQuarterHoleSegments + 1)))
 			% (numQuarterHoleSegments * 4);
 	}
 
-	void generateHoleBottomVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d holeBottomCenterOffset = Vector3d(0, 0, height - holeDepth);
+	/**
+	 * The hole's bottom is a shallow cone, sloping down to its center.
+	 */
+	void SquarePieceGenerator::generateHoleBottomVerts(MeshData &mesh, Point3d origin) {
+		Vector3d holeBottomCenterOffset = Vector3d(0, 0, this->height - holeDepth);
 		Point3d holeBottomCenterPoint = origin + holeBottomCenterOffset;
+		double slope = (holeCenterDepth - holeDepth) / holeRadius;
+		double length = sqrt(1.0 + slope * slope);
 
-		holeBottomIndex = (Vertex3d::listIndex)verts.size();
+		this->holeBottomIndex = (Vertex3d::listIndex)mesh.getNumVertices();
 		for(unsigned int i = 0; i < numQuarterHoleSegments * 4; i++) {
-			double t = (double)i/(double)(numQuarterHoleSegments * 4);
-			verts.push_back(holeBottomCenterPoint + holeRadius * parametricUnitCircle(t));
+			Vector3d normal(-slope * this->holeCircle[i].x / length, -slope * this->holeCircle[i].y / length, 1.0 / length);
+			mesh.addVertex(holeBottomCenterPoint + holeRadius * this->holeCircle[i], normal);
 		}
 	}
 
@@ -620,44 +664,64 @@ namespace {
 	 * @param i An index of the quarter-hole (0 through numQuarterHoleSegments)
 	 * @return The index of the requested bottom quarter-hole vertex
 	 */
-	inline Vertex3d::listIndex holeBottomQuarter(unsigned int c, unsigned int i) {
-		return holeBottomIndex
+	inline Vertex3d::listIndex SquarePieceGenerator::holeBottomQuarter(unsigned int c, unsigned int i) const {
+		return this->holeBottomIndex
 			+ ((c % numCorners) * numQuarterHoleSegments
 			+ (i % (numQuarterHoleSegments + 1)))
 			% (numQuarterHoleSegments * 4);
 	}
 
-	void generateHoleBottomCenterVerts(Vertex3d::list &verts, Point3d origin) {
-		Vector3d holeBottomCenterOffset = Vector3d(0, 0, height - holeCenterDepth);
+	void SquarePieceGenerator::generateHoleBottomCenterVerts(MeshData &mesh, Point3d origin) {
+		Vector3d holeBottomCenterOffset = Vector3d(0, 0, this->height - holeCenterDepth);
 
-		holeBottomCenterIndex = (Vertex3d::listIndex)verts.size();
-		verts.push_back(origin + holeBottomCenterOffset);
+		this->holeBottomCenterIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		mesh.addVertex(origin + holeBottomCenterOffset, up);
 	}
 
 	/**
 	 * @return The index of the hole bottom center vertex
 	 */
-	inline Vertex3d::listIndex holeBottomCenter() {
-		return holeBottomCenterIndex;
+	inline Vertex3d::listIndex SquarePieceGenerator::holeBottomCenter() const {
+		return this->holeBottomCenterIndex;
 	}
 
-}
+	/**
+	 * The wall's rings lie on the hole's top and bottom rings, but face the
+	 * hole's axis.
+	 */
+	void SquarePieceGenerator::generateHoleWallVerts(MeshData &mesh, Point3d origin) {
+		Vector3d holeBottomCenterOffset = Vector3d(0, 0, this->height - holeDepth);
+		Vector3d topCenterOffset = Vector3d(0, 0, this->height);
 
-namespace quarto {
+		this->holeWallIndex = (Vertex3d::listIndex)mesh.getNumVertices();
+		for(unsigned int i = 0; i < numQuarterHoleSegments * 4; i++) {
+			Vector3d normal(-this->holeCircle[i].x, -this->holeCircle[i].y, 0.0);
+			mesh.addVertex(origin + holeBottomCenterOffset + holeRadius * this->holeCircle[i], normal);
+			mesh.addVertex(origin + topCenterOffset + holeRadius * this->holeCircle[i], normal);
+		}
+	}
+
+	/**
+	 * @param c A corner index (0 through 3)
+	 * @param i An index of the quarter-hole (0 through numQuarterHoleSegments)
+	 * @param j 0 for the wall's bottom ring, 1 for its top
+	 * @return The index of the requested hole wall vertex
+	 */
+	inline Vertex3d::listIndex SquarePieceGenerator::holeWallQuarter(unsigned int c, unsigned int i, unsigned int j) const {
+		return this->holeWallIndex
+			+ (((c % numCorners) * numQuarterHoleSegments
+			+ (i % (numQuarterHoleSegments + 1)))
+			% (numQuarterHoleSegments * 4)) * 2
+			+ (j % 2);
+	}
 
-	void PieceModel::generateSquareModel() {
-		Model *pModel = this;
-		pModel->setOrigin(Point3d(0.0, 0.0, 0.0));
+}
 
-		material = (this->white ? whitePieceMaterial : blackPieceMaterial);
-		height = (this->tall ? tallHeight : shortHeight);
-		notSolid = this->hollow;
+namespace quarto {
 
-		generateBottomMesh(pModel);
-		generateTopMesh(pModel);
-		generateBeltMesh(pModel);
-		generateLegMesh(pModel);
-		generateHoleMeshes(pModel);
+	void PieceGeometry::generateSquareMeshes(bool isTall, bool isHollow, unsigned int level, MeshData::list &meshes) {
+		SquarePieceGenerator generator(isTall ? tallHeight : shortHeight, isHollow, level);
+		generator.generate(meshes);
 	}
 
 }
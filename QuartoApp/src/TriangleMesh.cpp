@@ -0,0 +1,68 @@
+/**
+* @file TriangleMesh.cpp
+*/
+#include "TriangleMesh.hpp"
+#include <cmath>
+
+namespace quarto {
+
+	/**
+	 * A mesh that keeps its source's normals skips averaging altogether.
+	 */
+	TriangleMesh::TriangleMesh(const MeshData &mesh, NormalSource normalSource) : source(mesh), boundingRadius(0.0) {
+		this->triangles.reserve(3 * mesh.getNumTriangles());
+		unsigned int numMaterials = mesh.getNumMaterials();
+		for(unsigned int m = 0; m < numMaterials; m++) {
+			Part part;
+			part.material = m;
+			part.first = this->triangles.size() / 3;
+			mesh.getTriangles(m, this->triangles);
+			part.count = this->triangles.size() / 3 - part.first;
+			if(part.count > 0)
+				this->parts.push_back(part);
+		}
+		if(normalSource == AVERAGED_NORMALS || mesh.getNormals() == NULL)
+			generateNormals();
+
+		const float *p = getPositions();
+		for(std::size_t i = 0; i < 3 * getNumVertices(); i += 3) {
+			double r = std::sqrt((double)p[i] * p[i] + (double)p[i + 1] * p[i + 1] + (double)p[i + 2] * p[i + 2]);
+			if(r > this->boundingRadius)
+				this->boundingRadius = r;
+		}
+	}
+
+	/**
+	 * Each vertex's normal is the sum of the normals of the triangles around
+	 * it, weighted by their areas, and then scaled to unit length.
+	 */
+	void TriangleMesh::generateNormals() {
+		const float *p = getPositions();
+		std::vector<double> sums(3 * getNumVertices(), 0.0);
+		for(std::size_t i = 0; i < this->triangles.size(); i += 3) {
+			const float *a = p + 3 * this->triangles[i];
+			const float *b = p + 3 * this->triangles[i + 1];
+			const float *c = p + 3 * this->triangles[i + 2];
+			double u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			double v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			double n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+			for(std::size_t j = 0; j < 3; j++) {
+				double *sum = &sums[3 * this->triangles[i + j]];
+				sum[0] += n[0];
+				sum[1] += n[1];
+				sum[2] += n[2];
+			}
+		}
+
+		this->normals.resize(sums.size());
+		for(std::size_t i = 0; i < sums.size(); i += 3) {
+			double length = std::sqrt(sums[i] * sums[i] + sums[i + 1] * sums[i + 1] + sums[i + 2] * sums[i + 2]);
+			if(length > 0.0) {
+				this->normals[i] = (float)(sums[i] / length);
+				this->normals[i + 1] = (float)(sums[i + 1] / length);
+				this->normals[i + 2] = (float)(sums[i + 2] / length);
+			}
+		}
+	}
+
+}
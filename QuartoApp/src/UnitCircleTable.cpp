@@ -0,0 +1,64 @@
+/**
+* @file UnitCircleTable.cpp
+*/
+#include "UnitCircleTable.hpp"
+#include <boost/thread/mutex.hpp>
+#include <map>
+
+using peek::parametricUnitCircle;
+
+namespace {
+
+	using namespace quarto;
+
+	struct TableKey {
+		unsigned int numSamples;
+		double step;
+		double phase;
+
+		bool operator<(const TableKey &other) const {
+			if(numSamples != other.numSamples)
+				return numSamples < other.numSamples;
+			if(step != other.step)
+				return step < other.step;
+			return phase < other.phase;
+		}
+	};
+
+	/** Guards the tables, which generators on several threads may ask for at once */
+	boost::mutex tablesMutex;
+	std::map<TableKey, const UnitCircleTable *> tables;
+
+}
+
+namespace quarto {
+
+	const UnitCircleTable &UnitCircleTable::get(unsigned int numSegments, double phase) {
+		return get(numSegments, 1.0 / (double)numSegments, phase);
+	}
+
+	/**
+	 * A table is looked up by the exact values it was built with, which the
+	 * generators derive from the same constants every time.
+	 */
+	const UnitCircleTable &UnitCircleTable::get(unsigned int numSamples, double step, double phase) {
+		TableKey key;
+		key.numSamples = numSamples;
+		key.step = step;
+		key.phase = phase;
+
+		boost::mutex::scoped_lock lock(tablesMutex);
+		const UnitCircleTable *&table = tables[key];
+		if(table == NULL)
+			table = new UnitCircleTable(numSamples, step, phase);
+		return *table;
+	}
+
+	UnitCircleTable::UnitCircleTable(unsigned int numSamples, double step, double phase) {
+		this->samples.reserve(numSamples);
+		for(unsigned int i = 0; i < numSamples; i++) {
+			this->samples.push_back(parametricUnitCircle(phase + (double)i * step));
+		}
+	}
+
+}
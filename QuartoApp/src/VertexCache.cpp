@@ -0,0 +1,196 @@
+/**
+* @file VertexCache.cpp
+*/
+#include "VertexCache.hpp"
+#include <cmath>
+
+namespace {
+
+	using namespace quarto;
+
+	// The scoring constants of Forsyth's article, which models a 32-entry cache
+	const std::size_t maxCacheSize = 32;
+	const double cacheDecayPower = 1.5;
+	const double lastTriangleScore = 0.75;
+	const double valenceBoostScale = 2.0;
+	const double valenceBoostPower = 0.5;
+
+	const std::size_t noTriangle = (std::size_t)-1;
+
+	/**
+	 * Vertices of the last triangle drawn score a little less than the next
+	 * few in the cache, which makes the order favor strips over fans, and
+	 * vertices with few triangles left score more, so none is left behind
+	 * to be shaded again much later.
+	 *
+	 * @param cachePosition The vertex's place in the cache, or -1 if it is not cached
+	 * @param numTriangles The number of triangles still to be drawn that use the vertex
+	 */
+	double getVertexScore(int cachePosition, std::size_t numTriangles) {
+		if(numTriangles == 0)
+			return -1.0;
+
+		double score = 0.0;
+		if(cachePosition >= 0) {
+			if(cachePosition < 3) {
+				score = lastTriangleScore;
+			} else {
+				double scale = 1.0 / (double)(maxCacheSize - 3);
+				score = std::pow(1.0 - (double)(cachePosition - 3) * scale, cacheDecayPower);
+			}
+		}
+		return score + valenceBoostScale * std::pow((double)numTriangles, -valenceBoostPower);
+	}
+
+}
+
+namespace quarto {
+
+	void VertexCacheStats::add(const VertexCacheStats &stats) {
+		this->numTriangles += stats.numTriangles;
+		this->missesBefore += stats.missesBefore;
+		this->missesAfter += stats.missesAfter;
+	}
+
+	double VertexCacheStats::getAcmrBefore() const {
+		return (this->numTriangles == 0 ? 0.0 : (double)this->missesBefore / (double)this->numTriangles);
+	}
+
+	double VertexCacheStats::getAcmrAfter() const {
+		return (this->numTriangles == 0 ? 0.0 : (double)this->missesAfter / (double)this->numTriangles);
+	}
+
+	/**
+	 * A vertex is still cached if fewer than a cache's worth of misses have
+	 * happened since it was loaded, since each miss pushes out the oldest.
+	 */
+	std::size_t countVertexCacheMisses(const std::vector<boost::uint32_t> &triangles, std::size_t numVertices) {
+		const std::size_t notLoaded = (std::size_t)-1;
+		std::vector<std::size_t> loadedAt(numVertices, notLoaded);
+		std::size_t misses = 0;
+		for(std::size_t i = 0; i < triangles.size(); i++) {
+			std::size_t &loaded = loadedAt[triangles[i]];
+			if(loaded == notLoaded || misses - loaded >= simulatedVertexCacheSize) {
+				loaded = misses;
+				misses++;
+			}
+		}
+		return misses;
+	}
+
+	/**
+	 * Draws greedily: the next triangle is the best scoring of those using a
+	 * cached vertex, and the first triangle left when none does. Only the
+	 * scores of vertices whose place in the cache changed are updated, so
+	 * the time taken grows with the number of triangles.
+	 */
+	void optimizeVertexCache(std::vector<boost::uint32_t> &triangles, std::size_t numVertices) {
+		std::size_t numTriangles = triangles.size() / 3;
+		if(numTriangles == 0)
+			return;
+
+		// The triangles left to draw around each vertex
+		std::vector<std::size_t> numVertexTriangles(numVertices, 0);
+		for(std::size_t i = 0; i < triangles.size(); i++) {
+			numVertexTriangles[triangles[i]]++;
+		}
+		std::vector<std::size_t> firstVertexTriangle(numVertices + 1, 0);
+		for(std::size_t v = 0; v < numVertices; v++) {
+			firstVertexTriangle[v + 1] = firstVertexTriangle[v] + numVertexTriangles[v];
+		}
+		std::vector<std::size_t> vertexTriangles(triangles.size());
+		{
+			std::vector<std::size_t> next(firstVertexTriangle.begin(), firstVertexTriangle.end() - 1);
+			for(std::size_t i = 0; i < triangles.size(); i++) {
+				vertexTriangles[next[triangles[i]]++] = i / 3;
+			}
+		}
+
+		std::vector<int> cachePosition(numVertices, -1);
+		std::vector<double> vertexScores(numVertices);
+		for(std::size_t v = 0; v < numVertices; v++) {
+			vertexScores[v] = getVertexScore(-1, numVertexTriangles[v]);
+		}
+
+		std::vector<bool> drawn(numTriangles, false);
+		std::vector<boost::uint32_t> cache;
+		std::vector<boost::uint32_t> newCache;
+		cache.reserve(maxCacheSize + 3);
+		newCache.reserve(maxCacheSize + 3);
+		std::vector<boost::uint32_t> ordered;
+		ordered.reserve(triangles.size());
+
+		std::size_t best = noTriangle;
+		std::size_t firstLeft = 0;
+		for(std::size_t n = 0; n < numTriangles; n++) {
+			if(best == noTriangle) {
+				while(drawn[firstLeft])
+					firstLeft++;
+				best = firstLeft;
+			}
+
+			drawn[best] = true;
+			const boost::uint32_t *t = &triangles[3 * best];
+			newCache.clear();
+			for(std::size_t j = 0; j < 3; j++) {
+				ordered.push_back(t[j]);
+
+				// Remove the triangle from those left around its vertex
+				std::size_t first = firstVertexTriangle[t[j]];
+				std::size_t last = first + numVertexTriangles[t[j]] - 1;
+				for(std::size_t k = first; k <= last; k++) {
+					if(vertexTriangles[k] == best) {
+						vertexTriangles[k] = vertexTriangles[last];
+						break;
+					}
+				}
+				numVertexTriangles[t[j]]--;
+				newCache.push_back(t[j]);
+			}
+
+			// The triangle's vertices move to the front of the cache
+			for(std::size_t j = 0; j < cache.size(); j++) {
+				if(cache[j] != t[0] && cache[j] != t[1] && cache[j] != t[2])
+					newCache.push_back(cache[j]);
+			}
+			for(std::size_t j = 0; j < newCache.size(); j++) {
+				boost::uint32_t v = newCache[j];
+				cachePosition[v] = (j < maxCacheSize ? (int)j : -1);
+				vertexScores[v] = getVertexScore(cachePosition[v], numVertexTriangles[v]);
+			}
+			if(newCache.size() > maxCacheSize)
+				newCache.resize(maxCacheSize);
+			cache.swap(newCache);
+
+			best = noTriangle;
+			double bestScore = -1.0;
+			for(std::size_t j = 0; j < cache.size(); j++) {
+				boost::uint32_t v = cache[j];
+				std::size_t first = firstVertexTriangle[v];
+				for(std::size_t k = first; k < first + numVertexTriangles[v]; k++) {
+					const boost::uint32_t *u = &triangles[3 * vertexTriangles[k]];
+					double score = vertexScores[u[0]] + vertexScores[u[1]] + vertexScores[u[2]];
+					if(score > bestScore) {
+						bestScore = score;
+						best = vertexTriangles[k];
+					}
+				}
+			}
+		}
+
+		triangles.swap(ordered);
+	}
+
+	std::size_t optimizeVertexFetch(std::vector<boost::uint32_t> &triangles, std::vector<boost::uint32_t> &remap, std::size_t numVertices) {
+		remap.assign(numVertices, unusedVertex);
+		boost::uint32_t numUsed = 0;
+		for(std::size_t i = 0; i < triangles.size(); i++) {
+			boost::uint32_t &v = remap[triangles[i]];
+			if(v == unusedVertex)
+				v = numUsed++;
+			triangles[i] = v;
+		}
+		return numUsed;
+	}
+
+}
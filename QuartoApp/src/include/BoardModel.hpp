@@ -3,23 +3,32 @@
  */
 #pragma once
 
+#include "MeshModel.hpp"
 #include <handle_traits.hpp>
 #include <list_traits.hpp>
-#include <Model.hpp>
 
 // Implementation dependencies
 using peek::handle_traits;
 using peek::list_traits;
 using peek::Point3d;
 using peek::Vertex3d;
-using peek::Model;
 
 namespace quarto {
 
-	class BoardModel : public Model {
+	class BoardModel : public MeshModel {
 	public:
 
-		BoardModel();
+		/** The material numbers of the parts of the board's meshes */
+		enum MeshMaterial {
+			SURFACE_MATERIAL,
+			GROOVE_MATERIAL,
+			NUM_MESH_MATERIALS
+		};
+
+		explicit BoardModel(const MeshData::list &meshes);
+
+		/** Tessellates the board at every level of detail, appending a mesh for each */
+		static void generateMeshes(MeshData::list &meshes);
 
 		static Point3d getMarkerPosition(unsigned int i, unsigned int j);
 
@@ -41,10 +50,6 @@ namespace quarto {
 
 		typedef list_traits<BoardModel::handle>::list_type list;
 
-	private:
-
-		void generateModel();
-
 	};
 
 }
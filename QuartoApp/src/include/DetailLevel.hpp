@@ -0,0 +1,54 @@
+/**
+ * @file DetailLevel.hpp
+ */
+#pragma once
+
+namespace quarto {
+
+	/*
+	 * Each model is generated at several levels of detail from the same
+	 * generator. Level 0 uses the tessellation constants as they are, and
+	 * each coarser level halves every segment count, so a level has about a
+	 * quarter of the triangles of the one before it.
+	 */
+
+	/** The number of levels each model is generated at */
+	const unsigned int numDetailLevels = 3;
+
+	/** The smallest projected size, in pixels, at which each level but the coarsest is drawn */
+	const double detailLevelMinSizes[numDetailLevels - 1] = { 96.0, 32.0 };
+
+	/**
+	 * @param numSegments The segment count at level 0
+	 * @param minSegments The fewest segments the shape still holds together with
+	 * @return numSegments halved once a level, rounding up, but no fewer than minSegments
+	 */
+	inline unsigned int getDetailSegments(unsigned int numSegments, unsigned int level, unsigned int minSegments) {
+		unsigned int n = (numSegments + (1u << level) - 1) >> level;
+		return (n < minSegments ? minSegments : n);
+	}
+
+	/**
+	 * For shapes built from two halves of the same number of segments.
+	 *
+	 * @param numSegments The segment count at level 0, which is even
+	 * @param minSegments The fewest segments the shape still holds together with, which is even
+	 * @return getDetailSegments rounded up to an even count
+	 */
+	inline unsigned int getEvenDetailSegments(unsigned int numSegments, unsigned int level, unsigned int minSegments) {
+		unsigned int n = getDetailSegments(numSegments, level, minSegments);
+		return n + (n & 1);
+	}
+
+	/**
+	 * @param projectedSize The height in pixels a model's bounding sphere covers on screen
+	 * @return The coarsest level that still looks the same at that size
+	 */
+	inline unsigned int selectDetailLevel(double projectedSize) {
+		unsigned int level = 0;
+		while(level < numDetailLevels - 1 && projectedSize < detailLevelMinSizes[level])
+			level++;
+		return level;
+	}
+
+}
@@ -0,0 +1,65 @@
+/**
+ * @file HintAnalysis.hpp
+ */
+#pragma once
+
+#include "Game.hpp"
+#include "Position.hpp"
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace quarto {
+
+	/**
+	 * @brief A search for the best move that runs on its own thread
+	 *
+	 * The search writes to a table and wakes the render loop, so whoever
+	 * starts an analysis must join() it, cancelled or not, before the table
+	 * or the window goes away. A cancelled analysis can be set aside and
+	 * joined later, once its search has unwound.
+	 */
+	class HintAnalysis : boost::noncopyable {
+	public:
+
+		typedef boost::shared_ptr<HintAnalysis> handle;
+
+		/** Starts analysing the game's current position in the background */
+		static handle start(const Game &game, TranspositionTable &table, const SearchLimits &limits);
+
+		/** Stops the search without waiting for it; the result is never reported */
+		void cancel();
+
+		/** Waits for the analysis thread to return */
+		void join();
+
+		inline bool isFinished() const { return finished.load(boost::memory_order_acquire); }
+
+		/** @return The suggested move; only valid once the analysis has finished */
+		inline Move getMove() const { return result.move; }
+
+		/** @return A mask of the pieces that are safe to give after the suggested placement */
+		inline boost::uint16_t getSafePieces() const { return safePieces; }
+
+	private:
+
+		HintAnalysis(const Position &position, TranspositionTable &table, const SearchLimits &limits);
+
+		Position position;
+		SearchLimits limits;
+		Search search;
+		SearchResult result;
+		boost::uint16_t safePieces;
+		boost::atomic<bool> finished;
+		boost::atomic<bool> cancelled;
+		boost::scoped_ptr<boost::thread> thread;
+
+		static void run(handle analysis);
+
+	};
+
+}
@@ -3,20 +3,19 @@
  */
 #pragma once
 
+#include "MeshModel.hpp"
 #include <handle_traits.hpp>
 #include <list_traits.hpp>
-#include <Model.hpp>
 
 // Implementation dependencies
 using peek::handle_traits;
 using peek::list_traits;
 using peek::Point3d;
 using peek::Vertex3d;
-using peek::Model;
 
 namespace quarto {
 
-	class MarkerModel : public Model {
+	class MarkerModel : public MeshModel {
 	public:
 
 		MarkerModel();
@@ -30,7 +29,8 @@ namespace quarto {
 
 	private:
 
-		void generateModel();
+		/** Tessellates a marker at every level of detail, appending its meshes */
+		static void generateMeshes(MeshData::list &meshes);
 
 	};
 
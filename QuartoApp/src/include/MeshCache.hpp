@@ -0,0 +1,73 @@
+/**
+ * @file MeshCache.hpp
+ */
+#pragma once
+
+#include "MeshData.hpp"
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+namespace boost { namespace interprocess { class mapped_region; } }
+
+namespace quarto {
+
+	/**
+	 * @brief A file of generated meshes, memory-mapped on later launches
+	 *
+	 * The cache holds the meshes of a number of models, each a list of
+	 * meshes in the order they were generated. Its header carries a key
+	 * hashed from every BoardModel and PieceModel tessellation constant and
+	 * the version of the generators, so a cache written for other constants
+	 * or by older generators is stale and is not read; the application then
+	 * generates the meshes again and replaces the file.
+	 *
+	 * The file is written in the machine's byte order. A cache that is read
+	 * is mapped, not copied: its meshes borrow their vertex and index arrays
+	 * from the mapping.
+	 */
+	class MeshCache : boost::noncopyable {
+	public:
+
+		explicit MeshCache(const std::string &filename);
+
+		/**
+		 * Maps the file and checks its header and the bounds of every mesh.
+		 *
+		 * @return false if the file is missing, malformed or stale
+		 */
+		bool open();
+
+		/** Unmaps the file; meshes already read from it keep it mapped */
+		void close();
+
+		/** @return true if the cache is open and holds meshes of the model */
+		bool hasMeshes(unsigned int model) const;
+
+		/**
+		 * @param model The index the model was written under
+		 * @param meshes Receives the model's meshes, which keep the file mapped
+		 * @return false if the cache is not open or has no such model
+		 */
+		bool getMeshes(unsigned int model, MeshData::list &meshes) const;
+
+		/**
+		 * Writes the meshes of each model to a temporary file and renames it
+		 * over the cache. Windows can neither replace nor remove a mapped
+		 * file, so the cache should be closed, with no meshes read from it
+		 * still alive.
+		 *
+		 * @return true if the whole cache was written
+		 */
+		bool write(const std::vector<MeshData::list> &models) const;
+
+		/** @return The hash of the tessellation constants a cache must match */
+		static boost::uint64_t getKey();
+
+	private:
+		std::string filename;
+		boost::shared_ptr<boost::interprocess::mapped_region> mapping;
+	};
+
+}
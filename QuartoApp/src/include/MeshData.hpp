@@ -0,0 +1,163 @@
+/**
+ * @file MeshData.hpp
+ */
+#pragma once
+
+#include "DetailLevel.hpp"
+#include "VertexCache.hpp"
+#include <Vector3d.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+namespace boost { namespace interprocess { class mapped_region; } }
+
+// Implementation dependencies
+using peek::Point3d;
+using peek::Vector3d;
+using peek::Vertex3d;
+
+namespace quarto {
+
+	/**
+	 * @brief The vertices and faces of one mesh, in flat arrays
+	 *
+	 * The generators append to a mesh rather than building Peek's primitives
+	 * directly, so a generated mesh can be written to the mesh cache as it is
+	 * and read back on a later launch without being generated again.
+	 *
+	 * Each primitive is a range of the index array drawn in one material, so
+	 * surfaces of several materials can share one pool of vertices. The
+	 * ranges are turned into one list of triangles for each material when
+	 * the mesh is built into a TriangleMesh for drawing.
+	 *
+	 * A generator that knows its surface exactly gives every vertex the
+	 * surface's normal there. A mesh whose vertices were added without
+	 * normals has them averaged from its faces instead.
+	 *
+	 * A mesh read from the cache borrows its arrays from the mapped file,
+	 * which stays mapped for as long as any mesh borrows from it; such a mesh
+	 * must not be appended to.
+	 */
+	class MeshData {
+	public:
+
+		enum PrimitiveType {
+			TRIANGLE_FAN,
+			TRIANGLE_STRIP,
+			TRIANGLE,
+			QUADRILATERAL,
+			/** Any number of triangles, three indices each */
+			TRIANGLE_LIST,
+			NUM_PRIMITIVE_TYPES
+		};
+
+		/**
+		 * @brief One primitive: count indices starting at first, drawn in a
+		 * material number that the model owning the mesh interprets
+		 */
+		struct Range {
+			boost::uint32_t type;
+			boost::uint32_t material;
+			boost::uint32_t first;
+			boost::uint32_t count;
+		};
+
+		/**
+		 * @param material The material of primitives begun before setMaterial() is called
+		 * @param level The level of detail the mesh was generated at
+		 */
+		explicit MeshData(unsigned int material = 0, unsigned int level = 0);
+
+		/**
+		 * Borrows arrays from a mapped file.
+		 *
+		 * @param region The mapping the arrays lie in, kept open by the mesh
+		 * @param positions Three coordinates for each vertex
+		 * @param normals Three coordinates for each vertex, or NULL if the mesh has none
+		 */
+		MeshData(unsigned int level, const boost::shared_ptr<boost::interprocess::mapped_region> &region,
+			const float *positions, const float *normals, std::size_t numVertices,
+			const boost::uint32_t *indices, std::size_t numIndices,
+			const Range *ranges, std::size_t numRanges);
+
+		/** @return The index of the new vertex */
+		Vertex3d::listIndex addVertex(const Point3d &p);
+
+		/**
+		 * Adds a vertex with the unit normal of the surface at it. Either
+		 * every vertex of a mesh has a normal or none has.
+		 *
+		 * @return The index of the new vertex
+		 */
+		Vertex3d::listIndex addVertex(const Point3d &p, const Vector3d &n);
+
+		/** Sets the material of the primitives begun after it */
+		inline void setMaterial(unsigned int material) { this->material = material; }
+
+		/** Starts a primitive, which the following calls to addIndex() extend */
+		void beginPrimitive(PrimitiveType type);
+		void addIndex(Vertex3d::listIndex index);
+
+		void addTriangle(Vertex3d::listIndex v1, Vertex3d::listIndex v2, Vertex3d::listIndex v3);
+		void addQuadrilateral(Vertex3d::listIndex v1, Vertex3d::listIndex v2, Vertex3d::listIndex v3, Vertex3d::listIndex v4);
+
+		inline unsigned int getLevel() const { return level; }
+		inline void setLevel(unsigned int level) { this->level = level; }
+
+		inline std::size_t getNumVertices() const { return numVertices; }
+		inline std::size_t getNumIndices() const { return numIndices; }
+		inline std::size_t getNumRanges() const { return numRanges; }
+
+		const float *getPositions() const;
+		/** @return Three coordinates for each vertex, or NULL if the vertices were added without normals */
+		const float *getNormals() const;
+		const boost::uint32_t *getIndices() const;
+		const Range *getRanges() const;
+
+		/** @return One more than the largest material number of any primitive */
+		unsigned int getNumMaterials() const;
+
+		/** @return The number of triangles getTriangles() makes of all the primitives */
+		std::size_t getNumTriangles() const;
+
+		/**
+		 * Appends three indices for each triangle of each primitive in a
+		 * material, wound the way GL winds the primitive.
+		 */
+		void getTriangles(unsigned int material, std::vector<boost::uint32_t> &triangles) const;
+
+		/**
+		 * Replaces the primitives with one list of triangles for each
+		 * material, each ordered for the vertex cache, and renumbers the
+		 * vertices in the order the lists use them. Vertices no triangle uses
+		 * are dropped. A mesh read from the cache must not be optimized.
+		 *
+		 * @param stats Has the cache misses of the mesh before and after added
+		 */
+		void optimize(VertexCacheStats &stats);
+
+		typedef std::vector<MeshData> list;
+
+	private:
+		unsigned int material;
+		unsigned int level;
+		std::size_t numVertices;
+		std::size_t numIndices;
+		std::size_t numRanges;
+
+		// Storage for a mesh being generated
+		std::vector<float> positionStorage;
+		std::vector<float> normalStorage;
+		std::vector<boost::uint32_t> indexStorage;
+		std::vector<Range> rangeStorage;
+
+		// Storage for a mesh read from the cache
+		boost::shared_ptr<boost::interprocess::mapped_region> mapping;
+		const float *mappedPositions;
+		const float *mappedNormals;
+		const boost::uint32_t *mappedIndices;
+		const Range *mappedRanges;
+	};
+
+}
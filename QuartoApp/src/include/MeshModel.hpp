@@ -0,0 +1,106 @@
+/**
+ * @file MeshModel.hpp
+ */
+#pragma once
+
+#include "TriangleMesh.hpp"
+#include <Model.hpp>
+#include <vector>
+
+// Implementation dependencies
+using peek::Point3d;
+using peek::Model;
+
+namespace quarto {
+
+	/**
+	 * @brief The colors and shininess GL lights a surface with
+	 */
+	struct SurfaceMaterial {
+		float ambient[4];
+		float diffuse[4];
+		float specular[4];
+		float emission[4];
+		float shininess;
+
+		/** Makes this the material of the front faces drawn next */
+		void apply() const;
+	};
+
+	/**
+	 * @brief A model drawn from triangle meshes with one GL call a material
+	 *
+	 * Peek's meshes keep a heap object for every primitive and draw them one
+	 * by one; a mesh model instead draws each material's part of a mesh with
+	 * a single glDrawElements() from the mesh's flat arrays. The models
+	 * sharing a mesh share its arrays, so a model allocates only its lists
+	 * of meshes and parts.
+	 *
+	 * A model holds its meshes at every level of detail, and draws those of
+	 * the level that suits the size its bounding sphere covers on screen.
+	 * The model draws itself at its origin, and keeps the debugging views of
+	 * Peek's models, which hide those of the base class.
+	 */
+	class MeshModel : public Model {
+	public:
+
+		virtual void draw();
+
+		/** Draws the model's finest triangles and nothing else, for selection */
+		void pick();
+
+		void toggleShowSolidGeometry();
+		void toggleShowWireframe();
+		void toggleShowNormals();
+		void toggleSmoothShading();
+		void decreaseNormalScale();
+		void increaseNormalScale();
+
+	protected:
+
+		MeshModel();
+
+		/** Makes room for a number of meshes, so adding them allocates no more */
+		void reserveMeshes(std::size_t numMeshes);
+
+		/** @param material A material that outlives the model, for every part of the mesh */
+		void addMesh(const TriangleMesh::handle &mesh, const SurfaceMaterial &material);
+
+		/**
+		 * @param materials The material of each material number, each
+		 * outliving the model; parts numbered past them are not drawn
+		 */
+		void addMesh(const TriangleMesh::handle &mesh, const SurfaceMaterial *const *materials, unsigned int numMaterials);
+
+	private:
+
+		/**
+		 * @brief The triangles of a mesh drawn in one call: count of them from first
+		 */
+		struct Batch {
+			const TriangleMesh *mesh;
+			std::size_t first;
+			std::size_t count;
+			const SurfaceMaterial *material;
+		};
+
+		std::vector<TriangleMesh::handle> meshes;
+		std::vector<Batch> batches;
+		/** The distance from the origin to the farthest vertex of any mesh */
+		double boundingRadius;
+
+		bool showSolidGeometry;
+		bool showWireframe;
+		bool showNormals;
+		bool smoothShading;
+		double normalScale;
+
+		/** @return The level of detail to draw at with the current matrices and viewport */
+		unsigned int selectLevel() const;
+
+		void drawSolidGeometry(unsigned int level) const;
+		void drawWireframe(unsigned int level) const;
+		void drawNormals(unsigned int level) const;
+	};
+
+}
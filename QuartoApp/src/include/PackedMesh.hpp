@@ -0,0 +1,86 @@
+/**
+ * @file PackedMesh.hpp
+ */
+#pragma once
+
+#include "TriangleMesh.hpp"
+#include <boost/cstdint.hpp>
+#include <vector>
+
+namespace quarto {
+
+	/**
+	 * @brief A triangle mesh in a compact vertex format for GPU upload
+	 *
+	 * Each vertex takes ten bytes rather than the 24 of a TriangleMesh's
+	 * float positions and normals:
+	 *
+	 * - Its position is three 16-bit integers spanning the mesh's bounding
+	 *   box, so it is drawn as GL_SHORT coordinates scaled by getScale() and
+	 *   moved to getCenter().
+	 * - Its normal is octahedron-encoded: projected onto the octahedron
+	 *   |x| + |y| + |z| = 1, with the lower half folded over the upper, and
+	 *   stored as two 16-bit signed normalized coordinates that a vertex
+	 *   shader unfolds and normalizes.
+	 *
+	 * Indices take 16 bits, so a mesh of more than 65536 vertices cannot be
+	 * packed. The largest error packing made in a position and in a normal is
+	 * measured against the source mesh.
+	 */
+	class PackedMesh {
+	public:
+
+		struct Vertex {
+			boost::int16_t position[3];
+			boost::int16_t normal[2];
+		};
+
+		PackedMesh();
+
+		/**
+		 * Replaces the mesh with a packed copy of another.
+		 *
+		 * @return false, leaving the mesh empty, if the other has too many vertices
+		 */
+		bool pack(const TriangleMesh &mesh);
+
+		inline std::size_t getNumVertices() const { return vertices.size(); }
+		inline std::size_t getNumIndices() const { return indices.size(); }
+
+		inline const Vertex *getVertices() const { return (vertices.empty() ? NULL : &vertices[0]); }
+		inline const boost::uint16_t *getIndices() const { return (indices.empty() ? NULL : &indices[0]); }
+
+		/** @return The center of the bounding box, which a packed position of zero stands for */
+		inline const float *getCenter() const { return center; }
+		/** @return The size of one step of each packed coordinate */
+		inline const float *getScale() const { return scale; }
+
+		/** @return The size of the vertex and index arrays in bytes */
+		std::size_t getNumBytes() const;
+
+		/**
+		 * A position is never further off than half a step along each axis,
+		 * which bounds this error before it is measured.
+		 *
+		 * @return The largest distance between a source position and its unpacked position
+		 */
+		inline double getMaxPositionError() const { return maxPositionError; }
+		/** @return The largest angle, in radians, between a source normal and its unpacked normal */
+		inline double getMaxNormalError() const { return maxNormalError; }
+
+		/** Decodes a packed normal to unit length */
+		static void unpackNormal(const boost::int16_t packed[2], double normal[3]);
+
+	private:
+		std::vector<Vertex> vertices;
+		std::vector<boost::uint16_t> indices;
+		float center[3];
+		float scale[3];
+		double maxPositionError;
+		double maxNormalError;
+
+		void packPosition(const float *position, Vertex &vertex);
+		void packNormal(const float *normal, Vertex &vertex);
+	};
+
+}
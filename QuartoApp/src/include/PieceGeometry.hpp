@@ -0,0 +1,50 @@
+/**
+ * @file PieceGeometry.hpp
+ */
+#pragma once
+
+#include "TriangleMesh.hpp"
+#include <handle_traits.hpp>
+
+// Implementation dependencies
+using peek::handle_traits;
+
+namespace quarto {
+
+	/**
+	 * @brief The meshes of one piece shape, without a material
+	 *
+	 * A light piece and a dark piece of the same shape share one geometry, so
+	 * each of the eight shapes is tessellated once. A geometry never changes
+	 * after it is made, so models on any thread may share it.
+	 */
+	class PieceGeometry {
+	public:
+
+		/**
+		 * @param meshes Meshes from generateMeshes() or the mesh cache
+		 */
+		PieceGeometry(bool isRound, bool isTall, bool isHollow, const MeshData::list &meshes);
+
+		/** Tessellates a shape at every level of detail, appending its meshes */
+		static void generateMeshes(bool isRound, bool isTall, bool isHollow, MeshData::list &meshes);
+
+		inline bool isRound() const { return round; }
+		inline bool isTall() const { return tall; }
+		inline bool isHollow() const { return hollow; }
+
+		inline const TriangleMesh::list &getMeshes() const { return meshes; }
+
+		typedef handle_traits<PieceGeometry>::handle_type handle;
+
+	private:
+		bool round;
+		bool tall;
+		bool hollow;
+		TriangleMesh::list meshes;
+
+		static void generateRoundMeshes(bool isTall, bool isHollow, unsigned int level, MeshData::list &meshes);
+		static void generateSquareMeshes(bool isTall, bool isHollow, unsigned int level, MeshData::list &meshes);
+	};
+
+}
@@ -3,23 +3,26 @@
  */
 #pragma once
 
+#include "MeshModel.hpp"
+#include "PieceGeometry.hpp"
 #include <handle_traits.hpp>
 #include <list_traits.hpp>
-#include <Model.hpp>
 
 // Implementation dependencies
 using peek::handle_traits;
 using peek::list_traits;
 using peek::Point3d;
 using peek::Vertex3d;
-using peek::Model;
 
 namespace quarto {
 
-	class PieceModel : public Model {
+	/**
+	 * @brief A piece: a shared geometry drawn in the piece's own material
+	 */
+	class PieceModel : public MeshModel {
 	public:
 
-		PieceModel(bool isRound, bool isTall, bool isHollow, bool isWhite);
+		PieceModel(const PieceGeometry::handle &geometry, bool isWhite);
 
 		// Common parameters
 		static const double radius;
@@ -42,23 +45,20 @@ namespace quarto {
 		static const unsigned int numCornerSegments;
 		static const unsigned int numQuarterHoleSegments;
 
-		inline bool isRound() const { return round; }
-		inline bool isTall() const { return tall; }
-		inline bool isHollow() const { return hollow; }
+		inline bool isRound() const { return geometry->isRound(); }
+		inline bool isTall() const { return geometry->isTall(); }
+		inline bool isHollow() const { return geometry->isHollow(); }
 		inline bool isWhite() const { return white; }
 
+		inline const PieceGeometry::handle &getGeometry() const { return geometry; }
+
 		typedef handle_traits<PieceModel>::handle_type handle;
 
 		typedef list_traits<PieceModel::handle>::list_type list;
 
 	private:
-		bool round;
-		bool tall;
-		bool hollow;
+		PieceGeometry::handle geometry;
 		bool white;
-
-		void generateRoundModel();
-		void generateSquareModel();
 	};
 
 }
@@ -7,6 +7,8 @@
 #include "PieceModel.hpp"
 #include "MarkerModel.hpp"
 #include "Game.hpp"
+#include "HintAnalysis.hpp"
+#include "TranspositionTable.hpp"
 #include <PerspectiveCamera.hpp>
 #include <FirstPersonCameraRigging.hpp>
 #include <Model.hpp>
@@ -42,6 +44,12 @@ namespace quarto {
 		/** Constructs an instance of the application from the filename of a model to load */
 		QuartoApp();
 
+		/** Stops and joins every hint analysis before the table and the engine go away */
+		~QuartoApp();
+
+		/** Sets whether to print statistics of any meshes generated at startup */
+		void setMeshStats(bool meshStats);
+
 		/** Runs the application */
 		void run();
 
@@ -89,6 +97,15 @@ namespace quarto {
 		/** The marker model */
 		MarkerModel markerModel;
 
+		/** The transposition table shared by hint analyses */
+		TranspositionTable hintTable;
+
+		/** The hint being computed or shown, if any */
+		HintAnalysis::handle hint;
+
+		/** Cancelled hints whose threads have not been joined yet */
+		vector<HintAnalysis::handle> cancelledHints;
+
 		/** The camera to view the scene with */
 		FirstPersonCameraRigging::handle cameraRigging;
 
@@ -98,6 +115,9 @@ namespace quarto {
 		/** Whether the right mouse button is depressed */
 		bool rightMouseButtonDown;
 
+		/** Whether to print statistics of any meshes generated at startup */
+		bool meshStats;
+
 		static const int BUFSIZE = 512;
 		GLuint selectBuf[BUFSIZE];
 
@@ -115,6 +135,12 @@ namespace quarto {
 
 		void restartGame();
 
+		void showHint();
+
+		void cancelHint();
+
+		void drawHint();
+
 	};
 
 	// Custom Quarto events...
@@ -133,5 +159,6 @@ namespace quarto {
 	static const int QE_DECREASE_NORMAL_SCALE = 12;
 	static const int QE_INCREASE_NORMAL_SCALE = 13;
 	static const int QE_RESET_GAME = 14;
+	static const int QE_SHOW_HINT = 15;
 
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+/**
+ * @file TriangleMesh.hpp
+ */
+#pragma once
+
+#include "MeshData.hpp"
+#include <handle_traits.hpp>
+#include <list_traits.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+// Implementation dependencies
+using peek::handle_traits;
+using peek::list_traits;
+
+namespace quarto {
+
+	/**
+	 * @brief A mesh ready to draw: its positions, a smooth normal for each
+	 * vertex, and one list of triangles
+	 *
+	 * Each of the three is a single flat array that GL can draw, or upload,
+	 * in one call, so a mesh costs the same few allocations however many
+	 * primitives it was generated from. The triangles of each material are
+	 * a part of the list, drawn by a call of its own. The positions are those
+	 * of the source mesh, which may borrow them from the mesh cache, and so
+	 * are the normals if the source has them. A mesh never changes after it
+	 * is built, so models on any thread may share it.
+	 */
+	class TriangleMesh : boost::noncopyable {
+	public:
+
+		/**
+		 * @brief The triangles of one material: count of them from first
+		 */
+		struct Part {
+			unsigned int material;
+			std::size_t first;
+			std::size_t count;
+		};
+
+		/** @brief Where a mesh's normals come from */
+		enum NormalSource {
+			/** The source mesh's own normals, or averaged ones if it has none */
+			SOURCE_NORMALS,
+			/** Normals averaged from the faces around each vertex */
+			AVERAGED_NORMALS
+		};
+
+		explicit TriangleMesh(const MeshData &mesh, NormalSource normalSource = SOURCE_NORMALS);
+
+		inline const std::vector<Part> &getParts() const { return parts; }
+		inline unsigned int getLevel() const { return source.getLevel(); }
+
+		inline std::size_t getNumVertices() const { return source.getNumVertices(); }
+		inline std::size_t getNumTriangles() const { return triangles.size() / 3; }
+
+		/** @return The distance from the origin to the farthest vertex */
+		inline double getBoundingRadius() const { return boundingRadius; }
+
+		/** @return Three coordinates for each vertex */
+		inline const float *getPositions() const { return source.getPositions(); }
+		/** @return Three coordinates for each vertex */
+		inline const float *getNormals() const { return (normals.empty() ? source.getNormals() : &normals[0]); }
+		/** @return Three indices for each triangle */
+		inline const boost::uint32_t *getTriangles() const { return (triangles.empty() ? NULL : &triangles[0]); }
+
+		typedef handle_traits<TriangleMesh>::handle_type handle;
+
+		typedef list_traits<TriangleMesh::handle>::list_type list;
+
+	private:
+		MeshData source;
+		/** Averaged normals, empty if the source's own are used */
+		std::vector<float> normals;
+		std::vector<boost::uint32_t> triangles;
+		std::vector<Part> parts;
+		double boundingRadius;
+
+		void generateNormals();
+	};
+
+}
@@ -0,0 +1,49 @@
+/**
+ * @file UnitCircleTable.hpp
+ */
+#pragma once
+
+#include <Vector3d.hpp>
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+// Implementation dependencies
+using peek::Vector3d;
+
+namespace quarto {
+
+	/**
+	 * @brief Points of the unit circle at even steps, computed once per process
+	 *
+	 * Sample i is parametricUnitCircle(phase + i * step). A generator looks a
+	 * table up once for each ring of vertices and indexes it in its loops, so
+	 * each sine and cosine is computed once however many rings, markers and
+	 * pieces share the same segment count. Tables are built on first use,
+	 * from any thread, and never freed.
+	 */
+	class UnitCircleTable : boost::noncopyable {
+	public:
+
+		/**
+		 * @return The table of numSegments samples around one whole turn,
+		 * starting phase turns from the x-axis
+		 */
+		static const UnitCircleTable &get(unsigned int numSegments, double phase = 0.0);
+
+		/**
+		 * @return The table of numSamples samples from phase, step turns apart
+		 */
+		static const UnitCircleTable &get(unsigned int numSamples, double step, double phase);
+
+		/** @param i A sample, taken modulo the number of samples */
+		inline const Vector3d &operator[](unsigned int i) const { return samples[i % samples.size()]; }
+
+		inline unsigned int getNumSamples() const { return (unsigned int)samples.size(); }
+
+	private:
+		std::vector<Vector3d> samples;
+
+		UnitCircleTable(unsigned int numSamples, double step, double phase);
+	};
+
+}
@@ -0,0 +1,64 @@
+/**
+ * @file VertexCache.hpp
+ */
+#pragma once
+
+#include <boost/cstdint.hpp>
+#include <vector>
+
+namespace quarto {
+
+	/*
+	 * A GPU shades each vertex once for as long as it stays in a small cache
+	 * of recently shaded vertices, so the order of a mesh's triangles decides
+	 * how often its vertices are shaded again. The average cache miss ratio
+	 * (ACMR) is the number of vertices shaded per triangle: 3 at worst, and
+	 * about 0.5 at best for a large regular grid.
+	 */
+
+	/** The number of vertices the simulated cache holds, as many GPUs' first-in first-out caches do */
+	const std::size_t simulatedVertexCacheSize = 16;
+
+	/** Marks a vertex that no triangle uses */
+	const boost::uint32_t unusedVertex = 0xFFFFFFFF;
+
+	/**
+	 * @brief Cache misses counted over the triangles of some meshes, before
+	 * and after they were optimized
+	 */
+	struct VertexCacheStats {
+		VertexCacheStats() : numTriangles(0), missesBefore(0), missesAfter(0) {}
+
+		std::size_t numTriangles;
+		std::size_t missesBefore;
+		std::size_t missesAfter;
+
+		void add(const VertexCacheStats &stats);
+
+		double getAcmrBefore() const;
+		double getAcmrAfter() const;
+	};
+
+	/**
+	 * @param triangles Three indices for each triangle
+	 * @return The vertices a simulated cache misses while drawing the triangles
+	 */
+	std::size_t countVertexCacheMisses(const std::vector<boost::uint32_t> &triangles, std::size_t numVertices);
+
+	/**
+	 * Reorders the triangles so that each uses vertices a cache still holds,
+	 * following Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". The
+	 * winding of each triangle is kept.
+	 */
+	void optimizeVertexCache(std::vector<boost::uint32_t> &triangles, std::size_t numVertices);
+
+	/**
+	 * Renumbers the vertices in the order the triangles first use them, so
+	 * vertices are fetched from memory in order, and drops unused vertices.
+	 *
+	 * @param remap Receives the new number of each old vertex, or unusedVertex
+	 * @return The number of vertices left
+	 */
+	std::size_t optimizeVertexFetch(std::vector<boost::uint32_t> &triangles, std::vector<boost::uint32_t> &remap, std::size_t numVertices);
+
+}
@@ -2,12 +2,14 @@
 * @file main.cpp
 */
 #include "QuartoApp.hpp"
+#include <cstring>
 
 using quarto::QuartoApp;
 
-/** Entry point for the program */
+/** Entry point for the program; "quarto mesh-stats" also reports on the meshes it generates */
 int main(int argc, char **argv) {
 	QuartoApp app;
+	app.setMeshStats(argc > 1 && std::strcmp(argv[1], "mesh-stats") == 0);
 
 	app.run();
 
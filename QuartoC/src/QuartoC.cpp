@@ -0,0 +1,287 @@
+/**
+* @file QuartoC.cpp
+*/
+#include "quarto.h"
+#include "Game.hpp"
+#include "Search.hpp"
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+struct quarto_engine {
+	quarto::TranspositionTable table;
+	unsigned int numThreads;
+};
+
+struct quarto_game {
+	quarto::Game game;
+};
+
+namespace {
+
+	using namespace quarto;
+
+	/** @brief One call to quarto_engine_search, shared by the threads that serve it */
+	struct SearchBatch {
+		quarto_engine *engine;
+		const quarto_position *positions;
+		quarto_search_result *results;
+		std::size_t count;
+		std::size_t numThreads;
+		SearchLimits limits;
+		boost::atomic<std::size_t> next;
+	};
+
+	void pack(const Position &position, quarto_position &out) {
+		std::memset(&out, 0, sizeof(out));
+		out.board = position.getBoard();
+		out.occupied = position.getOccupied();
+		out.in_hand = position.getPieceInHand();
+	}
+
+	/** @return The squares where the piece in hand would complete a line */
+	boost::uint16_t getWinningSquares(const Position &position) {
+		boost::uint16_t squares = 0;
+		if(position.getPieceInHand() == Position::NO_PIECE)
+			return squares;
+		for(boost::uint16_t m = (boost::uint16_t)~position.getOccupied(); m != 0; m &= m - 1) {
+			if(position.isWinningPlacement(lowestBit(m)))
+				squares |= (boost::uint16_t)(1 << lowestBit(m));
+		}
+		return squares;
+	}
+
+	void analyze(const quarto_position &in, quarto_analysis &out) {
+		std::memset(&out, 0, sizeof(out));
+
+		Position position;
+		bool won;
+		if(!Position::fromBoard(in.board, in.occupied, in.in_hand, position, won))
+			return;
+
+		out.legal = 1;
+		out.won = (won ? 1 : 0);
+		out.full = (position.isFull() ? 1 : 0);
+		out.winning_squares = getWinningSquares(position);
+		out.safe_pieces = (quarto_u16)(position.getAvailablePieces() & ~position.getUnsafePieces());
+	}
+
+	void searchOne(Search &search, const quarto_position &in, const SearchLimits &limits, quarto_search_result &out) {
+		std::memset(&out, 0, sizeof(out));
+		out.move.square = QUARTO_NONE;
+		out.move.piece = QUARTO_NONE;
+
+		Position position;
+		bool won;
+		if(!Position::fromBoard(in.board, in.occupied, in.in_hand, position, won)) {
+			out.status = QUARTO_ILLEGAL;
+			return;
+		}
+		if(won || position.isFull()) {
+			out.status = QUARTO_GAME_OVER;
+			return;
+		}
+
+		SearchResult result = search.run(position, limits);
+		out.status = QUARTO_OK;
+		out.score = result.score;
+		out.move.square = result.move.square;
+		out.move.piece = result.move.piece;
+		out.depth = result.depth;
+		out.nodes = result.nodes;
+	}
+
+	/**
+	 * Takes the next unsearched position until none are left. A deterministic
+	 * search cannot use the shared table, so the threads split the engine's
+	 * memory between their private tables instead, and each thread keeps its
+	 * tables from one position to the next.
+	 */
+	void runWorker(SearchBatch *batch) {
+		Search search(batch->engine->table);
+		search.setPrivateTableMegabytes(std::max(1u, batch->engine->table.getMegabytes() / (unsigned int)batch->numThreads));
+		for(;;) {
+			std::size_t index = batch->next.fetch_add(1);
+			if(index >= batch->count)
+				break;
+			searchOne(search, batch->positions[index], batch->limits, batch->results[index]);
+		}
+	}
+
+}
+
+/*
+ * Every entry point catches whatever the C++ side throws, since an
+ * exception must not cross into the caller's C frames.
+ */
+
+int quarto_version(void) {
+	return QUARTO_API_VERSION;
+}
+
+void quarto_analyze(const quarto_position *positions, size_t count, quarto_analysis *results) {
+	if(positions == NULL || results == NULL)
+		return;
+	try {
+		for(size_t i = 0; i < count; i++) {
+			analyze(positions[i], results[i]);
+		}
+	} catch(...) {
+		// Nothing is allocated, so nothing is expected to throw
+	}
+}
+
+quarto_engine *quarto_engine_create(unsigned int hash_megabytes, unsigned int threads) {
+	try {
+		quarto_engine *engine = new quarto_engine();
+		engine->table.resize(hash_megabytes);
+		engine->numThreads = (threads > 0 ? threads : boost::thread::hardware_concurrency());
+		if(engine->numThreads == 0)
+			engine->numThreads = 1;
+		return engine;
+	} catch(...) {
+		return NULL;
+	}
+}
+
+void quarto_engine_destroy(quarto_engine *engine) {
+	delete engine;
+}
+
+void quarto_engine_clear(quarto_engine *engine) {
+	if(engine != NULL)
+		engine->table.clear();
+}
+
+/**
+ * Each thread searches whole positions on its own, so a batch of many
+ * positions keeps every thread busy without the cost of splitting a search.
+ * The threads share the engine's table, which is what a position searched
+ * after a similar one gains from.
+ */
+int quarto_engine_search(quarto_engine *engine, const quarto_position *positions, size_t count,
+	const quarto_limits *limits, quarto_search_result *results) {
+	if(engine == NULL || (count > 0 && (positions == NULL || results == NULL)))
+		return QUARTO_INVALID_ARGUMENT;
+
+	SearchBatch batch;
+	batch.engine = engine;
+	batch.positions = positions;
+	batch.results = results;
+	batch.count = count;
+	batch.next.store(0);
+	if(limits != NULL) {
+		batch.limits.depth = limits->depth;
+		batch.limits.nodes = limits->nodes;
+		batch.limits.milliseconds = limits->milliseconds;
+		batch.limits.deterministic = (limits->deterministic != 0);
+	}
+
+	try {
+		batch.numThreads = std::max<std::size_t>(1, std::min<std::size_t>(count, engine->numThreads));
+		boost::thread_group threads;
+		try {
+			for(std::size_t i = 1; i < batch.numThreads; i++) {
+				threads.create_thread(boost::bind(&runWorker, &batch));
+			}
+			runWorker(&batch);
+		} catch(...) {
+			batch.next.store(count);
+			threads.join_all();
+			throw;
+		}
+		threads.join_all();
+	} catch(...) {
+		// Out of memory or threads
+		return QUARTO_OUT_OF_MEMORY;
+	}
+	return QUARTO_OK;
+}
+
+quarto_game *quarto_game_create(void) {
+	try {
+		quarto_game *game = new quarto_game();
+		game->game.start();
+		return game;
+	} catch(...) {
+		return NULL;
+	}
+}
+
+void quarto_game_destroy(quarto_game *game) {
+	delete game;
+}
+
+int quarto_game_state(const quarto_game *game) {
+	return (game != NULL ? (int)game->game.getState() : QUARTO_NOT_STARTED);
+}
+
+/**
+ * The state and the piece are checked here first, since Game changes
+ * itself before it throws.
+ */
+int quarto_game_choose(quarto_game *game, unsigned int piece) {
+	if(game == NULL)
+		return QUARTO_INVALID_ARGUMENT;
+
+	State state = game->game.getState();
+	if(state != P1_CHOOSE && state != P2_CHOOSE)
+		return (state == P1_WIN || state == P2_WIN ? QUARTO_GAME_OVER : QUARTO_ILLEGAL);
+	if(piece >= Position::NUM_PIECES || !((Position(game->game).getAvailablePieces() >> piece) & 1))
+		return QUARTO_ILLEGAL;
+
+	try {
+		game->game.choosePiece(Piece::fromIndex(piece));
+	} catch(...) {
+		return QUARTO_ILLEGAL;
+	}
+	return QUARTO_OK;
+}
+
+int quarto_game_place(quarto_game *game, unsigned int square) {
+	if(game == NULL)
+		return QUARTO_INVALID_ARGUMENT;
+
+	State state = game->game.getState();
+	if(state != P1_PLACE && state != P2_PLACE)
+		return (state == P1_WIN || state == P2_WIN ? QUARTO_GAME_OVER : QUARTO_ILLEGAL);
+	if(square >= Position::NUM_SQUARES || Position(game->game).isOccupied(square))
+		return QUARTO_ILLEGAL;
+
+	try {
+		game->game.placePiece(square / 4, square % 4);
+	} catch(...) {
+		return QUARTO_ILLEGAL;
+	}
+	return QUARTO_OK;
+}
+
+void quarto_game_position(const quarto_game *game, quarto_position *position) {
+	if(game == NULL || position == NULL)
+		return;
+	try {
+		pack(Position(game->game), *position);
+	} catch(...) {
+		std::memset(position, 0, sizeof(*position));
+	}
+}
+
+int quarto_game_load(quarto_game *game, const char *record) {
+	if(game == NULL || record == NULL)
+		return QUARTO_INVALID_ARGUMENT;
+
+	try {
+		GameRecord parsed;
+		if(!parsed.fromText(record, record + std::strlen(record)))
+			return QUARTO_ILLEGAL;
+		game->game.replay(parsed);
+	} catch(const std::bad_alloc &) {
+		return QUARTO_OUT_OF_MEMORY;
+	} catch(...) {
+		return QUARTO_ILLEGAL;
+	}
+	return QUARTO_OK;
+}
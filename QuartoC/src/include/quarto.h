@@ -0,0 +1,181 @@
+/**
+ * @file quarto.h
+ *
+ * A C interface to the game rules and the search, for programs that embed
+ * the engine without linking against its C++ types.
+ *
+ * Positions cross the interface packed into 16 bytes, and the functions
+ * that inspect or search them take whole arrays, so the cost of a call is
+ * paid once per batch rather than once per position. No function throws,
+ * and none keeps a pointer it was given after it returns.
+ *
+ * Squares are numbered row * 4 + column. Pieces are numbered by their
+ * attributes: bit 0 round, bit 1 tall, bit 2 hollow, bit 3 light.
+ */
+#ifndef QUARTO_H
+#define QUARTO_H
+
+#include <stddef.h>
+
+#if defined(_MSC_VER) && _MSC_VER < 1600
+typedef unsigned __int64 quarto_u64;
+typedef unsigned short quarto_u16;
+typedef unsigned char quarto_u8;
+#else
+#include <stdint.h>
+typedef uint64_t quarto_u64;
+typedef uint16_t quarto_u16;
+typedef uint8_t quarto_u8;
+#endif
+
+#if defined(_WIN32)
+#ifdef QUARTO_BUILDING_LIBRARY
+#define QUARTO_API __declspec(dllexport)
+#else
+#define QUARTO_API __declspec(dllimport)
+#endif
+#else
+#define QUARTO_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Raised whenever a struct below or the meaning of a function changes */
+#define QUARTO_API_VERSION 1
+
+/** A missing square or piece */
+#define QUARTO_NONE 0xFF
+
+/** The score of a win on the next placement; wins further away score one less per placement */
+#define QUARTO_WIN_SCORE 1000
+/** Scores beyond this magnitude are proven wins or losses */
+#define QUARTO_DECISIVE_SCORE 983
+
+/* Return codes */
+#define QUARTO_OK 0
+#define QUARTO_ILLEGAL (-1)
+#define QUARTO_INVALID_ARGUMENT (-2)
+#define QUARTO_OUT_OF_MEMORY (-3)
+#define QUARTO_GAME_OVER (-4)
+
+/* Game states */
+#define QUARTO_NOT_STARTED 0
+#define QUARTO_P1_CHOOSE 1
+#define QUARTO_P2_CHOOSE 2
+#define QUARTO_P1_PLACE 3
+#define QUARTO_P2_PLACE 4
+#define QUARTO_P1_WIN 5
+#define QUARTO_P2_WIN 6
+
+/** A position packed into 16 bytes */
+typedef struct quarto_position {
+	/** The piece on each occupied square, four bits a square */
+	quarto_u64 board;
+	/** One bit for each occupied square */
+	quarto_u16 occupied;
+	/** The piece to be placed next, or QUARTO_NONE if a piece is to be given */
+	quarto_u8 in_hand;
+	quarto_u8 reserved[5];
+} quarto_position;
+
+/** A placement of the piece in hand followed by a piece given to the opponent; either half may be QUARTO_NONE */
+typedef struct quarto_move {
+	quarto_u8 square;
+	quarto_u8 piece;
+} quarto_move;
+
+/** What the rules say about a position */
+typedef struct quarto_analysis {
+	/** No piece is used twice */
+	quarto_u8 legal;
+	/** The board has a complete line */
+	quarto_u8 won;
+	/** Every square is occupied */
+	quarto_u8 full;
+	quarto_u8 reserved;
+	/** The squares where the piece in hand would complete a line */
+	quarto_u16 winning_squares;
+	/** The unused pieces that could not complete a line on the board as it stands */
+	quarto_u16 safe_pieces;
+} quarto_analysis;
+
+/** Limits on each search; zero means unlimited */
+typedef struct quarto_limits {
+	/** The number of placements to look ahead */
+	unsigned int depth;
+	quarto_u64 nodes;
+	unsigned int milliseconds;
+	/** Nonzero to make results depend only on the position and the limits */
+	unsigned int deterministic;
+} quarto_limits;
+
+/** The outcome of searching one position, from the point of view of the player to move */
+typedef struct quarto_search_result {
+	/** QUARTO_OK, or QUARTO_ILLEGAL or QUARTO_GAME_OVER if the position was not searched */
+	int status;
+	int score;
+	quarto_move move;
+	unsigned int depth;
+	quarto_u64 nodes;
+} quarto_search_result;
+
+typedef struct quarto_engine quarto_engine;
+typedef struct quarto_game quarto_game;
+
+/** @return QUARTO_API_VERSION of the library in use, which may differ from the header compiled against */
+QUARTO_API int quarto_version(void);
+
+/** Fills one analysis for each position */
+QUARTO_API void quarto_analyze(const quarto_position *positions, size_t count, quarto_analysis *results);
+
+/**
+ * @param hash_megabytes The size of the table the searches share
+ * @param threads The number of positions searched at once; 0 for one per core
+ * @return A new engine, or NULL if it could not be allocated
+ */
+QUARTO_API quarto_engine *quarto_engine_create(unsigned int hash_megabytes, unsigned int threads);
+QUARTO_API void quarto_engine_destroy(quarto_engine *engine);
+
+/** Forgets everything earlier searches learned */
+QUARTO_API void quarto_engine_clear(quarto_engine *engine);
+
+/**
+ * Searches each position for its best move, several at once, and returns
+ * once every position has been searched.
+ *
+ * @param limits The limits of each search, or NULL for none
+ * @return QUARTO_OK, or QUARTO_INVALID_ARGUMENT if a pointer is NULL
+ */
+QUARTO_API int quarto_engine_search(quarto_engine *engine, const quarto_position *positions, size_t count,
+	const quarto_limits *limits, quarto_search_result *results);
+
+/** @return A new game waiting for player 1 to choose a piece, or NULL */
+QUARTO_API quarto_game *quarto_game_create(void);
+QUARTO_API void quarto_game_destroy(quarto_game *game);
+
+/** @return One of the QUARTO_P1_CHOOSE to QUARTO_P2_WIN states */
+QUARTO_API int quarto_game_state(const quarto_game *game);
+
+/** @return QUARTO_OK, or QUARTO_ILLEGAL if it is not time to choose or the piece is used */
+QUARTO_API int quarto_game_choose(quarto_game *game, unsigned int piece);
+
+/** @return QUARTO_OK, or QUARTO_ILLEGAL if it is not time to place or the square is taken */
+QUARTO_API int quarto_game_place(quarto_game *game, unsigned int square);
+
+QUARTO_API void quarto_game_position(const quarto_game *game, quarto_position *position);
+
+/**
+ * Replaces the game with one replayed from a record in the text form,
+ * such as "-0 a1f b2-".
+ *
+ * @return QUARTO_OK, or QUARTO_ILLEGAL if the record is malformed or illegal
+ */
+QUARTO_API int quarto_game_load(quarto_game *game, const char *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
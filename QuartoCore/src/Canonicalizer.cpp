@@ -0,0 +1,194 @@
+/**
+* @file Canonicalizer.cpp
+*/
+#include "Canonicalizer.hpp"
+
+namespace {
+
+	using namespace quarto;
+
+	byte boardMaps[Canonicalizer::NUM_BOARD_SYMMETRIES][Position::NUM_SQUARES];
+	byte boardInverses[Canonicalizer::NUM_BOARD_SYMMETRIES][Position::NUM_SQUARES];
+	byte permutationMaps[Canonicalizer::NUM_PERMUTATIONS][Position::NUM_PIECES];
+	byte permutationInverses[Canonicalizer::NUM_PERMUTATIONS][Position::NUM_PIECES];
+
+	/**
+	 * Fills the symmetry tables before main() runs.
+	 *
+	 * A board symmetry moves row i to row s(i) and column i to column t(i),
+	 * possibly followed by a transpose. Diagonals stay diagonals when s
+	 * commutes with the reversal r(i) = 3 - i and t is s or r(s): 8 choices of
+	 * s, 2 of t and 2 of transposing.
+	 */
+	struct SymmetryInitializer {
+		SymmetryInitializer() {
+			unsigned int orders[24][4];
+			unsigned int numOrders = 0;
+			for(unsigned int a = 0; a < 4; a++) {
+				for(unsigned int b = 0; b < 4; b++) {
+					for(unsigned int c = 0; c < 4; c++) {
+						unsigned int d = 6 - a - b - c;
+						if(a == b || a == c || b == c || d > 3 || d == a || d == b || d == c)
+							continue;
+						orders[numOrders][0] = a;
+						orders[numOrders][1] = b;
+						orders[numOrders][2] = c;
+						orders[numOrders][3] = d;
+						numOrders++;
+					}
+				}
+			}
+
+			unsigned int numBoard = 0;
+			for(unsigned int i = 0; i < numOrders; i++) {
+				const unsigned int *s = orders[i];
+				if(s[3] != 3 - s[0] || s[2] != 3 - s[1])
+					continue;
+
+				for(unsigned int reversed = 0; reversed < 2; reversed++) {
+					for(unsigned int transposed = 0; transposed < 2; transposed++) {
+						for(unsigned int square = 0; square < Position::NUM_SQUARES; square++) {
+							unsigned int row = s[square / 4];
+							unsigned int col = (reversed ? 3 - s[square % 4] : s[square % 4]);
+							byte image = (byte)(transposed ? col * 4 + row : row * 4 + col);
+							boardMaps[numBoard][square] = image;
+							boardInverses[numBoard][image] = (byte)square;
+						}
+						numBoard++;
+					}
+				}
+			}
+
+			for(unsigned int i = 0; i < numOrders; i++) {
+				for(unsigned int piece = 0; piece < Position::NUM_PIECES; piece++) {
+					byte image = 0;
+					for(unsigned int bit = 0; bit < 4; bit++) {
+						if((piece >> bit) & 1)
+							image |= (byte)(1 << orders[i][bit]);
+					}
+					permutationMaps[i][piece] = image;
+					permutationInverses[i][image] = (byte)piece;
+				}
+			}
+		}
+	} symmetryInitializer;
+
+	inline bool isLess(const Move &a, const Move &b) {
+		return a.square < b.square || (a.square == b.square && a.piece < b.piece);
+	}
+
+}
+
+namespace quarto {
+
+	Canonicalizer::Canonicalizer() {
+		this->transforms.reserve(NUM_BOARD_SYMMETRIES * NUM_PERMUTATIONS);
+	}
+
+	/**
+	 * Board symmetries that do not give the least set of occupied squares are
+	 * rejected before any piece is looked at. For the rest, the flips are
+	 * fixed by mapping the first piece to 0, leaving 24 candidates each.
+	 */
+	Position Canonicalizer::canonicalize(const Position &position) {
+		this->transforms.clear();
+
+		byte inHand = position.getPieceInHand();
+		boost::uint32_t bestOccupied = 0x10000;
+		byte best[Position::NUM_SQUARES + 1];
+		byte pieces[Position::NUM_SQUARES + 1];
+		unsigned int length = 0;
+
+		for(unsigned int b = 0; b < NUM_BOARD_SYMMETRIES; b++) {
+			boost::uint16_t occupied = 0;
+			for(boost::uint16_t m = position.getOccupied(); m != 0; m &= m - 1) {
+				occupied |= (boost::uint16_t)(1 << boardMaps[b][lowestBit(m)]);
+			}
+			if(occupied > bestOccupied)
+				continue;
+			if(occupied < bestOccupied) {
+				bestOccupied = occupied;
+				this->transforms.clear();
+			}
+
+			length = 0;
+			for(boost::uint16_t m = occupied; m != 0; m &= m - 1) {
+				pieces[length++] = (byte)position.getPieceAt(boardInverses[b][lowestBit(m)]);
+			}
+			if(inHand != Position::NO_PIECE)
+				pieces[length++] = inHand;
+
+			// With no pieces to fix them, the flips can take any piece to 0
+			if(length == 0) {
+				Transform transform = { (byte)b, 0, 0, true };
+				this->transforms.push_back(transform);
+				continue;
+			}
+
+			for(unsigned int p = 0; p < NUM_PERMUTATIONS; p++) {
+				byte flips = permutationMaps[p][pieces[0]];
+				byte image[Position::NUM_SQUARES + 1];
+				int order = 0;
+				for(unsigned int k = 0; k < length; k++) {
+					image[k] = permutationMaps[p][pieces[k]] ^ flips;
+					if(order == 0 && !this->transforms.empty() && image[k] != best[k])
+						order = (image[k] < best[k] ? -1 : 1);
+					if(order > 0)
+						break;
+				}
+				if(order > 0)
+					continue;
+
+				if(order < 0 || this->transforms.empty()) {
+					for(unsigned int k = 0; k < length; k++) {
+						best[k] = image[k];
+					}
+					this->transforms.clear();
+				}
+				Transform transform = { (byte)b, (byte)p, flips, false };
+				this->transforms.push_back(transform);
+			}
+		}
+
+		Position canonical;
+		unsigned int k = 0;
+		for(boost::uint16_t m = (boost::uint16_t)bestOccupied; m != 0; m &= m - 1) {
+			canonical.give(best[k++]);
+			canonical.place(lowestBit(m));
+		}
+		if(inHand != Position::NO_PIECE)
+			canonical.give(best[k]);
+
+		return canonical;
+	}
+
+	Move Canonicalizer::canonicalizeMove(const Move &move) const {
+		Move least = apply(this->transforms[0], move);
+		for(std::vector<Transform>::const_iterator i = this->transforms.begin() + 1; i != this->transforms.end(); ++i) {
+			Move image = apply(*i, move);
+			if(isLess(image, least))
+				least = image;
+		}
+		return least;
+	}
+
+	Move Canonicalizer::restoreMove(const Move &move) const {
+		const Transform &transform = this->transforms[0];
+		Move restored;
+		if(move.square != Move::NONE)
+			restored.square = boardInverses[transform.board][move.square];
+		if(move.piece != Move::NONE)
+			restored.piece = permutationInverses[transform.permutation][move.piece ^ transform.flips];
+		return restored;
+	}
+
+	Move Canonicalizer::apply(const Transform &transform, const Move &move) {
+		Move image;
+		if(move.square != Move::NONE)
+			image.square = boardMaps[transform.board][move.square];
+		if(move.piece != Move::NONE)
+			image.piece = (transform.anyFlips ? 0 : permutationMaps[transform.permutation][move.piece] ^ transform.flips);
+		return image;
+	}
+
+}
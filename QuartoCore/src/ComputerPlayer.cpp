@@ -0,0 +1,133 @@
+/**
+* @file ComputerPlayer.cpp
+*/
+#include "ComputerPlayer.hpp"
+#include <boost/random/uniform_int_distribution.hpp>
+
+using boost::random::uniform_int_distribution;
+
+namespace {
+
+	using namespace quarto;
+
+	/** Indexed by Difficulty; each level costs one to two orders of magnitude more than the one below it */
+	const DifficultySettings difficultySettings[] = {
+		{ 1,    1000, 25 },
+		{ 3,   20000, 10 },
+		{ 6,  500000,  2 },
+		{ 0, 5000000,  0 }
+	};
+
+}
+
+namespace quarto {
+
+	/**
+	 * @param table The table to search with; games at the same level can share one
+	 * @param seed Seeds the choice of blunders, so games can be replayed
+	 */
+	ComputerPlayer::ComputerPlayer(TranspositionTable &table, boost::uint32_t seed) : search(table), random(seed) {
+	}
+
+	DifficultySettings ComputerPlayer::getSettings(Difficulty difficulty) {
+		return difficultySettings[difficulty];
+	}
+
+	/**
+	 * @param game A game waiting for the player to move to choose or place a piece
+	 * @return The move and the compute spent on it
+	 */
+	ComputerMove ComputerPlayer::chooseMove(const Game &game) {
+		return chooseMove(Position(game), game.getDifficulty());
+	}
+
+	/**
+	 * @param position A position with a piece to choose or place
+	 * @param difficulty The level that sets the compute budget and error rate
+	 * @return The move and the compute spent on it
+	 */
+	ComputerMove ComputerPlayer::chooseMove(const Position &position, Difficulty difficulty) {
+		return chooseMove(position, getSettings(difficulty));
+	}
+
+	/**
+	 * @param position A position with a piece to choose or place
+	 * @param settings The compute budget and error rate
+	 * @return The move and the compute spent on it
+	 */
+	ComputerMove ComputerPlayer::chooseMove(const Position &position, const DifficultySettings &settings) {
+		ComputerMove computerMove;
+		uniform_int_distribution<unsigned int> percent(0, 99);
+		computerMove.blunder = (percent(this->random) < settings.blunderPercent);
+
+		if(computerMove.blunder) {
+			computerMove.move = chooseRandomMove(position);
+		} else {
+			SearchLimits limits;
+			limits.depth = settings.depth;
+			limits.nodes = settings.nodes;
+			computerMove.search = this->search.run(position, limits);
+			computerMove.move = computerMove.search.move;
+		}
+
+		return computerMove;
+	}
+
+	/**
+	 * @param game A game waiting for the player to move to choose or place a piece
+	 * @return The move played and the compute spent on it
+	 */
+	ComputerMove ComputerPlayer::play(Game &game) {
+		return play(game, getSettings(game.getDifficulty()));
+	}
+
+	/**
+	 * @param game A game waiting for the player to move to choose or place a piece
+	 * @param settings The compute budget and error rate
+	 * @return The move played and the compute spent on it
+	 */
+	ComputerMove ComputerPlayer::play(Game &game, const DifficultySettings &settings) {
+		ComputerMove computerMove = chooseMove(Position(game), settings);
+		Move move = computerMove.move;
+
+		if(move.square != Move::NONE)
+			game.placePiece(move.square / 4, move.square % 4);
+
+		State state = game.getState();
+		if(move.piece != Move::NONE && state != P1_WIN && state != P2_WIN)
+			game.choosePiece(Piece::fromIndex(move.piece));
+
+		return computerMove;
+	}
+
+	/**
+	 * @return A uniformly random legal move
+	 */
+	Move ComputerPlayer::chooseRandomMove(const Position &position) {
+		Move move;
+		Position after = position;
+
+		if(position.getPieceInHand() != Position::NO_PIECE) {
+			move.square = (byte)chooseRandomBit((boost::uint16_t)~position.getOccupied());
+			if(after.place(move.square))
+				return move;
+		}
+
+		if(after.getAvailablePieces() != 0)
+			move.piece = (byte)chooseRandomBit(after.getAvailablePieces());
+
+		return move;
+	}
+
+	/**
+	 * @param mask A non-empty mask
+	 * @return The index of one of its set bits, chosen uniformly
+	 */
+	unsigned int ComputerPlayer::chooseRandomBit(boost::uint16_t mask) {
+		uniform_int_distribution<unsigned int> choice(0, countBits(mask) - 1);
+		for(unsigned int n = choice(this->random); n > 0; n--)
+			mask &= mask - 1;
+		return lowestBit(mask);
+	}
+
+}
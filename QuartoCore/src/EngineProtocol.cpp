@@ -0,0 +1,294 @@
+/**
+* @file EngineProtocol.cpp
+*/
+#include "EngineProtocol.hpp"
+#include "Notation.hpp"
+#include <boost/bind.hpp>
+
+namespace {
+
+	using namespace quarto;
+
+	const unsigned int MAX_HASH_MEGABYTES = 4096;
+	const unsigned int MAX_THREADS = 64;
+
+	/** Describes a score as "win n" or "loss n" placements away, "draw" once proven, or "unknown" */
+	std::string formatScore(const SearchResult &result, unsigned int emptySquares) {
+		std::ostringstream text;
+		if(result.score > DECISIVE_SCORE)
+			text << "win " << (WIN_SCORE - result.score + 1);
+		else if(result.score < -DECISIVE_SCORE)
+			text << "loss " << (WIN_SCORE + result.score + 1);
+		else if(result.depth >= emptySquares)
+			text << "draw";
+		else
+			text << "unknown";
+		return text.str();
+	}
+
+}
+
+namespace quarto {
+
+	/**
+	 * @param out The stream to write responses to; each response is flushed as soon as it is complete
+	 */
+	EngineProtocol::EngineProtocol(std::ostream &out) : out(out), search(table), gameOver(false), threads(1) {
+	}
+
+	EngineProtocol::~EngineProtocol() {
+		stopSearch();
+	}
+
+	void EngineProtocol::run(std::istream &in) {
+		std::string line;
+		while(std::getline(in, line)) {
+			if(!execute(line))
+				break;
+		}
+		waitForSearch();
+	}
+
+	bool EngineProtocol::execute(const std::string &line) {
+		std::istringstream args(line);
+		std::string command;
+		if(!(args >> command))
+			return true;
+
+		if(command == "isready") {
+			send("readyok\n");
+			return true;
+		}
+		if(command == "stop") {
+			stopSearch();
+			return true;
+		}
+		if(command == "quit") {
+			stopSearch();
+			return false;
+		}
+
+		waitForSearch();
+
+		if(command == "quarto")
+			identify();
+		else if(command == "newgame") {
+			this->table.clear();
+			this->position = Position();
+			this->gameOver = false;
+		}
+		else if(command == "position")
+			setPosition(args);
+		else if(command == "give")
+			give(args);
+		else if(command == "place")
+			place(args);
+		else if(command == "go")
+			go(args);
+		else if(command == "setoption")
+			setOption(args);
+		else if(command == "display")
+			display();
+		else
+			sendError("unknown command " + command);
+
+		return true;
+	}
+
+	void EngineProtocol::identify() {
+		std::ostringstream response;
+		response << "id name quarto-engine\n";
+		response << "option name hash type spin default " << this->table.getMegabytes() << " min 1 max " << MAX_HASH_MEGABYTES << "\n";
+		response << "option name threads type spin default " << this->threads << " min 1 max " << MAX_THREADS << "\n";
+		response << "quartook\n";
+		send(response.str());
+	}
+
+	void EngineProtocol::setPosition(std::istringstream &args) {
+		std::string type;
+		args >> type;
+
+		if(type == "startpos") {
+			this->position = Position();
+		} else if(type == "board") {
+			std::string board, inHand;
+			Position parsed;
+			if(!(args >> board >> inHand) || !parseBoard(board, inHand, parsed)) {
+				sendError("invalid board");
+				return;
+			}
+			this->position = parsed;
+		} else {
+			sendError("expected startpos or board");
+			return;
+		}
+		this->gameOver = this->position.isFull();
+
+		std::string token;
+		if(args >> token) {
+			if(token != "moves")
+				sendError("expected moves");
+			else
+				playMoves(args);
+		}
+	}
+
+	void EngineProtocol::playMoves(std::istringstream &args) {
+		std::string token;
+		while(args >> token) {
+			Move move;
+			if(!parseMove(token, move)) {
+				sendError("invalid move " + token);
+				return;
+			}
+			if(!play(move)) {
+				sendError("illegal move " + token);
+				return;
+			}
+		}
+	}
+
+	void EngineProtocol::give(std::istringstream &args) {
+		std::string token;
+		unsigned int piece;
+		if(!(args >> token) || !parsePiece(token, piece)) {
+			sendError("expected a piece");
+			return;
+		}
+		if(!play(Move(Move::NONE, (byte)piece)))
+			sendError("illegal give " + token);
+	}
+
+	void EngineProtocol::place(std::istringstream &args) {
+		std::string token;
+		unsigned int square;
+		if(!(args >> token) || !parseSquare(token, square)) {
+			sendError("expected a square");
+			return;
+		}
+		if(!play(Move((byte)square, Move::NONE)))
+			sendError("illegal place " + token);
+	}
+
+	void EngineProtocol::go(std::istringstream &args) {
+		SearchLimits limits;
+		limits.threads = this->threads;
+
+		std::string name;
+		while(args >> name) {
+			if(name == "depth")
+				args >> limits.depth;
+			else if(name == "nodes")
+				args >> limits.nodes;
+			else if(name == "movetime")
+				args >> limits.milliseconds;
+			else if(name == "threads")
+				args >> limits.threads;
+			else if(name == "deterministic")
+				limits.deterministic = true;
+			else {
+				sendError("unknown limit " + name);
+				return;
+			}
+			if(args.fail()) {
+				sendError("expected a number after " + name);
+				return;
+			}
+		}
+
+		if(this->gameOver) {
+			send("bestmove none\n");
+			return;
+		}
+
+		this->searchThread.reset(new boost::thread(boost::bind(&EngineProtocol::runSearch, this, this->position, limits)));
+	}
+
+	void EngineProtocol::setOption(std::istringstream &args) {
+		std::string nameToken, name, valueToken;
+		unsigned int value;
+		if(!(args >> nameToken >> name >> valueToken >> value) || nameToken != "name" || valueToken != "value") {
+			sendError("expected setoption name <name> value <n>");
+			return;
+		}
+
+		if(name == "hash" && value >= 1 && value <= MAX_HASH_MEGABYTES)
+			this->table.resize(value);
+		else if(name == "threads" && value >= 1 && value <= MAX_THREADS)
+			this->threads = value;
+		else
+			sendError("invalid option " + name);
+	}
+
+	void EngineProtocol::display() {
+		std::ostringstream response;
+		for(unsigned int row = 4; row-- > 0; ) {
+			response << "info string " << (row + 1) << ' ';
+			for(unsigned int col = 0; col < 4; col++) {
+				unsigned int square = row * 4 + col;
+				response << (this->position.isOccupied(square) ? formatPiece(this->position.getPieceAt(square)) : ".");
+			}
+			response << "\n";
+		}
+		response << "info string   abcd\n";
+		response << "info string board " << formatBoard(this->position) << "\n";
+		send(response.str());
+	}
+
+	/**
+	 * Runs on the search thread with its own copy of the position and limits.
+	 */
+	void EngineProtocol::runSearch(Position root, SearchLimits limits) {
+		SearchResult result = this->search.run(root, limits);
+
+		std::ostringstream response;
+		response << "info depth " << result.depth
+			<< " score " << formatScore(result, Position::NUM_SQUARES - root.getNumPlaced())
+			<< " nodes " << result.nodes
+			<< " time " << (boost::uint64_t)(result.seconds * 1000.0)
+			<< " nps " << (boost::uint64_t)(result.seconds > 0.0 ? result.nodes / result.seconds : 0.0) << "\n";
+		response << "bestmove " << (result.move.isNull() ? "none" : formatMove(result.move)) << "\n";
+		send(response.str());
+	}
+
+	/**
+	 * A stop that arrives before the search thread has started its search is
+	 * forgotten when the search starts, so keep stopping until the thread ends.
+	 */
+	void EngineProtocol::stopSearch() {
+		if(this->searchThread) {
+			do {
+				this->search.stop();
+			} while(!this->searchThread->timed_join(boost::posix_time::milliseconds(1)));
+			this->searchThread.reset();
+		}
+	}
+
+	void EngineProtocol::waitForSearch() {
+		if(this->searchThread) {
+			this->searchThread->join();
+			this->searchThread.reset();
+		}
+	}
+
+	/**
+	 * @return false, leaving the position unchanged, if the move is illegal or the game is over
+	 */
+	bool EngineProtocol::play(const Move &move) {
+		bool won;
+		if(this->gameOver || !playMove(this->position, move, won))
+			return false;
+		this->gameOver = won || this->position.isFull();
+		return true;
+	}
+
+	void EngineProtocol::send(const std::string &lines) {
+		boost::mutex::scoped_lock lock(this->outMutex);
+		this->out << lines << std::flush;
+	}
+
+	void EngineProtocol::sendError(const std::string &message) {
+		send("info string error " + message + "\n");
+	}
+
+}
@@ -9,7 +9,7 @@ using std::endl;
 
 namespace quarto {
 
-	Game::Game() : chosenPiece(Piece(ROUND|TALL|HOLLOW|LIGHT)) {
+	Game::Game() : difficulty(MEDIUM), chosenPiece(Piece(ROUND|TALL|HOLLOW|LIGHT)) {
 		reset();
 	}
 
@@ -25,6 +25,26 @@ namespace quarto {
 		return this->chosenPiece;
 	}
 
+	const Board &Game::getBoard() const {
+		return this->board;
+	}
+
+	Difficulty Game::getDifficulty() const {
+		return this->difficulty;
+	}
+
+	const GameRecord &Game::getRecord() const {
+		return this->record;
+	}
+
+	/**
+	 * @param difficulty The strength of the computer opponent for this game
+	 */
+	void Game::start(Difficulty difficulty) {
+		start();
+		this->difficulty = difficulty;
+	}
+
 	void Game::start() {
 		switch(this->state) {
 			case NOT_STARTED:
@@ -64,6 +84,8 @@ namespace quarto {
 				// Illegal state.
 				throw 43;
 		}
+
+		this->record.appendGive(piece.getIndex());
 	}
 
 	void Game::placePiece(unsigned int i, unsigned int j) {
@@ -80,6 +102,8 @@ namespace quarto {
 				// Illegal state.
 				throw 43;
 		}
+
+		this->record.appendPlace(i * 4 + j);
 	}
 
 	void Game::printStateMessage() {
@@ -110,9 +134,52 @@ namespace quarto {
 		}
 	}
 
+	/**
+	 * Checks and plays the moves on a Position, then copies the final state
+	 * into the game, so no Piece is validated on the way. Placing the pieces
+	 * on the board still checks each one for a line, as every placement does.
+	 * The difficulty is kept.
+	 */
+	void Game::replay(const GameRecord &record) {
+		Position position;
+		bool won;
+		if(!record.replay(position, won)) {
+			// Illegal record.
+			throw 45;
+		}
+
+		reset();
+		this->record = record;
+
+		for(unsigned int square = 0; square < Position::NUM_SQUARES; square++) {
+			if(position.isOccupied(square))
+				this->board.placePiece(Piece::fromIndex(position.getPieceAt(square)), square / 4, square % 4);
+		}
+
+		// Keep the pieces in their usual order
+		vector<Piece>::iterator kept = this->availablePieces.begin();
+		for(vector<Piece>::const_iterator i = this->availablePieces.begin(); i != this->availablePieces.end(); ++i) {
+			if((position.getAvailablePieces() >> i->getIndex()) & 1)
+				*kept++ = *i;
+		}
+		this->availablePieces.erase(kept, this->availablePieces.end());
+
+		if(position.getPieceInHand() != Position::NO_PIECE)
+			this->chosenPiece = Piece::fromIndex(position.getPieceInHand());
+
+		// Player 1 gives first, so the state repeats every four half-moves
+		static const State states[4] = { P1_CHOOSE, P2_PLACE, P2_CHOOSE, P1_PLACE };
+		unsigned int length = record.getLength();
+		if(won)
+			this->state = (length % 4 == 0 ? P1_WIN : P2_WIN);
+		else
+			this->state = states[length % 4];
+	}
+
 	void Game::reset() {
 		this->state = NOT_STARTED;
 		this->board.clear();
+		this->record.clear();
 
 		this->availablePieces.clear();
 		this->availablePieces.push_back(Piece(ROUND|TALL|HOLLOW|LIGHT));
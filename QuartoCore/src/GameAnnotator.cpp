@@ -0,0 +1,185 @@
+/**
+* @file GameAnnotator.cpp
+*/
+#include "GameAnnotator.hpp"
+#include "Notation.hpp"
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace {
+
+	using namespace quarto;
+
+	/** Converts the score of the position after a move to the point of view of the player who made it */
+	inline int scoreFromChild(int childScore, bool placed) {
+		int score = -childScore;
+		if(placed && score > DECISIVE_SCORE) return score - 1;
+		if(placed && score < -DECISIVE_SCORE) return score + 1;
+		return score;
+	}
+
+	MoveQuality judge(int bestScore, int playedScore) {
+		if(playedScore >= bestScore)
+			return MOVE_BEST;
+		if((bestScore > DECISIVE_SCORE && playedScore <= DECISIVE_SCORE) ||
+				(bestScore >= -DECISIVE_SCORE && playedScore < -DECISIVE_SCORE))
+			return MOVE_BLUNDER;
+		return MOVE_INACCURACY;
+	}
+
+}
+
+namespace quarto {
+
+	GameAnnotator::GameAnnotator(unsigned int numThreads, unsigned int hashMegabytes, const SearchLimits &limits)
+		: numThreads(numThreads > 0 ? numThreads : 1), limits(limits), table(hashMegabytes),
+		nextJob(0), numPositions(0), numSearched(0), nodes(0) {
+		this->limits.threads = 1;
+	}
+
+	/**
+	 * Works in three passes: queue the unknown positions of every game,
+	 * search them all in parallel, then judge each move from the scores.
+	 */
+	void GameAnnotator::annotate(const std::vector<GameRecord> &games, std::vector<GameAnnotation> &annotations) {
+		Move moves[GameRecord::MAX_MOVES];
+		std::vector<bool> legal(games.size());
+
+		this->jobs.clear();
+		for(std::size_t g = 0; g < games.size(); g++) {
+			Position position;
+			bool won;
+			legal[g] = games[g].replay(position, won);
+			if(!legal[g])
+				continue;
+
+			unsigned int numMoves = games[g].toMoves(moves);
+			position = Position();
+			for(unsigned int i = 0; i < numMoves; i++) {
+				queue(position);
+				if(moves[i].square != Move::NONE && position.place(moves[i].square))
+					break;
+				if(moves[i].piece != Move::NONE)
+					position.give(moves[i].piece);
+			}
+			if(!won && !position.isFull())
+				queue(position);
+		}
+
+		runJobs();
+		for(std::vector<Job>::const_iterator job = this->jobs.begin(); job != this->jobs.end(); ++job) {
+			this->scores[job->key] = job->score;
+			this->nodes += job->nodes;
+		}
+		this->numSearched += this->jobs.size();
+		BOOST_ASSERT(this->numSearched <= this->numPositions);
+
+		annotations.resize(games.size());
+		for(std::size_t g = 0; g < games.size(); g++) {
+			GameAnnotation &annotation = annotations[g];
+			annotation.clear();
+			if(!legal[g])
+				continue;
+
+			unsigned int numMoves = games[g].toMoves(moves);
+			Position position;
+			int bestScore = getScore(position);
+			for(unsigned int i = 0; i < numMoves; i++) {
+				const Move &move = moves[i];
+				bool placed = (move.square != Move::NONE);
+				bool won = (placed && position.place(move.square));
+				if(move.piece != Move::NONE)
+					position.give(move.piece);
+
+				int playedScore;
+				int nextScore = 0;
+				if(won) {
+					playedScore = WIN_SCORE;
+				} else if(position.isFull()) {
+					playedScore = 0;
+				} else {
+					nextScore = getScore(position);
+					playedScore = scoreFromChild(nextScore, placed);
+				}
+
+				AnnotatedMove annotated;
+				annotated.move = move;
+				annotated.bestScore = bestScore;
+				annotated.playedScore = playedScore;
+				annotated.quality = judge(bestScore, playedScore);
+				annotation.push_back(annotated);
+
+				bestScore = nextScore;
+			}
+		}
+	}
+
+	std::string GameAnnotator::toText(const GameRecord &record, const GameAnnotation &annotation) {
+		if(annotation.empty())
+			return record.toText();
+
+		std::string text;
+		for(GameAnnotation::const_iterator i = annotation.begin(); i != annotation.end(); ++i) {
+			if(i != annotation.begin())
+				text += ' ';
+			text += formatMove(i->move);
+			if(i->quality == MOVE_INACCURACY)
+				text += '?';
+			else if(i->quality == MOVE_BLUNDER)
+				text += "??";
+		}
+		return text;
+	}
+
+	/**
+	 * Counts every position queued, so positions and searches are counted over the same set.
+	 */
+	void GameAnnotator::queue(const Position &position) {
+		this->numPositions++;
+		boost::uint64_t key = this->canonicalizer.canonicalize(position).getKey();
+		if(!this->scores.insert(std::make_pair(key, 0)).second)
+			return;
+
+		Job job;
+		job.position = position;
+		job.key = key;
+		job.score = 0;
+		job.nodes = 0;
+		this->jobs.push_back(job);
+	}
+
+	int GameAnnotator::getScore(const Position &position) {
+		return this->scores[this->canonicalizer.canonicalize(position).getKey()];
+	}
+
+	/**
+	 * Every thread takes the next unsearched job until none are left, so a
+	 * few slow positions do not hold the others back.
+	 */
+	void GameAnnotator::runJobs() {
+		this->nextJob.store(0);
+
+		boost::thread_group threads;
+		for(unsigned int i = 1; i < this->numThreads; i++) {
+			threads.create_thread(boost::bind(&GameAnnotator::runWorker, this));
+		}
+		runWorker();
+		threads.join_all();
+	}
+
+	void GameAnnotator::runWorker() {
+		Search search(this->table);
+		for(;;) {
+			std::size_t index = this->nextJob.fetch_add(1);
+			if(index >= this->jobs.size())
+				break;
+
+			Job &job = this->jobs[index];
+			SearchResult result = search.run(job.position, this->limits);
+			job.score = result.score;
+			job.nodes = result.nodes;
+		}
+	}
+
+}
@@ -0,0 +1,291 @@
+/**
+* @file GameRecord.cpp
+*/
+#include "GameRecord.hpp"
+#include <cstring>
+
+namespace {
+
+	using namespace quarto;
+
+	const std::size_t BUFFER_SIZE = 1 << 16;
+
+	const char hexDigits[] = "0123456789abcdef";
+
+	inline bool parsePieceChar(char c, unsigned int &piece) {
+		if(c >= '0' && c <= '9')
+			piece = (unsigned int)(c - '0');
+		else if(c >= 'a' && c <= 'f')
+			piece = (unsigned int)(c - 'a' + 10);
+		else
+			return false;
+		return true;
+	}
+
+	inline bool parseSquareChars(char col, char row, unsigned int &square) {
+		if(col < 'a' || col > 'd' || row < '1' || row > '4')
+			return false;
+		square = (unsigned int)(row - '1') * 4 + (unsigned int)(col - 'a');
+		return true;
+	}
+
+	inline bool isSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+}
+
+namespace quarto {
+
+	GameRecord::GameRecord() : length(0) {
+	}
+
+	void GameRecord::clear() {
+		this->length = 0;
+	}
+
+	bool GameRecord::appendGive(unsigned int piece) {
+		if(this->length == MAX_HALF_MOVES || isPlacement(this->length) || piece >= Position::NUM_PIECES)
+			return false;
+		this->halfMoves[this->length++] = (byte)piece;
+		return true;
+	}
+
+	bool GameRecord::appendPlace(unsigned int square) {
+		if(this->length == MAX_HALF_MOVES || !isPlacement(this->length) || square >= Position::NUM_SQUARES)
+			return false;
+		this->halfMoves[this->length++] = (byte)square;
+		return true;
+	}
+
+	bool GameRecord::append(const Move &move) {
+		if(move.square != Move::NONE && !appendPlace(move.square))
+			return false;
+		if(move.piece != Move::NONE && !appendGive(move.piece))
+			return false;
+		return true;
+	}
+
+	/**
+	 * @param position Receives the position after the last half-move
+	 */
+	bool GameRecord::replay(Position &position, bool &won) const {
+		Position replayed;
+		won = false;
+
+		for(unsigned int i = 0; i < this->length; i++) {
+			if(won)
+				return false;
+
+			unsigned int value = this->halfMoves[i];
+			if(isPlacement(i)) {
+				if(replayed.isOccupied(value))
+					return false;
+				won = replayed.place(value);
+			} else {
+				if(((replayed.getAvailablePieces() >> value) & 1) == 0)
+					return false;
+				replayed.give(value);
+			}
+		}
+
+		position = replayed;
+		return true;
+	}
+
+	/**
+	 * @param moves Receives the moves; must have room for MAX_MOVES
+	 * @return The number of moves
+	 */
+	unsigned int GameRecord::toMoves(Move *moves) const {
+		unsigned int numMoves = 0;
+		for(unsigned int i = 0; i < this->length; ) {
+			Move &move = moves[numMoves++];
+			move = Move();
+			if(isPlacement(i))
+				move.square = this->halfMoves[i++];
+			if(i < this->length)
+				move.piece = this->halfMoves[i++];
+		}
+		return numMoves;
+	}
+
+	std::string GameRecord::toText() const {
+		char text[MAX_TEXT_SIZE];
+		return std::string(text, toText(text));
+	}
+
+	unsigned int GameRecord::toText(char *out) const {
+		char *c = out;
+		if(this->length > 0) {
+			*c++ = '-';
+			*c++ = hexDigits[this->halfMoves[0]];
+		}
+		for(unsigned int i = 1; i < this->length; i += 2) {
+			*c++ = ' ';
+			*c++ = (char)('a' + this->halfMoves[i] % 4);
+			*c++ = (char)('1' + this->halfMoves[i] / 4);
+			*c++ = (i + 1 < this->length ? hexDigits[this->halfMoves[i + 1]] : '-');
+		}
+		return (unsigned int)(c - out);
+	}
+
+	/**
+	 * @param begin The first character of a line of moves
+	 * @param end One past the last character, excluding the line ending
+	 */
+	bool GameRecord::fromText(const char *begin, const char *end) {
+		clear();
+
+		const char *c = begin;
+		for(;;) {
+			while(c != end && isSpace(*c))
+				c++;
+			if(c == end)
+				return true;
+
+			const char *word = c;
+			while(c != end && !isSpace(*c))
+				c++;
+
+			unsigned int value;
+			std::ptrdiff_t size = c - word;
+			if(size == 2 && word[0] == '-') {
+				if(!parsePieceChar(word[1], value) || !appendGive(value))
+					return false;
+			} else if(size == 3) {
+				if(!parseSquareChars(word[0], word[1], value) || !appendPlace(value))
+					return false;
+				if(word[2] != '-' && (!parsePieceChar(word[2], value) || !appendGive(value)))
+					return false;
+			} else {
+				return false;
+			}
+		}
+	}
+
+	unsigned int GameRecord::toBinary(byte *out) const {
+		out[0] = this->length;
+		for(unsigned int i = 0; i < this->length; i += 2) {
+			byte low = (i + 1 < this->length ? this->halfMoves[i + 1] : 0);
+			out[1 + i / 2] = (byte)((this->halfMoves[i] << 4) | low);
+		}
+		return 1 + (this->length + 1) / 2;
+	}
+
+	unsigned int GameRecord::fromBinary(const byte *in, unsigned int size) {
+		if(size < 1 || in[0] > MAX_HALF_MOVES)
+			return 0;
+
+		unsigned int recordSize = 1 + (in[0] + 1) / 2;
+		if(size < recordSize)
+			return 0;
+
+		this->length = in[0];
+		for(unsigned int i = 0; i < this->length; i++) {
+			byte packed = in[1 + i / 2];
+			this->halfMoves[i] = (isPlacement(i) ? packed & 0xF : packed >> 4);
+		}
+		return recordSize;
+	}
+
+	GameRecordWriter::GameRecordWriter(std::ostream &out, RecordFormat format)
+		: out(out), format(format), buffer(BUFFER_SIZE), used(0) {
+	}
+
+	GameRecordWriter::~GameRecordWriter() {
+		flush();
+	}
+
+	void GameRecordWriter::write(const GameRecord &record) {
+		if(this->used + GameRecord::MAX_TEXT_SIZE + 1 > this->buffer.size())
+			flush();
+
+		char *out = &this->buffer[this->used];
+		if(this->format == RECORD_BINARY) {
+			this->used += record.toBinary((byte *)out);
+		} else {
+			unsigned int size = record.toText(out);
+			out[size] = '\n';
+			this->used += size + 1;
+		}
+	}
+
+	void GameRecordWriter::flush() {
+		if(this->used > 0) {
+			this->out.write(&this->buffer[0], (std::streamsize)this->used);
+			this->used = 0;
+		}
+		this->out.flush();
+	}
+
+	GameRecordReader::GameRecordReader(std::istream &in, RecordFormat format)
+		: in(in), format(format), buffer(BUFFER_SIZE), begin(0), end(0), error(false) {
+	}
+
+	bool GameRecordReader::read(GameRecord &record) {
+		if(this->error)
+			return false;
+
+		for(;;) {
+			const char *data = &this->buffer[0];
+			std::size_t available = this->end - this->begin;
+
+			if(this->format == RECORD_BINARY) {
+				unsigned int size = record.fromBinary((const byte *)data + this->begin, (unsigned int)available);
+				if(size > 0) {
+					this->begin += size;
+					return true;
+				}
+				if(available > 0 && (byte)data[this->begin] > GameRecord::MAX_HALF_MOVES) {
+					this->error = true;
+					return false;
+				}
+			} else {
+				const char *line = data + this->begin;
+				const char *newline = (const char *)std::memchr(line, '\n', available);
+				if(newline != NULL) {
+					this->begin += (newline - line) + 1;
+					if(!record.fromText(line, newline)) {
+						this->error = true;
+						return false;
+					}
+					return true;
+				}
+			}
+
+			if(!fill()) {
+				// A text record may end the stream without a line ending
+				available = this->end - this->begin;
+				if(available == 0)
+					return false;
+				if(this->format == RECORD_TEXT && available < this->buffer.size()) {
+					const char *line = &this->buffer[this->begin];
+					this->begin = this->end;
+					if(record.fromText(line, line + available))
+						return true;
+				}
+				this->error = true;
+				return false;
+			}
+		}
+	}
+
+	bool GameRecordReader::fill() {
+		std::size_t available = this->end - this->begin;
+		if(available == this->buffer.size())
+			return false;
+
+		if(this->begin > 0) {
+			std::memmove(&this->buffer[0], &this->buffer[this->begin], available);
+			this->begin = 0;
+			this->end = available;
+		}
+
+		this->in.read(&this->buffer[this->end], (std::streamsize)(this->buffer.size() - this->end));
+		std::streamsize received = this->in.gcount();
+		this->end += (std::size_t)received;
+		return received > 0;
+	}
+
+}
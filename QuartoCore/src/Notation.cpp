@@ -0,0 +1,153 @@
+/**
+* @file Notation.cpp
+*/
+#include "Notation.hpp"
+
+namespace {
+
+	const char hexDigits[] = "0123456789abcdef";
+
+	bool parseHexDigit(char c, unsigned int &value) {
+		if(c >= '0' && c <= '9')
+			value = (unsigned int)(c - '0');
+		else if(c >= 'a' && c <= 'f')
+			value = (unsigned int)(c - 'a' + 10);
+		else if(c >= 'A' && c <= 'F')
+			value = (unsigned int)(c - 'A' + 10);
+		else
+			return false;
+		return true;
+	}
+
+}
+
+namespace quarto {
+
+	std::string formatSquare(unsigned int square) {
+		std::string text(2, ' ');
+		text[0] = (char)('a' + square % 4);
+		text[1] = (char)('1' + square / 4);
+		return text;
+	}
+
+	bool parseSquare(const std::string &text, unsigned int &square) {
+		if(text.size() != 2 || text[0] < 'a' || text[0] > 'd' || text[1] < '1' || text[1] > '4')
+			return false;
+		square = (unsigned int)(text[1] - '1') * 4 + (unsigned int)(text[0] - 'a');
+		return true;
+	}
+
+	std::string formatPiece(unsigned int piece) {
+		return std::string(1, hexDigits[piece & 0xF]);
+	}
+
+	bool parsePiece(const std::string &text, unsigned int &piece) {
+		return text.size() == 1 && parseHexDigit(text[0], piece);
+	}
+
+	std::string formatMove(const Move &move) {
+		std::string text;
+		text += (move.square == Move::NONE ? "-" : formatSquare(move.square));
+		text += (move.piece == Move::NONE ? "-" : formatPiece(move.piece));
+		return text;
+	}
+
+	bool parseMove(const std::string &text, Move &move) {
+		std::string square, piece;
+		if(text.size() == 2 && text[0] == '-') {
+			square = "-";
+			piece = text.substr(1);
+		} else if(text.size() == 3) {
+			square = text.substr(0, 2);
+			piece = text.substr(2);
+		} else {
+			return false;
+		}
+
+		unsigned int value;
+		move = Move();
+		if(square != "-") {
+			if(!parseSquare(square, value))
+				return false;
+			move.square = (byte)value;
+		}
+		if(piece != "-") {
+			if(!parsePiece(piece, value))
+				return false;
+			move.piece = (byte)value;
+		}
+		return !move.isNull();
+	}
+
+	std::string formatBoard(const Position &position) {
+		std::string text;
+		for(unsigned int square = 0; square < Position::NUM_SQUARES; square++) {
+			text += (position.isOccupied(square) ? hexDigits[position.getPieceAt(square)] : '.');
+		}
+		text += ' ';
+		text += (position.getPieceInHand() == Position::NO_PIECE ? "-" : formatPiece(position.getPieceInHand()));
+		return text;
+	}
+
+	/**
+	 * @param board Sixteen characters in square order
+	 * @param inHand A piece still in the pool, or "-"
+	 * @param position Receives the position; unchanged on failure
+	 */
+	bool parseBoard(const std::string &board, const std::string &inHand, Position &position) {
+		if(board.size() != Position::NUM_SQUARES)
+			return false;
+
+		Position parsed;
+		for(unsigned int square = 0; square < Position::NUM_SQUARES; square++) {
+			if(board[square] == '.')
+				continue;
+
+			unsigned int piece;
+			if(!parseHexDigit(board[square], piece) || ((parsed.getAvailablePieces() >> piece) & 1) == 0)
+				return false;
+
+			parsed.give(piece);
+			if(parsed.place(square))
+				return false;
+		}
+
+		if(inHand != "-") {
+			unsigned int piece;
+			if(!parsePiece(inHand, piece) || ((parsed.getAvailablePieces() >> piece) & 1) == 0)
+				return false;
+			parsed.give(piece);
+		}
+
+		position = parsed;
+		return true;
+	}
+
+	/**
+	 * Either half of the move may be absent, so a placement and the choice
+	 * that follows it can also be played one at a time.
+	 */
+	bool playMove(Position &position, const Move &move, bool &won) {
+		if(move.isNull())
+			return false;
+
+		Position after = position;
+		won = false;
+
+		if(move.square != Move::NONE) {
+			if(after.getPieceInHand() == Position::NO_PIECE || move.square >= Position::NUM_SQUARES || after.isOccupied(move.square))
+				return false;
+			won = after.place(move.square);
+		}
+
+		if(move.piece != Move::NONE) {
+			if(won || after.getPieceInHand() != Position::NO_PIECE || move.piece >= Position::NUM_PIECES || ((after.getAvailablePieces() >> move.piece) & 1) == 0)
+				return false;
+			after.give(move.piece);
+		}
+
+		position = after;
+		return true;
+	}
+
+}
@@ -16,6 +16,14 @@ namespace quarto {
 		validateDescription(description);
 	}
 
+	/**
+	 * @param index A 4-bit piece index, as returned by getIndex()
+	 * @return The piece with the attributes encoded in the index
+	 */
+	Piece Piece::fromIndex(unsigned int index) {
+		return Piece((index & 0x1) != 0, (index & 0x2) != 0, (index & 0x4) != 0, (index & 0x8) != 0);
+	}
+
 	void Piece::validateDescription(byte description) {
 		if (description & SQUARE && description & ROUND) {
 			// Both shapes were specified
@@ -0,0 +1,206 @@
+/**
+* @file Position.cpp
+*/
+#include "Position.hpp"
+#include "Game.hpp"
+
+namespace {
+
+	using namespace quarto;
+
+	const unsigned int numLines = 10;
+
+	/** Square masks of the rows, columns and diagonals */
+	const boost::uint16_t lines[numLines] = {
+		0x000F, 0x00F0, 0x0F00, 0xF000,
+		0x1111, 0x2222, 0x4444, 0x8888,
+		0x8421, 0x1248
+	};
+
+	/** Masks of the piece indices that have each attribute bit set */
+	const boost::uint16_t piecesWithAttribute[4] = { 0xAAAA, 0xCCCC, 0xF0F0, 0xFF00 };
+
+	boost::uint64_t pieceSquareKeys[Position::NUM_PIECES][Position::NUM_SQUARES];
+	boost::uint64_t pieceInHandKeys[Position::NUM_PIECES + 1];
+
+	boost::uint64_t nextRandom(boost::uint64_t &state) {
+		boost::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	/** Fills the hashing keys before main() runs, so searches on any thread can share them */
+	struct KeyInitializer {
+		KeyInitializer() {
+			boost::uint64_t state = Position::HASH_SEED;
+			for(unsigned int p = 0; p < Position::NUM_PIECES; p++) {
+				for(unsigned int s = 0; s < Position::NUM_SQUARES; s++) {
+					pieceSquareKeys[p][s] = nextRandom(state);
+				}
+			}
+			for(unsigned int p = 0; p <= Position::NUM_PIECES; p++) {
+				pieceInHandKeys[p] = nextRandom(state);
+			}
+		}
+	} keyInitializer;
+
+	inline boost::uint64_t inHandKey(byte piece) {
+		return pieceInHandKeys[piece == Position::NO_PIECE ? Position::NUM_PIECES : piece];
+	}
+
+}
+
+namespace quarto {
+
+	const boost::uint64_t Position::HASH_SEED = 0x51554152544F3031ULL;
+
+	Position::Position()
+		: board(0), key(inHandKey(NO_PIECE)), occupied(0), available(0xFFFF), inHand(NO_PIECE) {
+	}
+
+	/**
+	 * @param game A game in any state; finished games yield a position with no piece in hand
+	 */
+	Position::Position(const Game &game)
+		: board(0), key(0), occupied(0), available(0), inHand(NO_PIECE) {
+		for(unsigned int row = 0; row < 4; row++) {
+			for(unsigned int col = 0; col < 4; col++) {
+				byte info = game.getBoard().getInfo(row, col);
+				if(info != 0x00) {
+					unsigned int square = row * 4 + col;
+					unsigned int piece = Piece(info).getIndex();
+					this->board |= (boost::uint64_t)piece << (4 * square);
+					this->occupied |= (boost::uint16_t)(1 << square);
+					this->key ^= pieceSquareKeys[piece][square];
+				}
+			}
+		}
+
+		vector<Piece> availablePieces = game.getAvailablePieces();
+		for(vector<Piece>::const_iterator i = availablePieces.begin(); i != availablePieces.end(); ++i) {
+			this->available |= (boost::uint16_t)(1 << i->getIndex());
+		}
+
+		if(game.getState() == P1_PLACE || game.getState() == P2_PLACE) {
+			this->inHand = (byte)game.getChosenPiece().getIndex();
+		}
+		this->key ^= inHandKey(this->inHand);
+	}
+
+	bool Position::fromBoard(boost::uint64_t board, boost::uint16_t occupied, byte inHand, Position &position, bool &won) {
+		Position built;
+		bool complete = false;
+		for(boost::uint16_t m = occupied; m != 0; m &= m - 1) {
+			unsigned int square = lowestBit(m);
+			unsigned int piece = (unsigned int)(board >> (4 * square)) & 0xF;
+			if(((built.getAvailablePieces() >> piece) & 1) == 0)
+				return false;
+			built.give(piece);
+			complete = built.place(square) || complete;
+		}
+
+		if(inHand != NO_PIECE) {
+			if(inHand >= NUM_PIECES || ((built.getAvailablePieces() >> inHand) & 1) == 0)
+				return false;
+			built.give(inHand);
+		}
+
+		position = built;
+		won = complete;
+		return true;
+	}
+
+	unsigned int Position::getNumPlaced() const {
+		return countBits(this->occupied);
+	}
+
+	/**
+	 * @param square An empty square
+	 * @return true if placing the piece in hand there would complete a line
+	 */
+	bool Position::isWinningPlacement(unsigned int square) const {
+		boost::uint16_t after = this->occupied | (boost::uint16_t)(1 << square);
+		boost::uint64_t afterBoard = this->board | ((boost::uint64_t)this->inHand << (4 * square));
+
+		for(unsigned int i = 0; i < numLines; i++) {
+			if((lines[i] >> square) & 1) {
+				if((after & lines[i]) == lines[i] && isWinningLine(lines[i], afterBoard))
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * A piece is unsafe if some line has three occupied squares whose pieces
+	 * share an attribute with it. The mask is not restricted to the pool.
+	 *
+	 * @return A mask over piece indices
+	 */
+	boost::uint16_t Position::getUnsafePieces() const {
+		boost::uint16_t unsafe = 0;
+
+		for(unsigned int i = 0; i < numLines; i++) {
+			boost::uint16_t filled = this->occupied & lines[i];
+			if(countBits(filled) != 3)
+				continue;
+
+			unsigned int common = 0xF;
+			unsigned int any = 0x0;
+			for(boost::uint16_t m = filled; m != 0; m &= m - 1) {
+				unsigned int piece = getPieceAt(lowestBit(m));
+				common &= piece;
+				any |= piece;
+			}
+
+			for(unsigned int b = 0; b < 4; b++) {
+				if((common >> b) & 1)
+					unsafe |= piecesWithAttribute[b];
+				if(((any >> b) & 1) == 0)
+					unsafe |= (boost::uint16_t)~piecesWithAttribute[b];
+			}
+		}
+
+		return unsafe;
+	}
+
+	/**
+	 * @param square An empty square
+	 * @return true if the placement completes a line
+	 */
+	bool Position::place(unsigned int square) {
+		bool win = isWinningPlacement(square);
+
+		this->board |= (boost::uint64_t)this->inHand << (4 * square);
+		this->occupied |= (boost::uint16_t)(1 << square);
+		this->key ^= pieceSquareKeys[this->inHand][square] ^ inHandKey(this->inHand) ^ inHandKey(NO_PIECE);
+		this->inHand = NO_PIECE;
+
+		return win;
+	}
+
+	/**
+	 * @param piece The index of a piece still in the pool
+	 */
+	void Position::give(unsigned int piece) {
+		this->available &= (boost::uint16_t)~(1 << piece);
+		this->key ^= inHandKey(this->inHand) ^ inHandKey((byte)piece);
+		this->inHand = (byte)piece;
+	}
+
+	bool Position::isWinningLine(boost::uint16_t line, boost::uint64_t pieces) const {
+		unsigned int common = 0xF;
+		unsigned int any = 0x0;
+
+		for(boost::uint16_t m = line; m != 0; m &= m - 1) {
+			unsigned int piece = (unsigned int)(pieces >> (4 * lowestBit(m))) & 0xF;
+			common &= piece;
+			any |= piece;
+		}
+
+		return common != 0 || any != 0xF;
+	}
+
+}
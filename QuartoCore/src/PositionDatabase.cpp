@@ -0,0 +1,433 @@
+/**
+* @file PositionDatabase.cpp
+*/
+#include "PositionDatabase.hpp"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using boost::interprocess::file_mapping;
+using boost::interprocess::mapped_region;
+using boost::interprocess::read_only;
+
+namespace {
+
+	using namespace quarto;
+
+	const char fileMagic[8] = { 'Q', 'U', 'A', 'R', 'T', 'O', 'P', 'I' };
+	const boost::uint32_t FILE_VERSION = 1;
+
+	/** Entries written to a segment at a time */
+	const std::size_t WRITE_BATCH = 1 << 14;
+
+	struct FileHeader {
+		char magic[8];
+		boost::uint32_t version;
+		boost::uint32_t entrySize;
+		boost::uint64_t hashSeed;
+		boost::uint64_t numEntries;
+		char reserved[32];
+	};
+
+	inline void addResult(IndexEntry &to, const IndexEntry &from) {
+		to.games += from.games;
+		to.wins += from.wins;
+		to.losses += from.losses;
+	}
+
+	inline bool hasMoreGames(const MoveStats &a, const MoveStats &b) {
+		return a.games > b.games;
+	}
+
+	/**
+	 * Renames a finished file over the target in one step. Windows will not
+	 * rename onto an existing file, so there the target is removed first.
+	 *
+	 * @return false, with the temporary file removed, if the target was not replaced
+	 */
+	bool replaceFile(const std::string &tempFilename, const std::string &filename) {
+		if(std::rename(tempFilename.c_str(), filename.c_str()) == 0)
+			return true;
+		std::remove(filename.c_str());
+		if(std::rename(tempFilename.c_str(), filename.c_str()) == 0)
+			return true;
+		std::remove(tempFilename.c_str());
+		return false;
+	}
+
+	/**
+	 * @brief Streams sorted entries to a temporary file and renames it into place
+	 */
+	class SegmentWriter {
+	public:
+
+		SegmentWriter(const std::string &filename)
+			: filename(filename), tempFilename(filename + ".tmp"), numEntries(0), hasPending(false) {
+			this->buffer.reserve(WRITE_BATCH);
+			this->out.open(this->tempFilename.c_str(), std::ios::binary | std::ios::trunc);
+			FileHeader header;
+			std::memset(&header, 0, sizeof(header));
+			this->out.write((const char *)&header, sizeof(header));
+		}
+
+		/** Entries must arrive in order; equal moves are merged */
+		void write(const IndexEntry &entry) {
+			if(this->hasPending && this->pending.isSameMove(entry)) {
+				addResult(this->pending, entry);
+				return;
+			}
+			if(this->hasPending)
+				push(this->pending);
+			this->pending = entry;
+			this->hasPending = true;
+		}
+
+		/** @return true if every entry was written and the file replaced */
+		bool finish() {
+			if(this->hasPending)
+				push(this->pending);
+			writeBuffer();
+
+			FileHeader header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, fileMagic, sizeof(header.magic));
+			header.version = FILE_VERSION;
+			header.entrySize = sizeof(IndexEntry);
+			header.hashSeed = Position::HASH_SEED;
+			header.numEntries = this->numEntries;
+			this->out.seekp(0);
+			this->out.write((const char *)&header, sizeof(header));
+			this->out.close();
+			if(!this->out) {
+				std::remove(this->tempFilename.c_str());
+				return false;
+			}
+
+			return replaceFile(this->tempFilename, this->filename);
+		}
+
+	private:
+
+		std::string filename;
+		std::string tempFilename;
+		std::ofstream out;
+		std::vector<IndexEntry> buffer;
+		boost::uint64_t numEntries;
+		IndexEntry pending;
+		bool hasPending;
+
+		void push(const IndexEntry &entry) {
+			this->buffer.push_back(entry);
+			if(this->buffer.size() == WRITE_BATCH)
+				writeBuffer();
+		}
+
+		void writeBuffer() {
+			if(this->buffer.empty())
+				return;
+			this->out.write((const char *)&this->buffer[0], (std::streamsize)(this->buffer.size() * sizeof(IndexEntry)));
+			this->numEntries += this->buffer.size();
+			this->buffer.clear();
+		}
+
+	};
+
+}
+
+namespace quarto {
+
+	/**
+	 * One entry is added for the position before each move, and one with a
+	 * null move for the position the game stopped in, so every position of
+	 * the game is counted once.
+	 */
+	bool PositionIndexBuilder::add(const GameRecord &record) {
+		Position replayed;
+		bool won;
+		if(!record.replay(replayed, won))
+			return false;
+
+		Move moves[GameRecord::MAX_MOVES + 1];
+		unsigned int numMoves = record.toMoves(moves);
+		moves[numMoves] = Move();
+
+		// The players alternate moves, and a winner made the last one
+		Position position;
+		for(unsigned int i = 0; i <= numMoves; i++) {
+			const Move &move = moves[i];
+			Position canonical = this->canonicalizer.canonicalize(position);
+			Move canonicalMove = this->canonicalizer.canonicalizeMove(move);
+
+			IndexEntry entry;
+			std::memset(&entry, 0, sizeof(entry));
+			entry.key = canonical.getKey();
+			entry.square = canonicalMove.square;
+			entry.piece = canonicalMove.piece;
+			entry.games = 1;
+			if(i < numMoves && won) {
+				if((numMoves - 1 - i) % 2 == 0)
+					entry.wins = 1;
+				else
+					entry.losses = 1;
+			}
+			this->entries.push_back(entry);
+
+			if(move.square != Move::NONE)
+				position.place(move.square);
+			if(move.piece != Move::NONE)
+				position.give(move.piece);
+		}
+
+		return true;
+	}
+
+	void PositionIndexBuilder::sort() {
+		if(this->entries.empty())
+			return;
+
+		std::sort(this->entries.begin(), this->entries.end());
+
+		std::vector<IndexEntry>::iterator last = this->entries.begin();
+		for(std::vector<IndexEntry>::iterator i = last + 1; i != this->entries.end(); ++i) {
+			if(last->isSameMove(*i))
+				addResult(*last, *i);
+			else
+				*++last = *i;
+		}
+		this->entries.erase(last + 1, this->entries.end());
+	}
+
+	void PositionIndexBuilder::clear() {
+		std::vector<IndexEntry>().swap(this->entries);
+	}
+
+	/**
+	 * The manifest lists the segment numbers, and segments it does not list
+	 * are ignored. A database written before the manifest has its segments
+	 * numbered from 0 with no gaps, and the first missing file ends it. A
+	 * path with neither is an empty database.
+	 *
+	 * @return false if the manifest or a segment is not valid for this build
+	 */
+	bool PositionDatabase::open(const std::string &path) {
+		this->path = path;
+		this->segments.clear();
+		this->nextNumber = 0;
+
+		std::ifstream manifest(getManifestPath().c_str());
+		if(!manifest) {
+			for(std::size_t number = 0; ; number++) {
+				if(!std::ifstream(getSegmentPath(number).c_str()))
+					return true;
+				if(!mapSegment(number)) {
+					this->segments.clear();
+					return false;
+				}
+			}
+		}
+
+		std::size_t number;
+		while(manifest >> number) {
+			if(!mapSegment(number)) {
+				this->segments.clear();
+				return false;
+			}
+		}
+		if(!manifest.eof()) {
+			this->segments.clear();
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @param builder Sorted and merged in place before writing
+	 */
+	bool PositionDatabase::append(PositionIndexBuilder &builder) {
+		builder.sort();
+		const std::vector<IndexEntry> &entries = builder.getEntries();
+		if(entries.empty())
+			return true;
+
+		std::size_t number = this->nextNumber;
+		SegmentWriter writer(getSegmentPath(number));
+		for(std::vector<IndexEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+			writer.write(*i);
+		}
+		if(!writer.finish() || !mapSegment(number))
+			return false;
+		if(!writeManifest()) {
+			this->segments.pop_back();
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Merges the sorted segments in one pass, so memory use does not grow with
+	 * the size of the database. The merged segment gets a new number, and
+	 * rewriting the manifest switches the database over to it in one rename;
+	 * the old segments are only removed after that.
+	 */
+	bool PositionDatabase::compact() {
+		if(this->segments.size() < 2)
+			return true;
+
+		std::size_t numSegments = this->segments.size();
+		std::vector<std::size_t> cursors(numSegments, 0);
+		std::size_t number = this->nextNumber;
+		SegmentWriter writer(getSegmentPath(number));
+		for(;;) {
+			std::size_t least = numSegments;
+			for(std::size_t s = 0; s < numSegments; s++) {
+				const Segment &segment = this->segments[s];
+				if(cursors[s] < segment.numEntries &&
+						(least == numSegments || segment.entries[cursors[s]] < this->segments[least].entries[cursors[least]]))
+					least = s;
+			}
+			if(least == numSegments)
+				break;
+			writer.write(this->segments[least].entries[cursors[least]++]);
+		}
+
+		if(!writer.finish())
+			return false;
+
+		std::vector<Segment> merged;
+		merged.swap(this->segments);
+		if(!mapSegment(number) || !writeManifest()) {
+			this->segments.swap(merged);
+			merged.clear();
+			std::remove(getSegmentPath(number).c_str());
+			return false;
+		}
+
+		// Unmapped first, since Windows cannot remove a mapped file
+		std::vector<std::size_t> numbers;
+		for(std::vector<Segment>::const_iterator s = merged.begin(); s != merged.end(); ++s) {
+			numbers.push_back(s->number);
+		}
+		merged.clear();
+		for(std::vector<std::size_t>::const_iterator i = numbers.begin(); i != numbers.end(); ++i) {
+			std::remove(getSegmentPath(*i).c_str());
+		}
+		return true;
+	}
+
+	/**
+	 * Entries for the position are gathered from every segment and merged,
+	 * then mapped back through the symmetry that canonicalized the position.
+	 */
+	PositionStats PositionDatabase::lookup(const Position &position) const {
+		Canonicalizer canonicalizer;
+		IndexEntry key;
+		std::memset(&key, 0, sizeof(key));
+		key.key = canonicalizer.canonicalize(position).getKey();
+
+		std::vector<IndexEntry> found;
+		for(std::vector<Segment>::const_iterator s = this->segments.begin(); s != this->segments.end(); ++s) {
+			const IndexEntry *end = s->entries + s->numEntries;
+			for(const IndexEntry *i = std::lower_bound(s->entries, end, key); i != end && i->key == key.key; ++i) {
+				found.push_back(*i);
+			}
+		}
+		std::sort(found.begin(), found.end());
+
+		PositionStats stats;
+		for(std::vector<IndexEntry>::const_iterator i = found.begin(); i != found.end(); ++i) {
+			stats.games += i->games;
+			if(i != found.begin() && i->isSameMove(*(i - 1))) {
+				MoveStats &last = stats.moves.back();
+				last.games += i->games;
+				last.wins += i->wins;
+				last.losses += i->losses;
+				continue;
+			}
+			MoveStats move;
+			move.move = canonicalizer.restoreMove(Move(i->square, i->piece));
+			move.games = i->games;
+			move.wins = i->wins;
+			move.losses = i->losses;
+			stats.moves.push_back(move);
+		}
+		std::stable_sort(stats.moves.begin(), stats.moves.end(), hasMoreGames);
+
+		return stats;
+	}
+
+	std::size_t PositionDatabase::getNumEntries() const {
+		std::size_t numEntries = 0;
+		for(std::vector<Segment>::const_iterator s = this->segments.begin(); s != this->segments.end(); ++s) {
+			numEntries += s->numEntries;
+		}
+		return numEntries;
+	}
+
+	std::string PositionDatabase::getSegmentPath(std::size_t number) const {
+		std::ostringstream filename;
+		filename << this->path << '.' << number;
+		return filename.str();
+	}
+
+	std::string PositionDatabase::getManifestPath() const {
+		return this->path + ".manifest";
+	}
+
+	/**
+	 * Written to a temporary file and renamed over the last manifest, so the
+	 * database changes from one set of segments to the next at once.
+	 */
+	bool PositionDatabase::writeManifest() const {
+		std::string filename = getManifestPath();
+		std::string tempFilename = filename + ".tmp";
+		{
+			std::ofstream out(tempFilename.c_str(), std::ios::trunc);
+			for(std::vector<Segment>::const_iterator s = this->segments.begin(); s != this->segments.end(); ++s) {
+				out << s->number << '\n';
+			}
+			out.close();
+			if(!out) {
+				std::remove(tempFilename.c_str());
+				return false;
+			}
+		}
+		return replaceFile(tempFilename, filename);
+	}
+
+	bool PositionDatabase::mapSegment(std::size_t number) {
+		std::string filename = getSegmentPath(number);
+		boost::shared_ptr<mapped_region> region;
+		try {
+			file_mapping file(filename.c_str(), read_only);
+			region.reset(new mapped_region(file, read_only));
+		} catch(const boost::interprocess::interprocess_exception &) {
+			return false;
+		}
+
+		if(region->get_size() < sizeof(FileHeader))
+			return false;
+
+		const FileHeader *header = (const FileHeader *)region->get_address();
+		if(std::memcmp(header->magic, fileMagic, sizeof(header->magic)) != 0 ||
+				header->version != FILE_VERSION ||
+				header->entrySize != sizeof(IndexEntry) ||
+				header->hashSeed != Position::HASH_SEED ||
+				region->get_size() != sizeof(FileHeader) + header->numEntries * sizeof(IndexEntry))
+			return false;
+
+		Segment segment;
+		segment.region = region;
+		segment.entries = (const IndexEntry *)((const char *)region->get_address() + sizeof(FileHeader));
+		segment.numEntries = (std::size_t)header->numEntries;
+		segment.number = number;
+		this->segments.push_back(segment);
+		if(number >= this->nextNumber)
+			this->nextNumber = number + 1;
+		return true;
+	}
+
+}
@@ -0,0 +1,543 @@
+/**
+* @file Search.cpp
+*/
+#include "Search.hpp"
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+using boost::posix_time::microsec_clock;
+using boost::posix_time::ptime;
+
+namespace {
+
+	using namespace quarto;
+
+	const int INFINITE_SCORE = 2 * WIN_SCORE;
+	const unsigned int MAX_MOVES = Position::NUM_SQUARES * Position::NUM_PIECES;
+
+	/** How many nodes a thread searches between checks of the stop flag and the limits */
+	const boost::uint64_t CHECK_INTERVAL = 1024;
+
+	/** Converts a win score from root-relative to node-relative, so it can be reused at any ply */
+	inline int scoreToTable(int score, unsigned int ply) {
+		if(score > DECISIVE_SCORE) return score + (int)ply;
+		if(score < -DECISIVE_SCORE) return score - (int)ply;
+		return score;
+	}
+
+	inline int scoreFromTable(int score, unsigned int ply) {
+		if(score > DECISIVE_SCORE) return score - (int)ply;
+		if(score < -DECISIVE_SCORE) return score + (int)ply;
+		return score;
+	}
+
+}
+
+namespace quarto {
+
+	/**
+	 * @brief One thread of a search
+	 */
+	class SearchWorker : boost::noncopyable {
+	public:
+
+		SearchWorker(Search &search, unsigned int id)
+			: table(&search.table), search(search), id(id), iterationDepth(0), aborted(false) {}
+
+		void run();
+		void searchRootMoves(unsigned int depth);
+		bool resolve(const Position &position, unsigned int ply, Move *bestMove, int &score) const;
+		unsigned int generateMoves(const Position &position, Move ttMove, Move *moves, bool *losing) const;
+
+		SearchResult result;
+		StatCounter nodes;
+		SearchStats stats;
+
+		/** The table to search with; the search's shared table unless the search is deterministic */
+		TranspositionTable *table;
+
+		/** The indices into Search::rootMoves this thread searches in a deterministic search */
+		std::vector<unsigned int> rootMoveIndices;
+
+	private:
+
+		Search &search;
+		unsigned int id;
+		unsigned int iterationDepth;
+		bool aborted;
+
+		int negamax(const Position &position, unsigned int depth, int alpha, int beta, unsigned int ply, Move *bestMove);
+		bool checkAbort();
+
+	};
+
+	void SearchWorker::run() {
+		const Position &root = this->search.root;
+		unsigned int maxDepth = this->search.getMaxDepth();
+
+		// Helper threads start at staggered depths so they fill the table ahead of the first thread
+		for(unsigned int depth = 1 + (this->id % 2); depth <= maxDepth; depth++) {
+			this->iterationDepth = depth;
+
+			Move move;
+			int score = negamax(root, depth, -INFINITE_SCORE, INFINITE_SCORE, 0, &move);
+			if(this->aborted)
+				break;
+
+			this->result.move = move;
+			this->result.score = score;
+			this->result.depth = depth;
+
+			if(score > DECISIVE_SCORE || score < -DECISIVE_SCORE)
+				break;
+		}
+
+		if(this->id == 0)
+			this->search.stop();
+	}
+
+	/**
+	 * Searches this thread's share of the root moves, one after another, with
+	 * a window that only narrows as this thread's own results come in.
+	 *
+	 * @param depth The number of placements to look ahead
+	 */
+	void SearchWorker::searchRootMoves(unsigned int depth) {
+		const Position &root = this->search.root;
+		bool placing = (root.getPieceInHand() != Position::NO_PIECE);
+		unsigned int childDepth = (placing ? depth - 1 : depth);
+		unsigned int childPly = (placing ? 1 : 0);
+		int alpha = -INFINITE_SCORE;
+
+		this->iterationDepth = depth;
+
+		for(std::vector<unsigned int>::const_iterator i = this->rootMoveIndices.begin(); i != this->rootMoveIndices.end(); ++i) {
+			Search::RootMove &rootMove = this->search.rootMoves[*i];
+			int score;
+			if(rootMove.losing) {
+				score = -(WIN_SCORE - (int)childPly);
+			} else {
+				Position child = root;
+				if(placing)
+					child.place(rootMove.move.square);
+				child.give(rootMove.move.piece);
+				score = -negamax(child, childDepth, -INFINITE_SCORE, -alpha, childPly, NULL);
+			}
+
+			if(this->aborted)
+				return;
+
+			rootMove.score = score;
+			if(score > alpha)
+				alpha = score;
+		}
+	}
+
+	/**
+	 * Settles nodes where the piece in hand wins immediately or fills the board.
+	 *
+	 * @param bestMove Receives the placement that settles the node, or NULL
+	 * @param score Receives the score of a settled node
+	 * @return true if the node is settled without searching
+	 */
+	bool SearchWorker::resolve(const Position &position, unsigned int ply, Move *bestMove, int &score) const {
+		byte inHand = position.getPieceInHand();
+		if(inHand == Position::NO_PIECE)
+			return false;
+
+		boost::uint16_t empty = (boost::uint16_t)~position.getOccupied();
+
+		if((position.getUnsafePieces() >> inHand) & 1) {
+			if(bestMove != NULL) {
+				for(boost::uint16_t m = empty; m != 0; m &= m - 1) {
+					if(position.isWinningPlacement(lowestBit(m))) {
+						*bestMove = Move((byte)lowestBit(m), Move::NONE);
+						break;
+					}
+				}
+			}
+			score = WIN_SCORE - (int)ply;
+			return true;
+		}
+
+		if(countBits(empty) == 1) {
+			if(bestMove != NULL)
+				*bestMove = Move((byte)lowestBit(empty), Move::NONE);
+			score = 0;
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * @param position The node; if it has no piece in hand, its moves only choose a piece
+	 * @param depth The number of placements left to look ahead
+	 * @param bestMove Receives the best move found, or NULL
+	 * @return The score from the point of view of the player to move
+	 */
+	int SearchWorker::negamax(const Position &position, unsigned int depth, int alpha, int beta, unsigned int ply, Move *bestMove) {
+		this->nodes.increment();
+		QUARTO_STAT(this->stats.countNode(ply));
+
+		if((this->nodes.get() & (CHECK_INTERVAL - 1)) == 0 && checkAbort())
+			return 0;
+
+		int resolvedScore;
+		if(resolve(position, ply, bestMove, resolvedScore))
+			return resolvedScore;
+
+		if(depth == 0)
+			return 0;
+
+		TableEntry entry;
+		Move ttMove;
+		TranspositionTable::ProbeResult probe = this->table->probe(position.getKey(), entry);
+		QUARTO_STAT(this->stats.countTableProbe(probe == TranspositionTable::HIT, probe == TranspositionTable::COLLISION));
+		if(probe == TranspositionTable::HIT) {
+			ttMove = entry.move;
+			if(entry.depth >= depth && bestMove == NULL) {
+				int score = scoreFromTable(entry.score, ply);
+				if(entry.bound == BOUND_EXACT ||
+						(entry.bound == BOUND_LOWER && score >= beta) ||
+						(entry.bound == BOUND_UPPER && score <= alpha))
+					return score;
+			}
+		}
+
+		Move moves[MAX_MOVES];
+		bool losing[MAX_MOVES];
+		unsigned int numMoves = generateMoves(position, ttMove, moves, losing);
+
+		bool placing = (position.getPieceInHand() != Position::NO_PIECE);
+		unsigned int childDepth = (placing ? depth - 1 : depth);
+		unsigned int childPly = (placing ? ply + 1 : ply);
+
+		int alphaOriginal = alpha;
+		int best = -INFINITE_SCORE;
+		Move bestFound = moves[0];
+
+		for(unsigned int i = 0; i < numMoves; i++) {
+			int score;
+			if(losing[i]) {
+				score = -(WIN_SCORE - (int)childPly);
+			} else {
+				Position child = position;
+				if(placing)
+					child.place(moves[i].square);
+				child.give(moves[i].piece);
+				score = -negamax(child, childDepth, -beta, -alpha, childPly, NULL);
+			}
+
+			if(this->aborted)
+				return 0;
+
+			if(score > best) {
+				best = score;
+				bestFound = moves[i];
+				if(score > alpha) {
+					alpha = score;
+					if(alpha >= beta) {
+						QUARTO_STAT(this->stats.countCutoff(ply, i));
+						break;
+					}
+				}
+			}
+		}
+
+		entry.move = bestFound;
+		entry.score = scoreToTable(best, ply);
+		entry.depth = depth;
+		entry.bound = (best >= beta ? BOUND_LOWER : (best > alphaOriginal ? BOUND_EXACT : BOUND_UPPER));
+		this->table->store(position.getKey(), entry);
+		QUARTO_STAT(this->stats.countTableStore());
+
+		if(bestMove != NULL)
+			*bestMove = bestFound;
+
+		return best;
+	}
+
+	/**
+	 * Moves that hand the opponent an immediate win are only generated when
+	 * every choice does; they are flagged as losing and not searched.
+	 *
+	 * @param position A node with no immediate win for the player to move
+	 * @param ttMove The move from the transposition table, tried first
+	 * @return The number of moves written
+	 */
+	unsigned int SearchWorker::generateMoves(const Position &position, Move ttMove, Move *moves, bool *losing) const {
+		unsigned int numMoves = 0;
+
+		if(position.getPieceInHand() == Position::NO_PIECE) {
+			boost::uint16_t available = position.getAvailablePieces();
+			boost::uint16_t safe = available & (boost::uint16_t)~position.getUnsafePieces();
+			boost::uint16_t pieces = (safe != 0 ? safe : available);
+
+			if(ttMove.piece != Move::NONE && ((pieces >> ttMove.piece) & 1)) {
+				losing[numMoves] = (safe == 0);
+				moves[numMoves++] = Move(Move::NONE, ttMove.piece);
+				pieces &= (boost::uint16_t)~(1 << ttMove.piece);
+			}
+			for(; pieces != 0; pieces &= pieces - 1) {
+				losing[numMoves] = (safe == 0);
+				moves[numMoves++] = Move(Move::NONE, (byte)lowestBit(pieces));
+			}
+			return numMoves;
+		}
+
+		// Rotate the square order per thread so helpers explore different subtrees first
+		boost::uint16_t empty = (boost::uint16_t)~position.getOccupied();
+		unsigned int rotation = (this->id * 5) % Position::NUM_SQUARES;
+
+		for(unsigned int n = 0; n <= Position::NUM_SQUARES; n++) {
+			unsigned int square;
+			if(n == 0) {
+				if(ttMove.square == Move::NONE || ((empty >> ttMove.square) & 1) == 0)
+					continue;
+				square = ttMove.square;
+			} else {
+				square = (n - 1 + rotation) % Position::NUM_SQUARES;
+				if(((empty >> square) & 1) == 0 || square == ttMove.square)
+					continue;
+			}
+
+			Position child = position;
+			child.place(square);
+			boost::uint16_t available = child.getAvailablePieces();
+			boost::uint16_t safe = available & (boost::uint16_t)~child.getUnsafePieces();
+
+			if(safe == 0) {
+				losing[numMoves] = true;
+				moves[numMoves++] = Move((byte)square, (byte)lowestBit(available));
+				continue;
+			}
+
+			if(square == ttMove.square && ttMove.piece != Move::NONE && ((safe >> ttMove.piece) & 1)) {
+				losing[numMoves] = false;
+				moves[numMoves++] = ttMove;
+				safe &= (boost::uint16_t)~(1 << ttMove.piece);
+			}
+			for(; safe != 0; safe &= safe - 1) {
+				losing[numMoves] = false;
+				moves[numMoves++] = Move((byte)square, (byte)lowestBit(safe));
+			}
+		}
+
+		return numMoves;
+	}
+
+	/**
+	 * The first iteration is never aborted, so every search yields a move.
+	 *
+	 * @return true if the search should unwind
+	 */
+	bool SearchWorker::checkAbort() {
+		if(this->iterationDepth <= 1)
+			return false;
+
+		if(this->id == 0 && !this->search.limits.deterministic && this->search.isOverBudget())
+			this->search.stop();
+
+		this->aborted = this->search.stopped.load(boost::memory_order_relaxed);
+		return this->aborted;
+	}
+
+	Search::Search(TranspositionTable &table) : table(table), stopped(false), running(false), statsLog(NULL), privateMegabytes(0) {
+	}
+
+	Search::~Search() {
+	}
+
+	/**
+	 * @param root A position in which the player to move has a piece to place or a piece to choose
+	 * @param limits The limits of the search
+	 * @return The best move found; a null move if the position has no moves
+	 */
+	SearchResult Search::run(const Position &root, const SearchLimits &limits) {
+		if(root.isFull() || (root.getPieceInHand() == Position::NO_PIECE && root.getAvailablePieces() == 0))
+			return SearchResult();
+
+		unsigned int numThreads = (limits.threads > 0 ? limits.threads : 1);
+
+		{
+			boost::mutex::scoped_lock lock(this->workersMutex);
+			this->root = root;
+			this->limits = limits;
+			this->stopped = false;
+			this->running = true;
+			this->startTime = microsec_clock::universal_time();
+			this->workers.clear();
+			for(unsigned int i = 0; i < numThreads; i++) {
+				this->workers.push_back(boost::shared_ptr<SearchWorker>(new SearchWorker(*this, i)));
+			}
+		}
+
+		if(limits.deterministic)
+			runDeterministic();
+		else
+			runShared();
+
+		{
+			boost::mutex::scoped_lock lock(this->workersMutex);
+			this->stopTime = microsec_clock::universal_time();
+			this->running = false;
+		}
+
+		SearchResult result = this->workers.at(0)->result;
+		result.nodes = getNodes();
+		result.seconds = getElapsedSeconds();
+
+		if(this->statsLog != NULL)
+			getStats().writeJson(*this->statsLog);
+
+		return result;
+	}
+
+	void Search::runShared() {
+		boost::thread_group helpers;
+		for(unsigned int i = 1; i < this->workers.size(); i++) {
+			helpers.create_thread(boost::bind(&SearchWorker::run, this->workers.at(i).get()));
+		}
+		this->workers.at(0)->run();
+		helpers.join_all();
+	}
+
+	/**
+	 * Each iteration deals the root moves out round-robin, searches them on all
+	 * threads and keeps the first move with the best score. Root moves are then
+	 * stably re-sorted by score for the next iteration, so every step depends
+	 * only on the position and the number of threads.
+	 */
+	void Search::runDeterministic() {
+		unsigned int numThreads = (unsigned int)this->workers.size();
+		SearchWorker &main = *this->workers.at(0);
+
+		unsigned int budget = (this->privateMegabytes > 0 ? this->privateMegabytes : this->table.getMegabytes());
+		unsigned int megabytes = std::max(1u, budget / numThreads);
+		if(this->privateTables.size() != numThreads || this->privateTables.at(0)->getMegabytes() != megabytes) {
+			this->privateTables.clear();
+			for(unsigned int i = 0; i < numThreads; i++) {
+				this->privateTables.push_back(boost::shared_ptr<TranspositionTable>(new TranspositionTable(megabytes)));
+			}
+		}
+		for(unsigned int i = 0; i < numThreads; i++) {
+			this->privateTables.at(i)->clear();
+			this->workers.at(i)->table = this->privateTables.at(i).get();
+		}
+
+		Move move;
+		int score;
+		if(main.resolve(this->root, 0, &move, score)) {
+			main.result.move = move;
+			main.result.score = score;
+			return;
+		}
+
+		Move moves[MAX_MOVES];
+		bool losing[MAX_MOVES];
+		unsigned int numMoves = main.generateMoves(this->root, Move(), moves, losing);
+		this->rootMoves.resize(numMoves);
+		for(unsigned int i = 0; i < numMoves; i++) {
+			this->rootMoves[i].move = moves[i];
+			this->rootMoves[i].losing = losing[i];
+			this->rootMoves[i].score = 0;
+		}
+
+		unsigned int maxDepth = getMaxDepth();
+		for(unsigned int depth = 1; depth <= maxDepth; depth++) {
+			for(unsigned int i = 0; i < numThreads; i++) {
+				this->workers.at(i)->rootMoveIndices.clear();
+			}
+			for(unsigned int i = 0; i < numMoves; i++) {
+				this->workers.at(i % numThreads)->rootMoveIndices.push_back(i);
+			}
+
+			boost::thread_group helpers;
+			for(unsigned int i = 1; i < numThreads; i++) {
+				helpers.create_thread(boost::bind(&SearchWorker::searchRootMoves, this->workers.at(i).get(), depth));
+			}
+			main.searchRootMoves(depth);
+			helpers.join_all();
+
+			if(this->stopped && depth > 1)
+				break;
+
+			std::stable_sort(this->rootMoves.begin(), this->rootMoves.end(), RootMove::isBetter);
+			main.result.move = this->rootMoves.front().move;
+			main.result.score = this->rootMoves.front().score;
+			main.result.depth = depth;
+
+			if(main.result.score > DECISIVE_SCORE || main.result.score < -DECISIVE_SCORE)
+				break;
+			if(this->limits.nodes > 0 && getNodes() >= this->limits.nodes)
+				break;
+		}
+	}
+
+	void Search::stop() {
+		this->stopped = true;
+	}
+
+	SearchStatsSnapshot Search::getStats() const {
+		SearchStatsSnapshot snapshot;
+		boost::mutex::scoped_lock lock(this->workersMutex);
+
+		for(std::vector<boost::shared_ptr<SearchWorker> >::const_iterator i = this->workers.begin(); i != this->workers.end(); ++i) {
+#if QUARTO_SEARCH_STATS
+			(*i)->stats.addTo(snapshot);
+#else
+			snapshot.nodes += (*i)->nodes.get();
+			snapshot.threadNodes.push_back((*i)->nodes.get());
+#endif
+		}
+
+		snapshot.seconds = getElapsedSeconds();
+
+		return snapshot;
+	}
+
+	/**
+	 * @param log The stream to write JSON statistics to, or NULL to disable
+	 */
+	void Search::setStatsLog(std::ostream *log) {
+		this->statsLog = log;
+	}
+
+	void Search::setPrivateTableMegabytes(unsigned int megabytes) {
+		this->privateMegabytes = megabytes;
+	}
+
+	/**
+	 * @return The deepest iteration worth running: the number of empty squares, or less if limited
+	 */
+	unsigned int Search::getMaxDepth() const {
+		unsigned int maxDepth = Position::NUM_SQUARES - this->root.getNumPlaced();
+		if(this->limits.depth > 0 && this->limits.depth < maxDepth)
+			maxDepth = this->limits.depth;
+		return maxDepth;
+	}
+
+	boost::uint64_t Search::getNodes() const {
+		boost::uint64_t nodes = 0;
+		for(std::vector<boost::shared_ptr<SearchWorker> >::const_iterator i = this->workers.begin(); i != this->workers.end(); ++i) {
+			nodes += (*i)->nodes.get();
+		}
+		return nodes;
+	}
+
+	double Search::getElapsedSeconds() const {
+		ptime endTime = (this->running ? microsec_clock::universal_time() : this->stopTime);
+		return (endTime - this->startTime).total_microseconds() / 1.0e6;
+	}
+
+	bool Search::isOverBudget() const {
+		if(this->limits.nodes > 0 && getNodes() >= this->limits.nodes)
+			return true;
+		if(this->limits.milliseconds > 0 && getElapsedSeconds() * 1000.0 >= (double)this->limits.milliseconds)
+			return true;
+		return false;
+	}
+
+}
@@ -0,0 +1,117 @@
+/**
+* @file SearchStats.cpp
+*/
+#include "SearchStats.hpp"
+
+using std::endl;
+
+namespace {
+
+	void writeArray(std::ostream &out, const boost::uint64_t *values, unsigned int count) {
+		out << "[";
+		for(unsigned int i = 0; i < count; i++) {
+			out << (i > 0 ? ", " : "") << values[i];
+		}
+		out << "]";
+	}
+
+}
+
+namespace quarto {
+
+	SearchStatsSnapshot::SearchStatsSnapshot()
+		: enabled(QUARTO_SEARCH_STATS != 0), seconds(0.0), nodes(0), cutoffs(0),
+		  tableProbes(0), tableHits(0), tableStores(0), tableCollisions(0) {
+		for(unsigned int i = 0; i < MAX_PLY; i++) {
+			nodesAtPly[i] = 0;
+			cutoffsAtPly[i] = 0;
+		}
+		for(unsigned int i = 0; i < MAX_MOVE_INDEX; i++) {
+			cutoffsAtMoveIndex[i] = 0;
+		}
+	}
+
+	double SearchStatsSnapshot::getNodesPerSecond() const {
+		return (this->seconds > 0.0 ? (double)this->nodes / this->seconds : 0.0);
+	}
+
+	double SearchStatsSnapshot::getTableHitRate() const {
+		return (this->tableProbes > 0 ? (double)this->tableHits / (double)this->tableProbes : 0.0);
+	}
+
+	/**
+	 * @return The fraction of beta cutoffs caused by the first move searched
+	 */
+	double SearchStatsSnapshot::getFirstMoveCutoffRate() const {
+		return (this->cutoffs > 0 ? (double)this->cutoffsAtMoveIndex[0] / (double)this->cutoffs : 0.0);
+	}
+
+	/**
+	 * @param out The stream to write a single JSON object to
+	 */
+	void SearchStatsSnapshot::writeJson(std::ostream &out) const {
+		out << "{" << endl;
+		out << "  \"enabled\": " << (this->enabled ? "true" : "false") << "," << endl;
+		out << "  \"seconds\": " << this->seconds << "," << endl;
+		out << "  \"nodes\": " << this->nodes << "," << endl;
+		out << "  \"nodesPerSecond\": " << getNodesPerSecond() << "," << endl;
+		out << "  \"threadNodes\": ";
+		writeArray(out, this->threadNodes.empty() ? 0 : &this->threadNodes[0], (unsigned int)this->threadNodes.size());
+		out << "," << endl;
+		out << "  \"cutoffs\": " << this->cutoffs << "," << endl;
+		out << "  \"firstMoveCutoffRate\": " << getFirstMoveCutoffRate() << "," << endl;
+		out << "  \"cutoffsAtMoveIndex\": ";
+		writeArray(out, this->cutoffsAtMoveIndex, MAX_MOVE_INDEX);
+		out << "," << endl;
+		out << "  \"table\": {\"probes\": " << this->tableProbes
+			<< ", \"hits\": " << this->tableHits
+			<< ", \"hitRate\": " << getTableHitRate()
+			<< ", \"stores\": " << this->tableStores
+			<< ", \"collisions\": " << this->tableCollisions << "}," << endl;
+		out << "  \"nodesAtPly\": ";
+		writeArray(out, this->nodesAtPly, MAX_PLY);
+		out << "," << endl;
+		out << "  \"cutoffsAtPly\": ";
+		writeArray(out, this->cutoffsAtPly, MAX_PLY);
+		out << endl << "}" << endl;
+	}
+
+	void SearchStats::clear() {
+		this->nodes.clear();
+		this->tableProbes.clear();
+		this->tableHits.clear();
+		this->tableStores.clear();
+		this->tableCollisions.clear();
+		for(unsigned int i = 0; i < MAX_PLY; i++) {
+			this->nodesAtPly[i].clear();
+			this->cutoffsAtPly[i].clear();
+		}
+		for(unsigned int i = 0; i < MAX_MOVE_INDEX; i++) {
+			this->cutoffsAtMoveIndex[i].clear();
+		}
+	}
+
+	/**
+	 * @param snapshot The snapshot to accumulate into
+	 */
+	void SearchStats::addTo(SearchStatsSnapshot &snapshot) const {
+		boost::uint64_t threadNodes = this->nodes.get();
+
+		snapshot.nodes += threadNodes;
+		snapshot.threadNodes.push_back(threadNodes);
+		snapshot.tableProbes += this->tableProbes.get();
+		snapshot.tableHits += this->tableHits.get();
+		snapshot.tableStores += this->tableStores.get();
+		snapshot.tableCollisions += this->tableCollisions.get();
+		for(unsigned int i = 0; i < MAX_PLY; i++) {
+			snapshot.nodesAtPly[i] += this->nodesAtPly[i].get();
+			snapshot.cutoffsAtPly[i] += this->cutoffsAtPly[i].get();
+		}
+		for(unsigned int i = 0; i < MAX_MOVE_INDEX; i++) {
+			boost::uint64_t cutoffs = this->cutoffsAtMoveIndex[i].get();
+			snapshot.cutoffsAtMoveIndex[i] += cutoffs;
+			snapshot.cutoffs += cutoffs;
+		}
+	}
+
+}
@@ -0,0 +1,296 @@
+/**
+* @file Tournament.cpp
+*/
+#include "Tournament.hpp"
+#include "Game.hpp"
+#include <boost/bind.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/thread/thread.hpp>
+#include <cmath>
+#include <iomanip>
+
+using boost::random::mt19937;
+using boost::random::uniform_int_distribution;
+
+namespace {
+
+	using namespace quarto;
+
+	/** The number of placements searched to check that an opening is undecided */
+	const unsigned int OPENING_CHECK_DEPTH = 2;
+
+	/** Random openings tried at each length before a shorter one is tried instead */
+	const unsigned int MAX_OPENING_ATTEMPTS = 1000;
+
+	/** The z-score of a two-sided 95% interval */
+	const double Z_95 = 1.959964;
+
+	inline double eloToScore(double elo) {
+		return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+	}
+
+	/** Scores of 0 and 1 are clamped, since they would imply an infinite difference */
+	inline double scoreToElo(double score) {
+		const double epsilon = 1e-6;
+		if(score < epsilon) score = epsilon;
+		if(score > 1.0 - epsilon) score = 1.0 - epsilon;
+		return -400.0 * std::log10(1.0 / score - 1.0);
+	}
+
+	/** @return The variance of the points scored in one game */
+	double getScoreVariance(const MatchScore &score) {
+		double s = score.getScore();
+		double n = (double)score.getGames();
+		return (score.wins * (1.0 - s) * (1.0 - s) + score.draws * (0.5 - s) * (0.5 - s) + score.losses * s * s) / n;
+	}
+
+	/** @return A uniformly random member of a non-empty mask */
+	unsigned int chooseBit(boost::uint16_t mask, mt19937 &random) {
+		uniform_int_distribution<unsigned int> choice(0, countBits(mask) - 1);
+		for(unsigned int n = choice(random); n > 0; n--)
+			mask &= mask - 1;
+		return lowestBit(mask);
+	}
+
+}
+
+namespace quarto {
+
+	double MatchScore::getScore() const {
+		unsigned int games = getGames();
+		return (games > 0 ? (this->wins + 0.5 * this->draws) / games : 0.5);
+	}
+
+	double MatchScore::getElo() const {
+		return scoreToElo(getScore());
+	}
+
+	double MatchScore::getEloMargin() const {
+		if(getGames() == 0)
+			return 0.0;
+
+		double s = getScore();
+		double deviation = std::sqrt(getScoreVariance(*this) / getGames());
+		return (scoreToElo(s + Z_95 * deviation) - scoreToElo(s - Z_95 * deviation)) / 2.0;
+	}
+
+	/**
+	 * Models the mean score per game as normal with the observed variance,
+	 * as the sequential tests used to tune chess engines do. Draws narrow the
+	 * variance and so count as evidence.
+	 */
+	double MatchScore::getLogLikelihoodRatio(double elo0, double elo1) const {
+		if(getGames() == 0)
+			return 0.0;
+
+		double variance = getScoreVariance(*this);
+		if(variance <= 0.0)
+			return 0.0;
+
+		double s0 = eloToScore(elo0);
+		double s1 = eloToScore(elo1);
+		return (s1 - s0) * (2.0 * getScore() - s0 - s1) * getGames() / (2.0 * variance);
+	}
+
+	double SprtSettings::getLowerBound() const {
+		return std::log(this->beta / (1.0 - this->alpha));
+	}
+
+	double SprtSettings::getUpperBound() const {
+		return std::log((1.0 - this->beta) / this->alpha);
+	}
+
+	TournamentSettings::TournamentSettings()
+		: hashMegabytes(16), maxGames(1000), numThreads(boost::thread::hardware_concurrency()),
+		openingMoves(3), seed(1), reportInterval(100) {
+		this->players[0] = ComputerPlayer::getSettings(MEDIUM);
+		this->players[1] = ComputerPlayer::getSettings(MEDIUM);
+	}
+
+	Tournament::Tournament(const TournamentSettings &settings)
+		: settings(settings), nextGame(0), stopped(false), sprtResult(SPRT_CONTINUE), log(NULL) {
+		if(this->settings.numThreads == 0)
+			this->settings.numThreads = 1;
+		if(this->settings.openingMoves == 0)
+			this->settings.openingMoves = 1;
+		if(this->settings.openingMoves > Position::NUM_SQUARES - 1)
+			this->settings.openingMoves = Position::NUM_SQUARES - 1;
+	}
+
+	/**
+	 * Every thread, including the calling one, takes the next unplayed game
+	 * until none are left or the test has decided.
+	 */
+	MatchScore Tournament::run(std::ostream *log) {
+		this->log = log;
+		this->nextGame.store(0);
+		this->stopped.store(false);
+		this->score = MatchScore();
+		this->sprtResult = SPRT_CONTINUE;
+
+		boost::thread_group threads;
+		for(unsigned int i = 1; i < this->settings.numThreads; i++) {
+			threads.create_thread(boost::bind(&Tournament::runWorker, this));
+		}
+		runWorker();
+		threads.join_all();
+
+		boost::mutex::scoped_lock lock(this->mutex);
+		if(this->log != NULL) {
+			if(this->settings.reportInterval == 0 || this->score.getGames() % this->settings.reportInterval != 0)
+				report();
+			if(this->sprtResult == SPRT_ACCEPT_H0)
+				*this->log << "H0 accepted: elo <= " << this->settings.sprt.elo0 << std::endl;
+			else if(this->sprtResult == SPRT_ACCEPT_H1)
+				*this->log << "H1 accepted: elo >= " << this->settings.sprt.elo1 << std::endl;
+		}
+		return this->score;
+	}
+
+	void Tournament::stop() {
+		this->stopped.store(true);
+	}
+
+	/**
+	 * Plays random moves, never one that completes a line, and keeps the
+	 * result only if a shallow search from it finds no forced win. When no
+	 * attempt at the set length succeeds, each shorter length is tried in
+	 * turn; a single piece given is always undecided.
+	 *
+	 * @param pair The index of the pair of games the opening is for
+	 */
+	GameRecord Tournament::createOpening(unsigned int pair) const {
+		mt19937 random(this->settings.seed * 2654435761u + pair);
+		TranspositionTable table(1);
+		Search search(table);
+		SearchLimits limits;
+		limits.depth = OPENING_CHECK_DEPTH;
+
+		for(unsigned int attempt = 0, numMoves = this->settings.openingMoves; ; attempt++) {
+			if(attempt == MAX_OPENING_ATTEMPTS && numMoves > 1) {
+				attempt = 0;
+				numMoves--;
+			}
+
+			GameRecord record;
+			Position position;
+			bool valid = true;
+
+			unsigned int piece = chooseBit(position.getAvailablePieces(), random);
+			position.give(piece);
+			record.appendGive(piece);
+			for(unsigned int i = 1; i < numMoves && valid; i++) {
+				boost::uint16_t safe = 0;
+				for(boost::uint16_t m = (boost::uint16_t)~position.getOccupied(); m != 0; m &= m - 1) {
+					if(!position.isWinningPlacement(lowestBit(m)))
+						safe |= (boost::uint16_t)(1 << lowestBit(m));
+				}
+				if(safe == 0 || countBits((boost::uint16_t)~position.getOccupied()) == 1) {
+					valid = false;
+					break;
+				}
+
+				unsigned int square = chooseBit(safe, random);
+				position.place(square);
+				record.appendPlace(square);
+				piece = chooseBit(position.getAvailablePieces(), random);
+				position.give(piece);
+				record.appendGive(piece);
+			}
+
+			if(!valid)
+				continue;
+
+			int score = search.run(position, limits).score;
+			if(score <= DECISIVE_SCORE && score >= -DECISIVE_SCORE)
+				return record;
+		}
+	}
+
+	void Tournament::runWorker() {
+		TranspositionTable tables[2];
+		tables[0].resize(this->settings.hashMegabytes);
+		tables[1].resize(this->settings.hashMegabytes);
+
+		while(!this->stopped.load()) {
+			unsigned int index = this->nextGame.fetch_add(1);
+			if(index >= this->settings.maxGames)
+				break;
+
+			tables[0].clear();
+			tables[1].clear();
+			addResult(playGame(index, tables));
+		}
+	}
+
+	/**
+	 * @param index The number of the game; games 2n and 2n + 1 share an opening
+	 * @param tables A table for each player
+	 */
+	Tournament::Outcome Tournament::playGame(unsigned int index, TranspositionTable *tables) {
+		Game game;
+		game.replay(createOpening(index / 2));
+
+		bool firstIsPlayer1 = (index % 2 == 0);
+		ComputerPlayer first(tables[0], this->settings.seed + 2 * index);
+		ComputerPlayer second(tables[1], this->settings.seed + 2 * index + 1);
+
+		for(;;) {
+			State state = game.getState();
+			if(state == P1_WIN || state == P2_WIN)
+				return ((state == P1_WIN) == firstIsPlayer1 ? FIRST_PLAYER_WINS : SECOND_PLAYER_WINS);
+			if((state == P1_CHOOSE || state == P2_CHOOSE) && game.getAvailablePieces().empty())
+				return DRAW;
+
+			bool player1ToMove = (state == P1_CHOOSE || state == P1_PLACE);
+			if(player1ToMove == firstIsPlayer1)
+				first.play(game, this->settings.players[0]);
+			else
+				second.play(game, this->settings.players[1]);
+		}
+	}
+
+	void Tournament::addResult(Outcome outcome) {
+		boost::mutex::scoped_lock lock(this->mutex);
+		if(outcome == FIRST_PLAYER_WINS)
+			this->score.wins++;
+		else if(outcome == DRAW)
+			this->score.draws++;
+		else
+			this->score.losses++;
+
+		const SprtSettings &sprt = this->settings.sprt;
+		if(sprt.enabled && this->sprtResult == SPRT_CONTINUE) {
+			double ratio = this->score.getLogLikelihoodRatio(sprt.elo0, sprt.elo1);
+			if(ratio <= sprt.getLowerBound())
+				this->sprtResult = SPRT_ACCEPT_H0;
+			else if(ratio >= sprt.getUpperBound())
+				this->sprtResult = SPRT_ACCEPT_H1;
+			if(this->sprtResult != SPRT_CONTINUE)
+				this->stopped.store(true);
+		}
+
+		if(this->log != NULL && this->settings.reportInterval > 0 && this->score.getGames() % this->settings.reportInterval == 0)
+			report();
+	}
+
+	/**
+	 * Call with the mutex held.
+	 */
+	void Tournament::report() {
+		std::ostream &out = *this->log;
+		std::ios::fmtflags flags = out.flags();
+		out << std::fixed << std::setprecision(1);
+		out << "games " << this->score.getGames() << ": +" << this->score.wins << " =" << this->score.draws << " -" << this->score.losses
+			<< "  elo " << this->score.getElo() << " +/- " << this->score.getEloMargin();
+		const SprtSettings &sprt = this->settings.sprt;
+		if(sprt.enabled) {
+			out << std::setprecision(2) << "  llr " << this->score.getLogLikelihoodRatio(sprt.elo0, sprt.elo1)
+				<< " [" << sprt.getLowerBound() << ", " << sprt.getUpperBound() << "]";
+		}
+		out << std::endl;
+		out.flags(flags);
+	}
+
+}
@@ -0,0 +1,184 @@
+/**
+* @file TranspositionTable.cpp
+*/
+#include "TranspositionTable.hpp"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using boost::interprocess::file_mapping;
+using boost::interprocess::mapped_region;
+using boost::interprocess::read_only;
+using boost::interprocess::copy_on_write;
+
+namespace {
+
+	const char fileMagic[8] = { 'Q', 'U', 'A', 'R', 'T', 'O', 'T', 'T' };
+
+}
+
+namespace quarto {
+
+	TranspositionTable::TranspositionTable(unsigned int megabytes) : slots(NULL), numSlots(0), mask(0) {
+		resize(megabytes);
+	}
+
+	/**
+	 * The slot count is rounded down to a power of two. Existing entries are discarded.
+	 *
+	 * @param megabytes The largest amount of memory the table may use
+	 */
+	void TranspositionTable::resize(unsigned int megabytes) {
+		std::size_t bytes = (std::size_t)megabytes * 1024 * 1024;
+		std::size_t numSlots = 1;
+		while(numSlots * 2 * sizeof(Slot) <= bytes)
+			numSlots *= 2;
+
+		this->mapping.reset();
+		this->storage.assign(numSlots, Slot());
+		this->slots = &this->storage[0];
+		this->numSlots = numSlots;
+		this->mask = numSlots - 1;
+		clear();
+	}
+
+	void TranspositionTable::clear() {
+		for(std::size_t i = 0; i < this->numSlots; i++) {
+			this->slots[i].check = 0;
+			this->slots[i].data = 0;
+		}
+	}
+
+	/**
+	 * @param key The position key
+	 * @param entry Receives the stored entry on a hit
+	 */
+	TranspositionTable::ProbeResult TranspositionTable::probe(boost::uint64_t key, TableEntry &entry) const {
+		const Slot &slot = this->slots[key & this->mask];
+		boost::uint64_t data = slot.data;
+		boost::uint64_t check = slot.check;
+
+		if((check ^ data) == key) {
+			entry = unpack(data);
+			return HIT;
+		}
+
+		return (data == 0 && check == 0 ? MISS : COLLISION);
+	}
+
+	/**
+	 * Entries for other positions are always replaced; an entry for the same
+	 * position is only replaced by one searched at least as deep.
+	 *
+	 * @param key The position key
+	 * @param entry The search result
+	 */
+	void TranspositionTable::store(boost::uint64_t key, const TableEntry &entry) {
+		Slot &slot = this->slots[key & this->mask];
+
+		if((slot.check ^ slot.data) == key && unpack(slot.data).depth > entry.depth)
+			return;
+
+		boost::uint64_t data = pack(entry);
+		slot.data = data;
+		slot.check = key ^ data;
+	}
+
+	/**
+	 * Call this only while no search is using the table.
+	 *
+	 * @param filename The file to write
+	 * @return true if the whole table was written
+	 */
+	bool TranspositionTable::save(const std::string &filename) const {
+		FileHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, fileMagic, sizeof(header.magic));
+		header.version = FILE_VERSION;
+		header.slotSize = sizeof(Slot);
+		header.hashSeed = Position::HASH_SEED;
+		header.numSlots = this->numSlots;
+
+		std::string tempFilename = filename + ".tmp";
+		{
+			std::ofstream out(tempFilename.c_str(), std::ios::binary | std::ios::trunc);
+			out.write((const char *)&header, sizeof(header));
+			out.write((const char *)this->slots, (std::streamsize)(this->numSlots * sizeof(Slot)));
+			out.close();
+			if(!out) {
+				std::remove(tempFilename.c_str());
+				return false;
+			}
+		}
+
+		// The old snapshot stays until the new one replaces it, except on
+		// Windows, which only renames onto a name that is free
+		if(std::rename(tempFilename.c_str(), filename.c_str()) == 0)
+			return true;
+		std::remove(filename.c_str());
+		if(std::rename(tempFilename.c_str(), filename.c_str()) == 0)
+			return true;
+		std::remove(tempFilename.c_str());
+		return false;
+	}
+
+	/**
+	 * The file is mapped copy-on-write, so pages are read on first use and
+	 * later stores never reach the file. The header must match this build's
+	 * format version, slot size and hash seed, and the file must hold exactly
+	 * the number of slots it declares.
+	 *
+	 * @param filename A file written by save()
+	 * @return true if the table now holds the file's contents
+	 */
+	bool TranspositionTable::load(const std::string &filename) {
+		boost::shared_ptr<mapped_region> region;
+		try {
+			file_mapping file(filename.c_str(), read_only);
+			region.reset(new mapped_region(file, copy_on_write));
+		} catch(const boost::interprocess::interprocess_exception &) {
+			return false;
+		}
+
+		if(region->get_size() < sizeof(FileHeader))
+			return false;
+
+		const FileHeader *header = (const FileHeader *)region->get_address();
+		if(std::memcmp(header->magic, fileMagic, sizeof(header->magic)) != 0 ||
+				header->version != FILE_VERSION ||
+				header->slotSize != sizeof(Slot) ||
+				header->hashSeed != Position::HASH_SEED ||
+				header->numSlots == 0 ||
+				(header->numSlots & (header->numSlots - 1)) != 0 ||
+				region->get_size() != sizeof(FileHeader) + header->numSlots * sizeof(Slot))
+			return false;
+
+		this->numSlots = (std::size_t)header->numSlots;
+		this->mask = this->numSlots - 1;
+		this->slots = (Slot *)((char *)region->get_address() + sizeof(FileHeader));
+		this->mapping = region;
+		std::vector<Slot>().swap(this->storage);
+
+		return true;
+	}
+
+	boost::uint64_t TranspositionTable::pack(const TableEntry &entry) {
+		return (boost::uint64_t)(boost::uint16_t)(entry.score + 0x8000)
+			| ((boost::uint64_t)(entry.depth & 0xFF) << 16)
+			| ((boost::uint64_t)entry.bound << 24)
+			| ((boost::uint64_t)entry.move.square << 32)
+			| ((boost::uint64_t)entry.move.piece << 40);
+	}
+
+	TableEntry TranspositionTable::unpack(boost::uint64_t data) {
+		TableEntry entry;
+		entry.score = (int)(data & 0xFFFF) - 0x8000;
+		entry.depth = (unsigned int)(data >> 16) & 0xFF;
+		entry.bound = (Bound)((data >> 24) & 0x3);
+		entry.move = Move((byte)(data >> 32), (byte)(data >> 40));
+		return entry;
+	}
+
+}
@@ -22,6 +22,9 @@ namespace quarto {
 
 		bool placePiece(const Piece &piece, board_index row, board_index col);
 
+		/** @return The description of the piece on the space, or 0x00 if it is empty */
+		inline byte getInfo(board_index row, board_index col) const { return space[row][col]; }
+
 	private:
 
 		board_type space;
@@ -0,0 +1,58 @@
+/**
+ * @file Canonicalizer.hpp
+ */
+#pragma once
+
+#include "Position.hpp"
+#include <vector>
+
+namespace quarto {
+
+	/**
+	 * @brief Maps positions and moves to one representative of their class under the game's symmetries
+	 *
+	 * Quarto has 32 board symmetries that keep every line a line, and 384
+	 * piece symmetries: any permutation of the four attributes combined with
+	 * flipping any of them. The canonical position is the image that sorts
+	 * first by occupied squares, then by the pieces in square order, then by
+	 * the piece in hand.
+	 *
+	 * Equivalent moves from the canonical position are mapped to the least of
+	 * their images under every symmetry of that position, so the same move is
+	 * recorded the same way however the position was reached.
+	 */
+	class Canonicalizer {
+	public:
+
+		static const unsigned int NUM_BOARD_SYMMETRIES = 32;
+		static const unsigned int NUM_PERMUTATIONS = 24;
+
+		Canonicalizer();
+
+		/** @return The canonical form of the position, which later calls map moves to and from */
+		Position canonicalize(const Position &position);
+
+		/** @return A move from the last position, in the canonical frame */
+		Move canonicalizeMove(const Move &move) const;
+
+		/** @return A move from the canonical position, in the frame of the last position */
+		Move restoreMove(const Move &move) const;
+
+	private:
+
+		struct Transform {
+			byte board;
+			byte permutation;
+			byte flips;
+			/** Set when the position has no pieces, so any flips map it to itself */
+			bool anyFlips;
+		};
+
+		/** Every transform that maps the last position to its canonical form */
+		std::vector<Transform> transforms;
+
+		static Move apply(const Transform &transform, const Move &move);
+
+	};
+
+}
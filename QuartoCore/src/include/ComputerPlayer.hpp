@@ -0,0 +1,75 @@
+/**
+ * @file ComputerPlayer.hpp
+ */
+#pragma once
+
+#include "Game.hpp"
+#include "Position.hpp"
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+namespace quarto {
+
+	/**
+	 * @brief The compute budget and error rate of a difficulty level
+	 */
+	struct DifficultySettings {
+		/** The number of placements to look ahead, or 0 for no limit */
+		unsigned int depth;
+		boost::uint64_t nodes;
+		/** The percentage of moves played at random instead of searched */
+		unsigned int blunderPercent;
+	};
+
+	/**
+	 * @brief A move chosen by the computer and the work it took
+	 */
+	struct ComputerMove {
+		Move move;
+		bool blunder;
+		/** The nodes, depth and time spent; all zero for a blunder, which skips the search */
+		SearchResult search;
+	};
+
+	/**
+	 * @brief A computer opponent whose strength and cost follow the game's difficulty
+	 *
+	 * Searches run on the calling thread, so many games can share a thread pool
+	 * without one strong opponent starving the others.
+	 */
+	class ComputerPlayer : boost::noncopyable {
+	public:
+
+		ComputerPlayer(TranspositionTable &table, boost::uint32_t seed = 0);
+
+		static DifficultySettings getSettings(Difficulty difficulty);
+
+		/** Chooses a move for the player to move without changing the game */
+		ComputerMove chooseMove(const Game &game);
+
+		/** Chooses a move in the position at the given level, for callers that keep no Game */
+		ComputerMove chooseMove(const Position &position, Difficulty difficulty);
+
+		/** Chooses a move with settings other than a difficulty level's, such as when tuning them */
+		ComputerMove chooseMove(const Position &position, const DifficultySettings &settings);
+
+		/** Chooses a move and applies it: placing the piece in hand, then choosing one for the opponent */
+		ComputerMove play(Game &game);
+
+		/** Plays a move chosen with the given settings instead of the game's difficulty */
+		ComputerMove play(Game &game, const DifficultySettings &settings);
+
+	private:
+
+		Search search;
+		boost::random::mt19937 random;
+
+		Move chooseRandomMove(const Position &position);
+		unsigned int chooseRandomBit(boost::uint16_t mask);
+
+	};
+
+}
@@ -0,0 +1,84 @@
+/**
+ * @file EngineProtocol.hpp
+ */
+#pragma once
+
+#include "Position.hpp"
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace quarto {
+
+	/**
+	 * @brief A line-based engine protocol in the style of UCI
+	 *
+	 * Commands, one per line:
+	 *   quarto                          identify the engine and its options, ending with "quartook"
+	 *   isready                         answered with "readyok", even while searching
+	 *   newgame                         clear the table and return to the empty board
+	 *   position startpos [moves ...]   set the position, optionally followed by moves
+	 *   position board <board> <hand> [moves ...]
+	 *   give <piece> / place <square>   play half a move
+	 *   go [depth n] [nodes n] [movetime ms] [threads n] [deterministic]
+	 *   stop                            end the search early
+	 *   setoption name <hash|threads> value <n>
+	 *   display                         print the board
+	 *   quit
+	 *
+	 * A search runs in the background and ends with an "info" line and a
+	 * "bestmove" line. Any other command waits for it to finish first. See
+	 * Notation.hpp for how squares, pieces, moves and boards are written.
+	 */
+	class EngineProtocol : boost::noncopyable {
+	public:
+
+		explicit EngineProtocol(std::ostream &out);
+		~EngineProtocol();
+
+		/** Reads and executes commands until "quit" or the end of the input */
+		void run(std::istream &in);
+
+		/** @return false if the command was "quit" */
+		bool execute(const std::string &line);
+
+	private:
+
+		std::ostream &out;
+		boost::mutex outMutex;
+
+		TranspositionTable table;
+		Search search;
+		boost::scoped_ptr<boost::thread> searchThread;
+
+		Position position;
+		bool gameOver;
+		unsigned int threads;
+
+		void identify();
+		void setPosition(std::istringstream &args);
+		void playMoves(std::istringstream &args);
+		void give(std::istringstream &args);
+		void place(std::istringstream &args);
+		void go(std::istringstream &args);
+		void setOption(std::istringstream &args);
+		void display();
+
+		void runSearch(Position root, SearchLimits limits);
+		void stopSearch();
+		void waitForSearch();
+
+		bool play(const Move &move);
+		void send(const std::string &lines);
+		void sendError(const std::string &message);
+
+	};
+
+}
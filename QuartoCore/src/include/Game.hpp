@@ -5,6 +5,7 @@
 
 #include "Piece.hpp"
 #include "Board.hpp"
+#include "GameRecord.hpp"
 #include <vector>
 
 using std::vector;
@@ -13,27 +14,41 @@ namespace quarto {
 
 	enum State { NOT_STARTED, P1_CHOOSE, P2_CHOOSE, P1_PLACE, P2_PLACE, P1_WIN, P2_WIN };
 
+	/** The strength of a computer opponent; see ComputerPlayer for what each level costs */
+	enum Difficulty { EASY, MEDIUM, HARD, EXPERT };
+
 	class Game {
 	public:
 
 		Game();
 		
 		void start();
+		void start(Difficulty difficulty);
 		void choosePiece(const Piece &piece);
 		void placePiece(unsigned int i, unsigned int j);
 		void printStateMessage();
 		void reset();
 
+		/** Resets the game and plays the record; throws if the record is illegal */
+		void replay(const GameRecord &record);
+
 		State getState() const;
 		vector<Piece> getAvailablePieces() const;
 		Piece getChosenPiece() const;
+		const Board &getBoard() const;
+		Difficulty getDifficulty() const;
+
+		/** @return The moves played since the game was reset */
+		const GameRecord &getRecord() const;
 
 	private:
 
 		State state;
+		Difficulty difficulty;
 		Piece chosenPiece;
 		vector<Piece> availablePieces;
 		Board board;
+		GameRecord record;
 
 	};
 
@@ -0,0 +1,110 @@
+/**
+ * @file GameAnnotator.hpp
+ */
+#pragma once
+
+#include "Canonicalizer.hpp"
+#include "GameRecord.hpp"
+#include "Search.hpp"
+#include "TranspositionTable.hpp"
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+#include <string>
+#include <vector>
+
+namespace quarto {
+
+	enum MoveQuality { MOVE_BEST, MOVE_INACCURACY, MOVE_BLUNDER };
+
+	/**
+	 * @brief A move of a game, judged against the best move from the same position
+	 *
+	 * Scores are from the point of view of the player making the move.
+	 */
+	struct AnnotatedMove {
+		Move move;
+		int bestScore;
+		int playedScore;
+		MoveQuality quality;
+	};
+
+	typedef std::vector<AnnotatedMove> GameAnnotation;
+
+	/**
+	 * @brief Judges every move of many games by searching the positions they reach
+	 *
+	 * Games are annotated a batch at a time. The positions of a batch are
+	 * reduced to their canonical form, and only those not searched in an
+	 * earlier batch are searched, spread over a number of threads that share
+	 * one transposition table. Their values are kept for later batches, so
+	 * openings common to many games are searched once.
+	 *
+	 * A move that turns a win into a draw or loss, or a draw into a loss, is
+	 * a blunder; any other move that scores less than the best is an
+	 * inaccuracy. With a depth or node limit, an unproven score is taken as a
+	 * draw.
+	 */
+	class GameAnnotator : boost::noncopyable {
+	public:
+
+		/**
+		 * @param limits The limits of each search; the thread count is ignored
+		 */
+		GameAnnotator(unsigned int numThreads, unsigned int hashMegabytes, const SearchLimits &limits);
+
+		/**
+		 * Annotates each legal game; illegal ones get an empty annotation.
+		 *
+		 * @param annotations Receives one annotation per game, in order
+		 */
+		void annotate(const std::vector<GameRecord> &games, std::vector<GameAnnotation> &annotations);
+
+		/** @return The number of positions scored so far, counting repeats; a game's last is only counted if it was not over */
+		inline boost::uint64_t getNumPositions() const { return numPositions; }
+
+		/** @return The number of distinct positions searched so far */
+		inline boost::uint64_t getNumSearched() const { return numSearched; }
+
+		inline boost::uint64_t getNodes() const { return nodes; }
+
+		/** Writes the game as in GameRecord::toText, marking inaccuracies with "?" and blunders with "??" */
+		static std::string toText(const GameRecord &record, const GameAnnotation &annotation);
+
+	private:
+
+		struct Job {
+			Position position;
+			boost::uint64_t key;
+			int score;
+			boost::uint64_t nodes;
+		};
+
+		unsigned int numThreads;
+		SearchLimits limits;
+		TranspositionTable table;
+		Canonicalizer canonicalizer;
+
+		/** The score of every position searched so far, by canonical key */
+		boost::unordered_map<boost::uint64_t, int> scores;
+
+		std::vector<Job> jobs;
+		boost::atomic<std::size_t> nextJob;
+
+		boost::uint64_t numPositions;
+		boost::uint64_t numSearched;
+		boost::uint64_t nodes;
+
+		/** Adds the position to the batch's jobs unless its score is already known or queued */
+		void queue(const Position &position);
+
+		int getScore(const Position &position);
+
+		/** Searches the queued jobs on every thread */
+		void runJobs();
+		void runWorker();
+
+	};
+
+}
@@ -0,0 +1,136 @@
+/**
+ * @file GameRecord.hpp
+ */
+#pragma once
+
+#include "Position.hpp"
+#include <boost/noncopyable.hpp>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace quarto {
+
+	/**
+	 * @brief The moves of a game, as a list of half-moves
+	 *
+	 * Even half-moves give a piece and odd ones place it, so each half-move
+	 * fits in 4 bits. The binary form is a length byte followed by the
+	 * half-moves packed two to a byte, high nibble first: at most 17 bytes a
+	 * game. The text form is one line of moves written as in Notation.hpp,
+	 * for example "-0 a1f b2-".
+	 */
+	class GameRecord {
+	public:
+
+		static const unsigned int MAX_HALF_MOVES = 2 * Position::NUM_SQUARES;
+
+		/** A game is the first give, then at most one move per square */
+		static const unsigned int MAX_MOVES = 1 + Position::NUM_SQUARES;
+
+		/** The longest text form: the first give, then four characters a move */
+		static const unsigned int MAX_TEXT_SIZE = 2 + 4 * Position::NUM_SQUARES;
+
+		GameRecord();
+
+		void clear();
+
+		inline unsigned int getLength() const { return length; }
+		inline byte getHalfMove(unsigned int index) const { return halfMoves[index]; }
+
+		/** @return true if the half-move at the index places a piece, false if it gives one */
+		static inline bool isPlacement(unsigned int index) { return (index & 1) != 0; }
+
+		/** Appends a half-move giving a piece; false if the record is full or a placement is due */
+		bool appendGive(unsigned int piece);
+
+		/** Appends a half-move placing a piece; false if the record is full or a give is due */
+		bool appendPlace(unsigned int square);
+
+		/** Appends whichever halves of the move are present */
+		bool append(const Move &move);
+
+		/**
+		 * Plays the record from the start of the game.
+		 *
+		 * @param won Set to true if the last placement completes a line
+		 * @return false if a half-move is illegal or follows a win
+		 */
+		bool replay(Position &position, bool &won) const;
+
+		/** Splits the record into moves: the first give, then each placement with the give after it */
+		unsigned int toMoves(Move *moves) const;
+
+		std::string toText() const;
+
+		/** @return The number of characters written, at most MAX_TEXT_SIZE; no line ending is added */
+		unsigned int toText(char *out) const;
+
+		bool fromText(const char *begin, const char *end);
+
+		/** @return The number of bytes written, at most 1 + MAX_HALF_MOVES / 2 */
+		unsigned int toBinary(byte *out) const;
+
+		/** @return The number of bytes read, or 0 if the data is too short or malformed */
+		unsigned int fromBinary(const byte *in, unsigned int size);
+
+	private:
+
+		byte halfMoves[MAX_HALF_MOVES];
+		byte length;
+
+	};
+
+	enum RecordFormat { RECORD_TEXT, RECORD_BINARY };
+
+	/**
+	 * @brief Writes game records to a stream through a buffer
+	 */
+	class GameRecordWriter : boost::noncopyable {
+	public:
+
+		GameRecordWriter(std::ostream &out, RecordFormat format);
+		~GameRecordWriter();
+
+		void write(const GameRecord &record);
+		void flush();
+
+	private:
+
+		std::ostream &out;
+		RecordFormat format;
+		std::vector<char> buffer;
+		std::size_t used;
+
+	};
+
+	/**
+	 * @brief Reads game records from a stream through a buffer
+	 */
+	class GameRecordReader : boost::noncopyable {
+	public:
+
+		GameRecordReader(std::istream &in, RecordFormat format);
+
+		/** @return false at the end of the stream or at a malformed record */
+		bool read(GameRecord &record);
+
+		/** @return true if reading stopped at a malformed record rather than the end of the stream */
+		inline bool hasError() const { return error; }
+
+	private:
+
+		std::istream &in;
+		RecordFormat format;
+		std::vector<char> buffer;
+		std::size_t begin;
+		std::size_t end;
+		bool error;
+
+		/** Moves unread data to the front of the buffer and reads more; false if nothing more arrived */
+		bool fill();
+
+	};
+
+}
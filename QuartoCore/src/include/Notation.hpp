@@ -0,0 +1,41 @@
+/**
+ * @file Notation.hpp
+ */
+#pragma once
+
+#include "Position.hpp"
+#include <string>
+
+namespace quarto {
+
+	/*
+	 * Squares are written as a column letter and a row number, "a1" to "d4",
+	 * and pieces as the hexadecimal digit of their index. A move writes its
+	 * square then its piece, with "-" for a missing half: "-7", "b3c", "d4-".
+	 * A board is sixteen characters in square order, "." for an empty square,
+	 * followed by a space and the piece in hand.
+	 */
+
+	std::string formatSquare(unsigned int square);
+	bool parseSquare(const std::string &text, unsigned int &square);
+
+	std::string formatPiece(unsigned int piece);
+	bool parsePiece(const std::string &text, unsigned int &piece);
+
+	std::string formatMove(const Move &move);
+	bool parseMove(const std::string &text, Move &move);
+
+	std::string formatBoard(const Position &position);
+
+	/** Builds a position from a board and a piece in hand; false if either is malformed or a line is already complete */
+	bool parseBoard(const std::string &board, const std::string &inHand, Position &position);
+
+	/**
+	 * Plays a move if it is legal in the position.
+	 *
+	 * @param won Set to true if the placement completes a line
+	 * @return false, leaving the position unchanged, if the move is illegal
+	 */
+	bool playMove(Position &position, const Move &move, bool &won);
+
+}
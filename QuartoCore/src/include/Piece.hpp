@@ -30,6 +30,13 @@ namespace quarto {
 		inline bool isHollow() const { return (description & HOLLOW) != 0; }
 		inline bool isLight() const { return (description & LIGHT) != 0; }
 
+		/** @return A 4-bit index with one bit per attribute (round, tall, hollow, light) */
+		inline unsigned int getIndex() const {
+			return (isRound() ? 0x1 : 0) | (isTall() ? 0x2 : 0) | (isHollow() ? 0x4 : 0) | (isLight() ? 0x8 : 0);
+		}
+
+		static Piece fromIndex(unsigned int index);
+
 		inline bool operator==(const Piece &piece) const { return description == piece.description; }
 
 	private:
@@ -0,0 +1,119 @@
+/**
+ * @file Position.hpp
+ */
+#pragma once
+
+#include "Piece.hpp"
+#include <boost/cstdint.hpp>
+
+namespace quarto {
+
+	class Game;
+
+	/**
+	 * @brief A placement of the piece in hand followed by a choice of piece for the opponent
+	 *
+	 * Either half may be absent: the first choice of the game has no square, and the
+	 * placement that fills the board has no piece.
+	 */
+	struct Move {
+		static const byte NONE = 0xFF;
+
+		byte square;
+		byte piece;
+
+		Move() : square(NONE), piece(NONE) {}
+		Move(byte square, byte piece) : square(square), piece(piece) {}
+
+		inline bool isNull() const { return square == NONE && piece == NONE; }
+		inline bool operator==(const Move &move) const { return square == move.square && piece == move.piece; }
+		inline bool operator!=(const Move &move) const { return !(*this == move); }
+	};
+
+	/**
+	 * @brief A packed game state used by the search
+	 *
+	 * Squares are numbered row * 4 + column, and pieces are numbered by Piece::getIndex().
+	 * The board holds one 4-bit piece index per square, so the whole state fits in a few
+	 * machine words and can be copied freely while searching.
+	 */
+	class Position {
+	public:
+
+		static const unsigned int NUM_SQUARES = 16;
+		static const unsigned int NUM_PIECES = 16;
+		static const byte NO_PIECE = 0xFF;
+		static const boost::uint64_t HASH_SEED;
+
+		/** Constructs the empty position at the start of the game */
+		Position();
+
+		/** Constructs the position reached by a game in progress */
+		explicit Position(const Game &game);
+
+		/**
+		 * Builds a position from its packed form.
+		 *
+		 * @param board The piece on each occupied square, four bits a square; empty squares are ignored
+		 * @param inHand The piece in hand, or NO_PIECE
+		 * @param won Set to true if the board has a complete line
+		 * @return false, leaving the position unchanged, if a piece is used twice
+		 */
+		static bool fromBoard(boost::uint64_t board, boost::uint16_t occupied, byte inHand, Position &position, bool &won);
+
+		inline boost::uint16_t getOccupied() const { return occupied; }
+		inline boost::uint16_t getAvailablePieces() const { return available; }
+		inline byte getPieceInHand() const { return inHand; }
+		inline boost::uint64_t getKey() const { return key; }
+
+		/** @return The piece on each square, four bits a square, zero where empty */
+		inline boost::uint64_t getBoard() const { return board; }
+		inline bool isOccupied(unsigned int square) const { return (occupied >> square) & 1; }
+		inline bool isFull() const { return occupied == 0xFFFF; }
+		inline unsigned int getPieceAt(unsigned int square) const { return (unsigned int)(board >> (4 * square)) & 0xF; }
+
+		unsigned int getNumPlaced() const;
+
+		/** @return true if placing the piece in hand on the square completes a line */
+		bool isWinningPlacement(unsigned int square) const;
+
+		/** @return A mask of the pieces the next player to place could win with immediately */
+		boost::uint16_t getUnsafePieces() const;
+
+		/** Places the piece in hand, returning true if that wins the game */
+		bool place(unsigned int square);
+
+		/** Hands a piece from the pool to the opponent */
+		void give(unsigned int piece);
+
+	private:
+
+		boost::uint64_t board;
+		boost::uint64_t key;
+		boost::uint16_t occupied;
+		boost::uint16_t available;
+		byte inHand;
+
+		bool isWinningLine(boost::uint16_t line, boost::uint64_t pieces) const;
+
+	};
+
+	/** @return The number of set bits in a 16-bit mask */
+	inline unsigned int countBits(boost::uint16_t mask) {
+		unsigned int count = 0;
+		for(; mask != 0; mask &= mask - 1)
+			count++;
+		return count;
+	}
+
+	/** @return The index of the lowest set bit in a non-empty 16-bit mask */
+	inline unsigned int lowestBit(boost::uint16_t mask) {
+		unsigned int index = 0;
+		while((mask & 1) == 0) {
+			mask >>= 1;
+			index++;
+		}
+		return index;
+	}
+
+}
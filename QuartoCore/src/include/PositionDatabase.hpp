@@ -0,0 +1,143 @@
+/**
+ * @file PositionDatabase.hpp
+ */
+#pragma once
+
+#include "Canonicalizer.hpp"
+#include "GameRecord.hpp"
+#include "Position.hpp"
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace boost { namespace interprocess { class mapped_region; } }
+
+namespace quarto {
+
+	/**
+	 * @brief How often a move was played from a position, and how those games ended
+	 *
+	 * Wins and losses are from the point of view of the player making the move.
+	 * A null move counts the games that ended in the position.
+	 */
+	struct MoveStats {
+		Move move;
+		boost::uint32_t games;
+		boost::uint32_t wins;
+		boost::uint32_t losses;
+	};
+
+	struct PositionStats {
+		PositionStats() : games(0) {}
+
+		/** The number of games in which the position occurred */
+		boost::uint64_t games;
+		/** Most played first; symmetric moves are merged into one of them */
+		std::vector<MoveStats> moves;
+	};
+
+	/**
+	 * @brief One entry of the index: a canonical position key and a canonical move
+	 */
+	struct IndexEntry {
+		boost::uint64_t key;
+		byte square;
+		byte piece;
+		byte reserved[2];
+		boost::uint32_t games;
+		boost::uint32_t wins;
+		boost::uint32_t losses;
+
+		inline bool operator<(const IndexEntry &entry) const {
+			return key < entry.key || (key == entry.key && (square < entry.square || (square == entry.square && piece < entry.piece)));
+		}
+		inline bool isSameMove(const IndexEntry &entry) const {
+			return key == entry.key && square == entry.square && piece == entry.piece;
+		}
+	};
+
+	/**
+	 * @brief Collects the positions and moves of game records in memory
+	 */
+	class PositionIndexBuilder : boost::noncopyable {
+	public:
+
+		/** Adds every position of the game and the move played from it; false if the record is illegal */
+		bool add(const GameRecord &record);
+
+		inline std::size_t getNumEntries() const { return entries.size(); }
+
+		/** Sorts the entries and merges those for the same position and move */
+		void sort();
+
+		void clear();
+
+		inline const std::vector<IndexEntry> &getEntries() const { return entries; }
+
+	private:
+
+		Canonicalizer canonicalizer;
+		std::vector<IndexEntry> entries;
+
+	};
+
+	/**
+	 * @brief An on-disk index from canonical positions to the moves played from them
+	 *
+	 * The database is a series of numbered segment files, <path>.0, <path>.1
+	 * and so on, each a header followed by entries sorted by key, and a
+	 * manifest, <path>.manifest, listing the segments in use. Segments are
+	 * memory mapped and searched by bisection, so a lookup reads a few pages
+	 * of each. New games are appended as a new segment; compact() merges the
+	 * segments into one when there are too many. A segment only counts once
+	 * the manifest names it, so an interrupted append or compaction leaves
+	 * the database as it was before or after, never in between.
+	 */
+	class PositionDatabase : boost::noncopyable {
+	public:
+
+		PositionDatabase() : nextNumber(0) {}
+
+		/** Maps the existing segments of the database at the path, if any */
+		bool open(const std::string &path);
+
+		/** Writes the builder's entries as a new segment */
+		bool append(PositionIndexBuilder &builder);
+
+		/** Merges every segment into a new one that replaces them */
+		bool compact();
+
+		/** @return The statistics of the position, with moves in its own frame */
+		PositionStats lookup(const Position &position) const;
+
+		inline std::size_t getNumSegments() const { return segments.size(); }
+		std::size_t getNumEntries() const;
+
+	private:
+
+		struct Segment {
+			boost::shared_ptr<boost::interprocess::mapped_region> region;
+			const IndexEntry *entries;
+			std::size_t numEntries;
+			std::size_t number;
+		};
+
+		std::string path;
+		std::vector<Segment> segments;
+		/** The number the next segment written is given; above every number in use */
+		std::size_t nextNumber;
+
+		std::string getSegmentPath(std::size_t number) const;
+		std::string getManifestPath() const;
+
+		/** Replaces the manifest with one listing the mapped segments */
+		bool writeManifest() const;
+
+		/** Maps a segment file; false if it is missing or not a valid segment */
+		bool mapSegment(std::size_t number);
+
+	};
+
+}
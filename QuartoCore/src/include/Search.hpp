@@ -0,0 +1,132 @@
+/**
+ * @file Search.hpp
+ */
+#pragma once
+
+#include "Position.hpp"
+#include "SearchStats.hpp"
+#include "TranspositionTable.hpp"
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <ostream>
+#include <vector>
+
+namespace quarto {
+
+	class SearchWorker;
+
+	/** Score of a win on the current placement; wins further away score one less per placement */
+	const int WIN_SCORE = 1000;
+
+	/** Scores beyond this magnitude are proven wins or losses */
+	const int DECISIVE_SCORE = WIN_SCORE - (int)Position::NUM_SQUARES - 1;
+
+	/**
+	 * @brief Limits on a single search; zero means unlimited
+	 */
+	struct SearchLimits {
+		SearchLimits() : depth(0), nodes(0), milliseconds(0), threads(1), deterministic(false) {}
+
+		/** The number of placements to look ahead */
+		unsigned int depth;
+		boost::uint64_t nodes;
+		unsigned int milliseconds;
+		unsigned int threads;
+
+		/**
+		 * Makes the move, score and node count depend only on the position and
+		 * the thread count. The time limit is ignored, and the node limit is
+		 * only checked between iterations.
+		 */
+		bool deterministic;
+	};
+
+	/**
+	 * @brief The outcome of a search, from the point of view of the player to move
+	 */
+	struct SearchResult {
+		SearchResult() : score(0), depth(0), nodes(0), seconds(0.0) {}
+
+		Move move;
+		int score;
+		unsigned int depth;
+		boost::uint64_t nodes;
+		double seconds;
+	};
+
+	/**
+	 * @brief An iterative-deepening alpha-beta search over Position
+	 *
+	 * With more than one thread, every thread searches the same root and they
+	 * share work through the transposition table; the first thread's result is
+	 * reported.
+	 *
+	 * In deterministic mode the root moves are instead dealt out to the threads
+	 * in a fixed order, each thread searches with a private table that starts
+	 * empty, and the threads meet after every iteration to combine results.
+	 */
+	class Search : boost::noncopyable {
+	public:
+
+		explicit Search(TranspositionTable &table);
+		~Search();
+
+		/** Searches the position, blocking until a limit is reached or stop() is called */
+		SearchResult run(const Position &root, const SearchLimits &limits);
+
+		/** Ends the running search as soon as possible; safe to call from any thread */
+		void stop();
+
+		/** @return The statistics of the running or most recent search */
+		SearchStatsSnapshot getStats() const;
+
+		/** Sets a stream to write the statistics of each search to when it ends, or NULL */
+		void setStatsLog(std::ostream *log);
+
+		/** Sets the memory all private tables of a deterministic search share; zero means the size of the shared table */
+		void setPrivateTableMegabytes(unsigned int megabytes);
+
+	private:
+
+		friend class SearchWorker;
+
+		struct RootMove {
+			Move move;
+			bool losing;
+			int score;
+
+			/** Orders root moves best first */
+			static inline bool isBetter(const RootMove &a, const RootMove &b) { return a.score > b.score; }
+		};
+
+		TranspositionTable &table;
+		Position root;
+		SearchLimits limits;
+		boost::atomic<bool> stopped;
+		boost::atomic<bool> running;
+		boost::posix_time::ptime startTime;
+		boost::posix_time::ptime stopTime;
+		std::ostream *statsLog;
+
+		mutable boost::mutex workersMutex;
+		std::vector<boost::shared_ptr<SearchWorker> > workers;
+
+		/** The root moves of a deterministic search, best first after each iteration */
+		std::vector<RootMove> rootMoves;
+		std::vector<boost::shared_ptr<TranspositionTable> > privateTables;
+		unsigned int privateMegabytes;
+
+		void runShared();
+		void runDeterministic();
+		unsigned int getMaxDepth() const;
+		boost::uint64_t getNodes() const;
+		double getElapsedSeconds() const;
+		bool isOverBudget() const;
+
+	};
+
+}
@@ -0,0 +1,131 @@
+/**
+ * @file SearchStats.hpp
+ */
+#pragma once
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <ostream>
+#include <vector>
+
+/**
+ * Search instrumentation is collected in debug builds and compiled out of
+ * release builds. Define QUARTO_SEARCH_STATS to 0 or 1 to override.
+ */
+#ifndef QUARTO_SEARCH_STATS
+#ifdef NDEBUG
+#define QUARTO_SEARCH_STATS 0
+#else
+#define QUARTO_SEARCH_STATS 1
+#endif
+#endif
+
+#if QUARTO_SEARCH_STATS
+#define QUARTO_STAT(statement) statement
+#else
+#define QUARTO_STAT(statement)
+#endif
+
+namespace quarto {
+
+	/**
+	 * @brief A counter written by one search thread and read by any other
+	 */
+	class StatCounter : boost::noncopyable {
+	public:
+
+		StatCounter() : value(0) {}
+
+		inline void add(boost::uint64_t n) { value.store(value.load(boost::memory_order_relaxed) + n, boost::memory_order_relaxed); }
+		inline void increment() { add(1); }
+		inline void clear() { value.store(0, boost::memory_order_relaxed); }
+		inline boost::uint64_t get() const { return value.load(boost::memory_order_relaxed); }
+
+	private:
+
+		boost::atomic<boost::uint64_t> value;
+
+	};
+
+	/**
+	 * @brief Totals across all search threads, safe to take while a search is running
+	 */
+	struct SearchStatsSnapshot {
+		static const unsigned int MAX_PLY = 16;
+		static const unsigned int MAX_MOVE_INDEX = 16;
+
+		SearchStatsSnapshot();
+
+		bool enabled;
+		double seconds;
+		boost::uint64_t nodes;
+		boost::uint64_t cutoffs;
+		boost::uint64_t tableProbes;
+		boost::uint64_t tableHits;
+		boost::uint64_t tableStores;
+		boost::uint64_t tableCollisions;
+		boost::uint64_t nodesAtPly[MAX_PLY];
+		boost::uint64_t cutoffsAtPly[MAX_PLY];
+		boost::uint64_t cutoffsAtMoveIndex[MAX_MOVE_INDEX];
+		std::vector<boost::uint64_t> threadNodes;
+
+		double getNodesPerSecond() const;
+		double getTableHitRate() const;
+		double getFirstMoveCutoffRate() const;
+
+		void writeJson(std::ostream &out) const;
+	};
+
+	/**
+	 * @brief The counters owned by a single search thread
+	 *
+	 * Only the owning thread writes to the counters, so updates need no
+	 * read-modify-write instructions.
+	 */
+	class SearchStats : boost::noncopyable {
+	public:
+
+		static const unsigned int MAX_PLY = SearchStatsSnapshot::MAX_PLY;
+		static const unsigned int MAX_MOVE_INDEX = SearchStatsSnapshot::MAX_MOVE_INDEX;
+
+		void clear();
+
+		inline void countNode(unsigned int ply) {
+			nodes.increment();
+			nodesAtPly[ply < MAX_PLY ? ply : MAX_PLY - 1].increment();
+		}
+
+		/** Records a beta cutoff caused by the move searched at the given index */
+		inline void countCutoff(unsigned int ply, unsigned int moveIndex) {
+			cutoffsAtPly[ply < MAX_PLY ? ply : MAX_PLY - 1].increment();
+			cutoffsAtMoveIndex[moveIndex < MAX_MOVE_INDEX ? moveIndex : MAX_MOVE_INDEX - 1].increment();
+		}
+
+		inline void countTableProbe(bool hit, bool collision) {
+			tableProbes.increment();
+			if(hit)
+				tableHits.increment();
+			if(collision)
+				tableCollisions.increment();
+		}
+
+		inline void countTableStore() { tableStores.increment(); }
+
+		/** Adds this thread's counters to the snapshot */
+		void addTo(SearchStatsSnapshot &snapshot) const;
+
+	private:
+
+		StatCounter nodes;
+		StatCounter tableProbes;
+		StatCounter tableHits;
+		StatCounter tableStores;
+		StatCounter tableCollisions;
+		StatCounter nodesAtPly[MAX_PLY];
+		StatCounter cutoffsAtPly[MAX_PLY];
+		StatCounter cutoffsAtMoveIndex[MAX_MOVE_INDEX];
+
+	};
+
+}
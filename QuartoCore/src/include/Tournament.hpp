@@ -0,0 +1,135 @@
+/**
+ * @file Tournament.hpp
+ */
+#pragma once
+
+#include "ComputerPlayer.hpp"
+#include "GameRecord.hpp"
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <ostream>
+
+namespace quarto {
+
+	/**
+	 * @brief The results of one player against another, and what they say about the difference in strength
+	 */
+	struct MatchScore {
+		MatchScore() : wins(0), draws(0), losses(0) {}
+
+		unsigned int wins;
+		unsigned int draws;
+		unsigned int losses;
+
+		inline unsigned int getGames() const { return wins + draws + losses; }
+
+		/** @return The points scored per game, counting a draw as half a win */
+		double getScore() const;
+
+		/** @return The Elo difference the score implies */
+		double getElo() const;
+
+		/** @return The half-width of the 95% confidence interval of getElo() */
+		double getEloMargin() const;
+
+		/**
+		 * @return The log-likelihood ratio of the Elo difference being elo1
+		 * rather than elo0, by the normal approximation to the score
+		 */
+		double getLogLikelihoodRatio(double elo0, double elo1) const;
+	};
+
+	/**
+	 * @brief A sequential probability ratio test between two Elo differences
+	 */
+	struct SprtSettings {
+		SprtSettings() : enabled(false), elo0(0.0), elo1(10.0), alpha(0.05), beta(0.05) {}
+
+		bool enabled;
+		double elo0;
+		double elo1;
+		/** The chance of accepting elo1 when elo0 holds */
+		double alpha;
+		/** The chance of accepting elo0 when elo1 holds */
+		double beta;
+
+		/** The log-likelihood ratio below which elo0 is accepted */
+		double getLowerBound() const;
+		/** The log-likelihood ratio above which elo1 is accepted */
+		double getUpperBound() const;
+	};
+
+	enum SprtResult { SPRT_CONTINUE, SPRT_ACCEPT_H0, SPRT_ACCEPT_H1 };
+
+	struct TournamentSettings {
+		TournamentSettings();
+
+		/** The player being tested, then the baseline */
+		DifficultySettings players[2];
+		unsigned int hashMegabytes;
+		unsigned int maxGames;
+		unsigned int numThreads;
+		/** The number of random moves in each opening, at most one less than the number of squares */
+		unsigned int openingMoves;
+		boost::uint32_t seed;
+		SprtSettings sprt;
+		/** Progress is written after this many games */
+		unsigned int reportInterval;
+	};
+
+	/**
+	 * @brief Plays two computer players against each other until the difference between them is clear
+	 *
+	 * Games are played in pairs from the same opening, each player moving
+	 * first once, so an opening that favors one side favors both players
+	 * equally. Openings are a few random moves that a shallow search finds
+	 * undecided. Every thread plays whole games with its own tables, which
+	 * are cleared before each game, so results do not depend on scheduling.
+	 */
+	class Tournament : boost::noncopyable {
+	public:
+
+		explicit Tournament(const TournamentSettings &settings);
+
+		/**
+		 * Plays until the game limit is reached, the test decides, or stop() is called.
+		 *
+		 * @param log Receives progress and a summary, or NULL
+		 * @return The score of the first player against the second
+		 */
+		MatchScore run(std::ostream *log);
+
+		/** Lets the games in progress finish and starts no more; safe to call from any thread */
+		void stop();
+
+		inline SprtResult getSprtResult() const { return sprtResult; }
+
+		/** @return The opening of a pair of games; the same for any run with the same seed */
+		GameRecord createOpening(unsigned int pair) const;
+
+	private:
+
+		enum Outcome { FIRST_PLAYER_WINS, DRAW, SECOND_PLAYER_WINS };
+
+		TournamentSettings settings;
+		boost::atomic<unsigned int> nextGame;
+		boost::atomic<bool> stopped;
+
+		boost::mutex mutex;
+		MatchScore score;
+		SprtResult sprtResult;
+		std::ostream *log;
+
+		void runWorker();
+
+		/** Plays one game; the first player moves first in even games */
+		Outcome playGame(unsigned int index, TranspositionTable *tables);
+
+		void addResult(Outcome outcome);
+		void report();
+
+	};
+
+}
@@ -0,0 +1,97 @@
+/**
+ * @file TranspositionTable.hpp
+ */
+#pragma once
+
+#include "Position.hpp"
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+namespace boost { namespace interprocess { class mapped_region; } }
+
+namespace quarto {
+
+	enum Bound { BOUND_NONE = 0, BOUND_UPPER = 1, BOUND_LOWER = 2, BOUND_EXACT = 3 };
+
+	/**
+	 * @brief A search result remembered for a position
+	 */
+	struct TableEntry {
+		Move move;
+		int score;
+		unsigned int depth;
+		Bound bound;
+	};
+
+	/**
+	 * @brief A fixed-size hash table of search results shared by all search threads
+	 *
+	 * Each slot stores its packed entry alongside the entry XORed with the
+	 * position key, so a slot torn by concurrent writers reads as a miss
+	 * instead of returning a corrupt entry. No locks are taken.
+	 *
+	 * The table can be saved to a file and memory-mapped back in, so a new
+	 * process starts with everything an earlier one learned.
+	 */
+	class TranspositionTable : boost::noncopyable {
+	public:
+
+		enum ProbeResult { MISS, HIT, COLLISION };
+
+		/** Constructs a table that uses at most the given number of megabytes */
+		explicit TranspositionTable(unsigned int megabytes = 16);
+
+		void resize(unsigned int megabytes);
+		void clear();
+
+		/** @return HIT and fills the entry if the key is present; COLLISION if its slot holds another position */
+		ProbeResult probe(boost::uint64_t key, TableEntry &entry) const;
+
+		void store(boost::uint64_t key, const TableEntry &entry);
+
+		inline std::size_t getNumSlots() const { return numSlots; }
+		inline unsigned int getMegabytes() const { return (unsigned int)((numSlots * sizeof(Slot)) >> 20); }
+
+		/** Writes the table to a file, replacing it only once the write has succeeded */
+		bool save(const std::string &filename) const;
+
+		/** Maps a saved table into memory, leaving this table unchanged if the file is not valid */
+		bool load(const std::string &filename);
+
+	private:
+
+		static const boost::uint32_t FILE_VERSION = 1;
+
+		struct Slot {
+			boost::uint64_t check;
+			boost::uint64_t data;
+		};
+
+		struct FileHeader {
+			char magic[8];
+			boost::uint32_t version;
+			boost::uint32_t slotSize;
+			boost::uint64_t hashSeed;
+			boost::uint64_t numSlots;
+			char reserved[32];
+		};
+
+		Slot *slots;
+		std::size_t numSlots;
+		std::size_t mask;
+
+		/** Storage for a table built in memory */
+		std::vector<Slot> storage;
+
+		/** Storage for a table loaded from a file, mapped copy-on-write */
+		boost::shared_ptr<boost::interprocess::mapped_region> mapping;
+
+		static boost::uint64_t pack(const TableEntry &entry);
+		static TableEntry unpack(boost::uint64_t data);
+
+	};
+
+}
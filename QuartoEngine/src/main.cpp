@@ -0,0 +1,18 @@
+/**
+* @file main.cpp
+*/
+#include "EngineProtocol.hpp"
+#include <iostream>
+
+using quarto::EngineProtocol;
+
+/** Entry point for the headless engine; speaks EngineProtocol over stdin and stdout */
+int main() {
+	std::ios::sync_with_stdio(false);
+	std::cin.tie(NULL);
+
+	EngineProtocol protocol(std::cout);
+	protocol.run(std::cin);
+
+	return 0;
+}
@@ -0,0 +1,608 @@
+/**
+* @file GameServer.cpp
+*/
+#include "GameServer.hpp"
+#include "Notation.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+	using namespace quarto;
+
+	const int MAX_EVENTS = 64;
+
+	/** A client that stops reading is dropped once this much output is waiting for it */
+	const std::size_t MAX_OUTPUT = 1 << 20;
+
+	const char *difficultyNames[] = { "easy", "medium", "hard", "expert" };
+
+	/** How long restored games wait for their clients to resume them */
+	const std::time_t RESUME_SECONDS = 300;
+
+	/** @return Eight bytes from the kernel's random source, mixed with the time in case it is unavailable */
+	boost::uint64_t readSeed() {
+		boost::uint64_t seed = (boost::uint64_t)std::time(NULL);
+		int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+		if(fd >= 0) {
+			boost::uint64_t bytes = 0;
+			if(::read(fd, &bytes, sizeof(bytes)) == (ssize_t)sizeof(bytes))
+				seed ^= bytes;
+			::close(fd);
+		}
+		return seed;
+	}
+
+	/** Parses a key as written by the new command: the session id then the token, each 16 hexadecimal digits */
+	bool parseKey(const char *text, SessionId &id, boost::uint64_t &token) {
+		if(std::strlen(text) != 32)
+			return false;
+
+		boost::uint64_t values[2] = { 0, 0 };
+		for(unsigned int i = 0; i < 32; i++) {
+			char c = text[i];
+			unsigned int digit;
+			if(c >= '0' && c <= '9')
+				digit = (unsigned int)(c - '0');
+			else if(c >= 'a' && c <= 'f')
+				digit = (unsigned int)(c - 'a' + 10);
+			else
+				return false;
+			values[i / 16] = (values[i / 16] << 4) | digit;
+		}
+		id = values[0];
+		token = values[1];
+		return true;
+	}
+
+	/** @return The connection's lowest unused game number, or MAX_GAMES if it has none left */
+	unsigned int findFreeGame(const Connection &connection) {
+		unsigned int game = 0;
+		while(game < Connection::MAX_GAMES && connection.games[game] != SessionStore::NO_SESSION)
+			game++;
+		return game;
+	}
+
+	/**
+	 * Splits a line into words in place.
+	 *
+	 * @return The number of words found, at most maxWords
+	 */
+	unsigned int splitWords(char *line, char **words, unsigned int maxWords) {
+		unsigned int count = 0;
+		char *c = line;
+		while(count < maxWords) {
+			while(*c == ' ' || *c == '\t')
+				c++;
+			if(*c == '\0')
+				break;
+			words[count++] = c;
+			while(*c != '\0' && *c != ' ' && *c != '\t')
+				c++;
+			if(*c != '\0')
+				*c++ = '\0';
+		}
+		return count;
+	}
+
+	const char *describeOutcome(const Session &session, bool won) {
+		if(won)
+			return " won";
+		if(session.gameOver)
+			return " draw";
+		return "";
+	}
+
+	void printError(const char *what) {
+		std::cerr << "quarto-server: " << what << ": " << std::strerror(errno) << std::endl;
+	}
+
+}
+
+namespace quarto {
+
+	GameServer::GameServer(unsigned int numWorkers, unsigned int hashMegabytes, unsigned int maxSessions)
+		: listenFd(-1), epollFd(-1), wakeFd(-1), timerFd(-1), stopping(false), sessions(maxSessions), table(hashMegabytes), nextSerial(1),
+		snapshotSeconds(0), resumeDeadline(0), random(readSeed()) {
+		this->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		this->workers.reset(new WorkerPool(numWorkers > 0 ? numWorkers : 1, this->table, this->wakeFd));
+	}
+
+	GameServer::~GameServer() {
+		// The workers write to the eventfd, so they go first
+		this->workers.reset();
+
+		for(std::size_t fd = 0; fd < this->connections.size(); fd++) {
+			if(this->connections[fd])
+				::close((int)fd);
+		}
+		if(this->listenFd >= 0) {
+			::close(this->listenFd);
+			unlink(this->socketPath.c_str());
+		}
+		if(this->epollFd >= 0)
+			::close(this->epollFd);
+		if(this->wakeFd >= 0)
+			::close(this->wakeFd);
+		if(this->timerFd >= 0)
+			::close(this->timerFd);
+	}
+
+	/**
+	 * @param path The snapshot file; a missing file is an empty snapshot
+	 * @param seconds The time between snapshots
+	 */
+	void GameServer::enableSnapshots(const std::string &path, unsigned int seconds) {
+		this->snapshot.reset(new SessionSnapshot(path));
+		this->snapshotSeconds = (seconds > 0 ? seconds : 1);
+
+		if(this->snapshot->restore(this->sessions)) {
+			std::cerr << "quarto-server: restored " << this->sessions.getNumSessions() << " games from " << path << std::endl;
+		} else if(this->sessions.getNumSessions() > 0) {
+			std::cerr << "quarto-server: snapshot " << path << " is damaged; restored "
+				<< this->sessions.getNumSessions() << " games" << std::endl;
+		}
+		if(this->sessions.getNumSessions() > 0)
+			this->resumeDeadline = std::time(NULL) + RESUME_SECONDS;
+	}
+
+	/**
+	 * @param path The filesystem path of the socket
+	 */
+	bool GameServer::listen(const std::string &path) {
+		sockaddr_un address;
+		std::memset(&address, 0, sizeof(address));
+		if(path.size() >= sizeof(address.sun_path)) {
+			std::cerr << "quarto-server: socket path is too long: " << path << std::endl;
+			return false;
+		}
+		address.sun_family = AF_UNIX;
+		std::strcpy(address.sun_path, path.c_str());
+
+		if(this->wakeFd < 0) {
+			printError("eventfd");
+			return false;
+		}
+
+		this->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if(this->listenFd < 0) {
+			printError("socket");
+			return false;
+		}
+
+		unlink(path.c_str());
+		if(bind(this->listenFd, (sockaddr *)&address, sizeof(address)) < 0 || ::listen(this->listenFd, SOMAXCONN) < 0) {
+			printError(path.c_str());
+			return false;
+		}
+		this->socketPath = path;
+
+		this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+		if(this->epollFd < 0) {
+			printError("epoll_create1");
+			return false;
+		}
+
+		epoll_event event;
+		std::memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN;
+		event.data.fd = this->listenFd;
+		epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->listenFd, &event);
+		event.data.fd = this->wakeFd;
+		epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->wakeFd, &event);
+
+		if(this->snapshot) {
+			this->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+			if(this->timerFd < 0) {
+				printError("timerfd_create");
+				return false;
+			}
+			itimerspec interval;
+			std::memset(&interval, 0, sizeof(interval));
+			interval.it_interval.tv_sec = (time_t)this->snapshotSeconds;
+			interval.it_value.tv_sec = (time_t)this->snapshotSeconds;
+			timerfd_settime(this->timerFd, 0, &interval, NULL);
+			event.data.fd = this->timerFd;
+			epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->timerFd, &event);
+		}
+
+		return true;
+	}
+
+	void GameServer::run() {
+		epoll_event events[MAX_EVENTS];
+
+		while(!this->stopping) {
+			int numEvents = epoll_wait(this->epollFd, events, MAX_EVENTS, -1);
+			if(numEvents < 0) {
+				if(errno == EINTR)
+					continue;
+				printError("epoll_wait");
+				break;
+			}
+
+			for(int i = 0; i < numEvents; i++) {
+				int fd = events[i].data.fd;
+				if(fd == this->listenFd) {
+					accept();
+				} else if(fd == this->wakeFd) {
+					deliverResults();
+				} else if(fd == this->timerFd) {
+					tick();
+				} else if((std::size_t)fd < this->connections.size() && this->connections[fd]) {
+					// Hold a reference, since reading may close the connection
+					boost::shared_ptr<Connection> connection = this->connections[fd];
+					if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+						read(*connection);
+					if(connection->fd >= 0 && (events[i].events & EPOLLOUT))
+						write(*connection);
+				}
+			}
+		}
+
+		if(this->snapshot)
+			this->snapshot->write(this->sessions);
+	}
+
+	void GameServer::stop() {
+		this->stopping = true;
+		boost::uint64_t one = 1;
+		ssize_t written = ::write(this->wakeFd, &one, sizeof(one));
+		(void)written;
+	}
+
+	/**
+	 * Every token is drawn from the kernel, so tokens a client has seen tell
+	 * it nothing about the next. The seeded generator is only used if the
+	 * kernel cannot supply the bytes.
+	 */
+	boost::uint64_t GameServer::newToken() {
+		boost::uint64_t token;
+		ssize_t got;
+		do {
+			got = getrandom(&token, sizeof(token), 0);
+		} while(got < 0 && errno == EINTR);
+		if(got == (ssize_t)sizeof(token))
+			return token;
+		return this->random();
+	}
+
+	void GameServer::accept() {
+		for(;;) {
+			int fd = accept4(this->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if(fd < 0) {
+				if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+					printError("accept");
+				return;
+			}
+
+			boost::shared_ptr<Connection> connection(new Connection());
+			connection->fd = fd;
+			connection->serial = this->nextSerial++;
+			connection->inputLength = 0;
+			connection->output.reserve(Connection::INPUT_SIZE);
+			connection->outputSent = 0;
+			connection->waitingToWrite = false;
+			for(unsigned int game = 0; game < Connection::MAX_GAMES; game++) {
+				connection->games[game] = SessionStore::NO_SESSION;
+			}
+
+			if((std::size_t)fd >= this->connections.size())
+				this->connections.resize(fd + 1);
+			this->connections[fd] = connection;
+
+			epoll_event event;
+			std::memset(&event, 0, sizeof(event));
+			event.events = EPOLLIN;
+			event.data.fd = fd;
+			epoll_ctl(this->epollFd, EPOLL_CTL_ADD, fd, &event);
+		}
+	}
+
+	/**
+	 * Reads what the client has sent and executes every complete line, then
+	 * writes the replies.
+	 */
+	void GameServer::read(Connection &connection) {
+		for(;;) {
+			ssize_t received = ::read(connection.fd, connection.input + connection.inputLength, Connection::INPUT_SIZE - connection.inputLength);
+			if(received == 0) {
+				close(connection);
+				return;
+			}
+			if(received < 0) {
+				if(errno == EINTR)
+					continue;
+				if(errno == EAGAIN || errno == EWOULDBLOCK)
+					break;
+				close(connection);
+				return;
+			}
+			connection.inputLength += (std::size_t)received;
+
+			char *start = connection.input;
+			char *end = connection.input + connection.inputLength;
+			for(char *newline; (newline = (char *)std::memchr(start, '\n', end - start)) != NULL; start = newline + 1) {
+				*newline = '\0';
+				if(newline > start && newline[-1] == '\r')
+					newline[-1] = '\0';
+				execute(connection, start);
+			}
+
+			connection.inputLength = (std::size_t)(end - start);
+			if(connection.inputLength == Connection::INPUT_SIZE) {
+				reply(connection, "err line too long\n");
+				write(connection);
+				if(connection.fd >= 0)
+					close(connection);
+				return;
+			}
+			std::memmove(connection.input, start, connection.inputLength);
+		}
+
+		write(connection);
+	}
+
+	void GameServer::write(Connection &connection) {
+		while(connection.outputSent < connection.output.size()) {
+			ssize_t sent = send(connection.fd, connection.output.data() + connection.outputSent,
+				connection.output.size() - connection.outputSent, MSG_NOSIGNAL);
+			if(sent < 0) {
+				if(errno == EINTR)
+					continue;
+				if(errno == EAGAIN || errno == EWOULDBLOCK)
+					break;
+				close(connection);
+				return;
+			}
+			connection.outputSent += (std::size_t)sent;
+		}
+
+		bool pending = (connection.outputSent < connection.output.size());
+		if(!pending) {
+			connection.output.clear();
+			connection.outputSent = 0;
+		} else if(connection.output.size() - connection.outputSent > MAX_OUTPUT) {
+			close(connection);
+			return;
+		}
+
+		if(pending != connection.waitingToWrite) {
+			epoll_event event;
+			std::memset(&event, 0, sizeof(event));
+			event.events = (pending ? EPOLLIN | EPOLLOUT : EPOLLIN);
+			event.data.fd = connection.fd;
+			epoll_ctl(this->epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+			connection.waitingToWrite = pending;
+		}
+	}
+
+	/**
+	 * Results of searches still running for the connection are dropped when they arrive.
+	 */
+	void GameServer::close(Connection &connection) {
+		for(unsigned int game = 0; game < Connection::MAX_GAMES; game++) {
+			if(connection.games[game] != SessionStore::NO_SESSION)
+				this->sessions.release(connection.games[game]);
+		}
+
+		int fd = connection.fd;
+		epoll_ctl(this->epollFd, EPOLL_CTL_DEL, fd, NULL);
+		::close(fd);
+		connection.fd = -1;
+		this->connections[fd].reset();
+	}
+
+	/**
+	 * Plays the computer moves the workers have finished, unless their game
+	 * has since moved on or been closed.
+	 */
+	void GameServer::deliverResults() {
+		boost::uint64_t count;
+		ssize_t received = ::read(this->wakeFd, &count, sizeof(count));
+		(void)received;
+
+		this->results.clear();
+		this->workers->collect(this->results);
+
+		for(std::vector<AiResult>::const_iterator i = this->results.begin(); i != this->results.end(); ++i) {
+			if((std::size_t)i->fd >= this->connections.size())
+				continue;
+			boost::shared_ptr<Connection> connection = this->connections[i->fd];
+			if(!connection || connection->serial != i->connection)
+				continue;
+
+			Session *session = this->sessions.find(i->session);
+			if(session == NULL)
+				continue;
+
+			session->thinking = false;
+			bool won;
+			if(!playMove(session->position, i->move, won)) {
+				reply(*connection, "err %u no move\n", i->game);
+			} else {
+				session->gameOver = (won || session->position.isFull());
+				reply(*connection, "ai %u %s%s\n", i->game, formatMove(i->move).c_str(), describeOutcome(*session, won));
+			}
+			write(*connection);
+		}
+	}
+
+	/**
+	 * Collects the last snapshot, drops restored games nobody resumed in
+	 * time, and starts the next snapshot.
+	 */
+	void GameServer::tick() {
+		boost::uint64_t expirations;
+		ssize_t received = ::read(this->timerFd, &expirations, sizeof(expirations));
+		(void)received;
+
+		this->snapshot->poll();
+		if(this->resumeDeadline != 0 && std::time(NULL) >= this->resumeDeadline) {
+			releaseDetached();
+			this->resumeDeadline = 0;
+		}
+		this->snapshot->begin(this->sessions);
+	}
+
+	void GameServer::releaseDetached() {
+		std::vector<SessionId> detached;
+		for(boost::uint32_t index = 0; index < this->sessions.getNumSlots(); index++) {
+			SessionId id;
+			const Session *session = this->sessions.getSlotSession(index, id);
+			if(session != NULL && session->detached)
+				detached.push_back(id);
+		}
+		for(std::vector<SessionId>::const_iterator i = detached.begin(); i != detached.end(); ++i) {
+			this->sessions.release(*i);
+		}
+	}
+
+	/**
+	 * @param line A command with its line ending removed; split in place
+	 */
+	void GameServer::execute(Connection &connection, char *line) {
+		char *words[4];
+		unsigned int numWords = splitWords(line, words, 4);
+		if(numWords == 0)
+			return;
+
+		const char *command = words[0];
+		unsigned int game;
+
+		if(std::strcmp(command, "new") == 0) {
+			Difficulty difficulty = MEDIUM;
+			if(numWords > 1) {
+				unsigned int level = 0;
+				while(level < 4 && std::strcmp(words[1], difficultyNames[level]) != 0)
+					level++;
+				if(level == 4) {
+					reply(connection, "err unknown level %s\n", words[1]);
+					return;
+				}
+				difficulty = (Difficulty)level;
+			}
+
+			game = findFreeGame(connection);
+			if(game == Connection::MAX_GAMES) {
+				reply(connection, "err too many games\n");
+				return;
+			}
+
+			SessionId id = this->sessions.create(difficulty);
+			if(id == SessionStore::NO_SESSION) {
+				reply(connection, "err server full\n");
+				return;
+			}
+			Session *session = this->sessions.find(id);
+			session->token = newToken();
+			connection.games[game] = id;
+			reply(connection, "ok %u %016llx%016llx\n", game, (unsigned long long)id, (unsigned long long)session->token);
+			return;
+		}
+
+		if(std::strcmp(command, "resume") == 0) {
+			SessionId id;
+			boost::uint64_t token;
+			Session *session = (numWords > 1 && parseKey(words[1], id, token) ? this->sessions.find(id) : NULL);
+			if(session == NULL || !session->detached || session->token != token) {
+				reply(connection, "err no such game\n");
+				return;
+			}
+
+			game = findFreeGame(connection);
+			if(game == Connection::MAX_GAMES) {
+				reply(connection, "err too many games\n");
+				return;
+			}
+			session->detached = false;
+			connection.games[game] = id;
+			reply(connection, "ok %u\n", game);
+			return;
+		}
+
+		if(std::strcmp(command, "move") != 0 && std::strcmp(command, "ai") != 0 &&
+				std::strcmp(command, "show") != 0 && std::strcmp(command, "reset") != 0 && std::strcmp(command, "close") != 0) {
+			reply(connection, "err unknown command %s\n", command);
+			return;
+		}
+
+		Session *session = (numWords > 1 ? findGame(connection, words[1], game) : NULL);
+		if(session == NULL) {
+			reply(connection, "err no such game\n");
+			return;
+		}
+
+		if(std::strcmp(command, "show") == 0) {
+			reply(connection, "board %u %s\n", game, formatBoard(session->position).c_str());
+		} else if(std::strcmp(command, "close") == 0) {
+			this->sessions.release(connection.games[game]);
+			connection.games[game] = SessionStore::NO_SESSION;
+			reply(connection, "ok %u\n", game);
+		} else if(session->thinking) {
+			reply(connection, "err %u busy\n", game);
+		} else if(std::strcmp(command, "reset") == 0) {
+			this->sessions.reset(connection.games[game]);
+			reply(connection, "ok %u\n", game);
+		} else if(session->gameOver) {
+			reply(connection, "err %u game over\n", game);
+		} else if(std::strcmp(command, "move") == 0) {
+			Move move;
+			bool won;
+			if(numWords < 3 || !parseMove(words[2], move) || !playMove(session->position, move, won)) {
+				reply(connection, "err %u illegal move\n", game);
+				return;
+			}
+			session->gameOver = (won || session->position.isFull());
+			reply(connection, "ok %u%s\n", game, describeOutcome(*session, won));
+		} else {
+			AiJob job;
+			job.fd = connection.fd;
+			job.connection = connection.serial;
+			job.game = game;
+			job.session = connection.games[game];
+			job.position = session->position;
+			job.difficulty = session->difficulty;
+			session->thinking = true;
+			this->workers->submit(job);
+		}
+	}
+
+	/**
+	 * @param id The connection's number for the game, as text
+	 * @param game Receives the number
+	 * @return The game's session, or NULL if the connection has no such game
+	 */
+	Session *GameServer::findGame(Connection &connection, const char *id, unsigned int &game) {
+		char *end;
+		unsigned long value = std::strtoul(id, &end, 10);
+		if(*id == '\0' || *end != '\0' || value >= Connection::MAX_GAMES)
+			return NULL;
+		game = (unsigned int)value;
+		return this->sessions.find(connection.games[game]);
+	}
+
+	void GameServer::reply(Connection &connection, const char *format, ...) {
+		char buffer[256];
+		va_list args;
+		va_start(args, format);
+		int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+		if(length > 0)
+			connection.output.append(buffer, std::min((std::size_t)length, sizeof(buffer) - 1));
+	}
+
+}
@@ -0,0 +1,243 @@
+/**
+* @file SessionSnapshot.cpp
+*/
+#include "SessionSnapshot.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+	using namespace quarto;
+
+	const char fileMagic[8] = { 'Q', 'U', 'A', 'R', 'T', 'O', 'S', 'S' };
+	const boost::uint32_t FILE_VERSION = 1;
+
+	/** Records written with each system call */
+	const unsigned int WRITE_BATCH = 1024;
+
+	struct FileHeader {
+		char magic[8];
+		boost::uint32_t version;
+		boost::uint32_t recordSize;
+		boost::uint64_t numRecords;
+		/** The generation the restored store starts its free slots at; zero in older snapshots */
+		boost::uint32_t nextGeneration;
+		char reserved[36];
+	};
+
+	struct SessionRecord {
+		boost::uint64_t id;
+		boost::uint64_t token;
+		/** The piece on each square, four bits a square */
+		boost::uint64_t board;
+		boost::uint16_t occupied;
+		byte inHand;
+		byte difficulty;
+		byte gameOver;
+		byte reserved[3];
+	};
+
+	bool writeAll(int fd, const void *data, std::size_t size) {
+		const char *c = (const char *)data;
+		while(size > 0) {
+			ssize_t written = ::write(fd, c, size);
+			if(written < 0) {
+				if(errno == EINTR)
+					continue;
+				return false;
+			}
+			c += written;
+			size -= (std::size_t)written;
+		}
+		return true;
+	}
+
+	void pack(SessionId id, const Session &session, SessionRecord &record) {
+		const Position &position = session.position;
+		std::memset(&record, 0, sizeof(record));
+		record.id = id;
+		record.token = session.token;
+		record.board = position.getBoard();
+		record.occupied = position.getOccupied();
+		record.inHand = position.getPieceInHand();
+		record.difficulty = (byte)session.difficulty;
+		record.gameOver = (session.gameOver ? 1 : 0);
+	}
+
+	/** @return false if the record names a piece twice or holds no valid game */
+	bool unpack(const SessionRecord &record, Session &session) {
+		if(record.difficulty > EXPERT)
+			return false;
+
+		Position position;
+		bool won;
+		if(!Position::fromBoard(record.board, record.occupied, record.inHand, position, won))
+			return false;
+
+		session = Session();
+		session.position = position;
+		session.token = record.token;
+		session.difficulty = (Difficulty)record.difficulty;
+		session.gameOver = (record.gameOver != 0);
+		session.detached = true;
+		return true;
+	}
+
+}
+
+namespace quarto {
+
+	SessionSnapshot::SessionSnapshot(const std::string &path) : path(path), tempPath(path + ".tmp"), child(0) {
+		std::string::size_type slash = path.rfind('/');
+		this->directory = (slash == std::string::npos ? std::string(".") : (slash == 0 ? std::string("/") : path.substr(0, slash)));
+	}
+
+	SessionSnapshot::~SessionSnapshot() {
+		reap(true);
+	}
+
+	/**
+	 * The child holds the only copy of the sessions it writes, so the server
+	 * can go on changing its own.
+	 */
+	bool SessionSnapshot::begin(const SessionStore &sessions) {
+		if(this->child > 0)
+			return false;
+
+		pid_t pid = fork();
+		if(pid < 0) {
+			std::cerr << "quarto-server: fork: " << std::strerror(errno) << std::endl;
+			return false;
+		}
+		if(pid == 0)
+			_exit(writeFile(sessions) ? 0 : 1);
+
+		this->child = pid;
+		return true;
+	}
+
+	bool SessionSnapshot::poll() {
+		return reap(false);
+	}
+
+	bool SessionSnapshot::write(const SessionStore &sessions) {
+		reap(true);
+		if(!writeFile(sessions)) {
+			std::cerr << "quarto-server: could not write snapshot " << this->path << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * The records are read in slot order, which is the order restore() needs.
+	 */
+	bool SessionSnapshot::restore(SessionStore &sessions) const {
+		std::ifstream in(this->path.c_str(), std::ios::binary);
+		if(!in)
+			return false;
+
+		FileHeader header;
+		if(!in.read((char *)&header, sizeof(header)) ||
+				std::memcmp(header.magic, fileMagic, sizeof(header.magic)) != 0 ||
+				header.version != FILE_VERSION ||
+				header.recordSize != sizeof(SessionRecord) ||
+				header.numRecords > sessions.getCapacity())
+			return false;
+		sessions.setFirstGeneration(header.nextGeneration);
+
+		std::vector<SessionRecord> records((std::size_t)header.numRecords);
+		if(!records.empty() && !in.read((char *)&records[0], (std::streamsize)(records.size() * sizeof(SessionRecord))))
+			return false;
+
+		for(std::vector<SessionRecord>::const_iterator i = records.begin(); i != records.end(); ++i) {
+			Session session;
+			if(!unpack(*i, session) || !sessions.restore(i->id, session))
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @param wait Whether to block until the child exits
+	 * @return false if a child was collected and it failed
+	 */
+	bool SessionSnapshot::reap(bool wait) {
+		if(this->child <= 0)
+			return true;
+
+		int status;
+		pid_t pid;
+		do {
+			pid = waitpid(this->child, &status, wait ? 0 : WNOHANG);
+		} while(pid < 0 && errno == EINTR);
+		if(pid == 0)
+			return true;
+
+		this->child = 0;
+		if(pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			std::cerr << "quarto-server: could not write snapshot " << this->path << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Writes the header last, once the number of records is known, then syncs
+	 * the file before renaming it and the directory after, so the new
+	 * snapshot is durable before the old one is gone.
+	 */
+	bool SessionSnapshot::writeFile(const SessionStore &sessions) const {
+		int fd = open(this->tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if(fd < 0)
+			return false;
+
+		FileHeader header;
+		std::memset(&header, 0, sizeof(header));
+		bool ok = (lseek(fd, sizeof(header), SEEK_SET) == (off_t)sizeof(header));
+
+		SessionRecord records[WRITE_BATCH];
+		unsigned int numBuffered = 0;
+		for(boost::uint32_t index = 0; index < sessions.getNumSlots() && ok; index++) {
+			SessionId id;
+			const Session *session = sessions.getSlotSession(index, id);
+			if(session == NULL)
+				continue;
+
+			pack(id, *session, records[numBuffered++]);
+			header.numRecords++;
+			if(numBuffered == WRITE_BATCH) {
+				ok = writeAll(fd, records, sizeof(records));
+				numBuffered = 0;
+			}
+		}
+		if(ok && numBuffered > 0)
+			ok = writeAll(fd, records, numBuffered * sizeof(SessionRecord));
+
+		std::memcpy(header.magic, fileMagic, sizeof(header.magic));
+		header.version = FILE_VERSION;
+		header.recordSize = sizeof(SessionRecord);
+		header.nextGeneration = sessions.getNextGeneration();
+		ok = ok && lseek(fd, 0, SEEK_SET) == 0 && writeAll(fd, &header, sizeof(header)) && fsync(fd) == 0;
+		ok = (close(fd) == 0) && ok;
+		if(!ok || std::rename(this->tempPath.c_str(), this->path.c_str()) != 0) {
+			unlink(this->tempPath.c_str());
+			return false;
+		}
+
+		int directoryFd = open(this->directory.c_str(), O_RDONLY | O_CLOEXEC);
+		if(directoryFd >= 0) {
+			fsync(directoryFd);
+			close(directoryFd);
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,142 @@
+/**
+* @file SessionStore.cpp
+*/
+#include "SessionStore.hpp"
+
+namespace quarto {
+
+	SessionStore::SessionStore(unsigned int capacity)
+		: capacity(capacity), numSlots(0), numSessions(0), freeHead(NO_SLOT), firstGeneration(0), nextGeneration(0) {
+		this->chunks.reserve((capacity + SLOTS_PER_CHUNK - 1) / SLOTS_PER_CHUNK);
+	}
+
+	/**
+	 * Recycles the most recently released slot, whose memory is likely to still be cached.
+	 */
+	SessionId SessionStore::create(Difficulty difficulty) {
+		boost::uint32_t index;
+		if(this->freeHead != NO_SLOT) {
+			index = this->freeHead;
+			this->freeHead = getSlot(index).nextFree;
+		} else {
+			if(!addSlot())
+				return NO_SESSION;
+			index = this->numSlots - 1;
+		}
+
+		Slot &slot = getSlot(index);
+		slot.session = Session();
+		slot.session.difficulty = difficulty;
+		slot.nextFree = NO_SLOT;
+		slot.inUse = true;
+		this->numSessions++;
+		if(slot.generation >= this->nextGeneration)
+			this->nextGeneration = slot.generation + 1;
+
+		return ((SessionId)slot.generation << 32) | index;
+	}
+
+	Session *SessionStore::find(SessionId id) {
+		Slot *slot = findSlot(id);
+		return (slot != NULL ? &slot->session : NULL);
+	}
+
+	bool SessionStore::reset(SessionId id) {
+		Slot *slot = findSlot(id);
+		if(slot == NULL)
+			return false;
+
+		Session reset;
+		reset.difficulty = slot->session.difficulty;
+		reset.token = slot->session.token;
+		slot->session = reset;
+		return true;
+	}
+
+	bool SessionStore::release(SessionId id) {
+		Slot *slot = findSlot(id);
+		if(slot == NULL)
+			return false;
+
+		boost::uint32_t index = (boost::uint32_t)id;
+		slot->inUse = false;
+		slot->generation++;
+		slot->nextFree = this->freeHead;
+		this->freeHead = index;
+		this->numSessions--;
+		return true;
+	}
+
+	/**
+	 * Slots skipped over to reach the id's slot go on the free list.
+	 *
+	 * @param session The saved game; kept as it is, including its difficulty and token
+	 */
+	bool SessionStore::restore(SessionId id, const Session &session) {
+		boost::uint32_t index = (boost::uint32_t)id;
+		if(index < this->numSlots || index >= this->capacity)
+			return false;
+
+		while(this->numSlots <= index) {
+			addSlot();
+			if(this->numSlots <= index) {
+				getSlot(this->numSlots - 1).nextFree = this->freeHead;
+				this->freeHead = this->numSlots - 1;
+			}
+		}
+
+		Slot &slot = getSlot(index);
+		slot.session = session;
+		slot.generation = (boost::uint32_t)(id >> 32);
+		slot.nextFree = NO_SLOT;
+		slot.inUse = true;
+		this->numSessions++;
+		if(slot.generation >= this->nextGeneration)
+			this->nextGeneration = slot.generation + 1;
+		return true;
+	}
+
+	void SessionStore::setFirstGeneration(boost::uint32_t generation) {
+		this->firstGeneration = generation;
+		if(generation > this->nextGeneration)
+			this->nextGeneration = generation;
+	}
+
+	const Session *SessionStore::getSlotSession(boost::uint32_t index, SessionId &id) const {
+		const Slot &slot = getSlot(index);
+		if(!slot.inUse)
+			return NULL;
+		id = ((SessionId)slot.generation << 32) | index;
+		return &slot.session;
+	}
+
+	SessionStore::Slot *SessionStore::findSlot(SessionId id) {
+		boost::uint32_t index = (boost::uint32_t)id;
+		if(index >= this->numSlots)
+			return NULL;
+
+		Slot &slot = getSlot(index);
+		if(!slot.inUse || slot.generation != (boost::uint32_t)(id >> 32))
+			return NULL;
+		return &slot;
+	}
+
+	bool SessionStore::addSlot() {
+		if(this->numSlots == this->capacity)
+			return false;
+
+		if(this->numSlots % SLOTS_PER_CHUNK == 0) {
+			boost::shared_array<Slot> chunk(new Slot[SLOTS_PER_CHUNK]);
+			for(unsigned int i = 0; i < SLOTS_PER_CHUNK; i++) {
+				chunk[i].generation = 0;
+				chunk[i].nextFree = NO_SLOT;
+				chunk[i].inUse = false;
+			}
+			this->chunks.push_back(chunk);
+		}
+		getSlot(this->numSlots).generation = this->firstGeneration;
+		this->numSlots++;
+		return true;
+	}
+
+}
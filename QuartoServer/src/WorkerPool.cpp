@@ -0,0 +1,78 @@
+/**
+* @file WorkerPool.cpp
+*/
+#include "WorkerPool.hpp"
+#include "ComputerPlayer.hpp"
+#include <boost/bind.hpp>
+#include <unistd.h>
+
+namespace quarto {
+
+	WorkerPool::WorkerPool(unsigned int numThreads, TranspositionTable &table, int notifyFd)
+		: table(table), notifyFd(notifyFd), stopping(false) {
+		for(unsigned int i = 0; i < numThreads; i++) {
+			this->threads.create_thread(boost::bind(&WorkerPool::run, this, i));
+		}
+	}
+
+	/**
+	 * Waits for the searches in progress; jobs still queued are dropped.
+	 */
+	WorkerPool::~WorkerPool() {
+		{
+			boost::mutex::scoped_lock lock(this->mutex);
+			this->stopping = true;
+		}
+		this->jobAvailable.notify_all();
+		this->threads.join_all();
+	}
+
+	void WorkerPool::submit(const AiJob &job) {
+		{
+			boost::mutex::scoped_lock lock(this->mutex);
+			this->jobs.push_back(job);
+		}
+		this->jobAvailable.notify_one();
+	}
+
+	void WorkerPool::collect(std::vector<AiResult> &results) {
+		boost::mutex::scoped_lock lock(this->mutex);
+		results.insert(results.end(), this->finished.begin(), this->finished.end());
+		this->finished.clear();
+	}
+
+	void WorkerPool::run(unsigned int id) {
+		ComputerPlayer player(this->table, id);
+
+		for(;;) {
+			AiJob job;
+			{
+				boost::mutex::scoped_lock lock(this->mutex);
+				while(this->jobs.empty() && !this->stopping)
+					this->jobAvailable.wait(lock);
+				if(this->stopping)
+					return;
+				job = this->jobs.front();
+				this->jobs.pop_front();
+			}
+
+			AiResult result;
+			result.fd = job.fd;
+			result.connection = job.connection;
+			result.game = job.game;
+			result.session = job.session;
+			result.move = player.chooseMove(job.position, job.difficulty).move;
+
+			{
+				boost::mutex::scoped_lock lock(this->mutex);
+				this->finished.push_back(result);
+			}
+
+			// Only fails if the counter would overflow, and then the loop is already due to wake
+			boost::uint64_t one = 1;
+			ssize_t written = write(this->notifyFd, &one, sizeof(one));
+			(void)written;
+		}
+	}
+
+}
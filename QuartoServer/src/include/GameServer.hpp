@@ -0,0 +1,129 @@
+/**
+ * @file GameServer.hpp
+ */
+#pragma once
+
+#include "SessionSnapshot.hpp"
+#include "SessionStore.hpp"
+#include "TranspositionTable.hpp"
+#include "WorkerPool.hpp"
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace quarto {
+
+	/**
+	 * @brief A client of the server and the games it has open
+	 */
+	struct Connection {
+		static const unsigned int MAX_GAMES = 64;
+		static const std::size_t INPUT_SIZE = 4096;
+
+		int fd;
+		boost::uint64_t serial;
+
+		char input[INPUT_SIZE];
+		std::size_t inputLength;
+
+		/** Replies not yet written; the capacity is kept between writes */
+		std::string output;
+		std::size_t outputSent;
+		bool waitingToWrite;
+
+		/** The connection's games by number; NO_SESSION where a number is free */
+		SessionId games[MAX_GAMES];
+	};
+
+	/**
+	 * @brief Hosts many games for clients on a Unix domain socket
+	 *
+	 * A single thread multiplexes every connection with epoll. Commands are
+	 * lines of text, parsed in place in the connection's input buffer:
+	 *   new [easy|medium|hard|expert]   ok <id> <key>
+	 *   resume <key>                    ok <id>, for a game restored from a snapshot
+	 *   move <id> <move>                ok <id> [won|draw]
+	 *   ai <id>                         ai <id> <move> [won|draw], once the worker pool has chosen
+	 *   show <id>                       board <id> <board>
+	 *   reset <id>                      ok <id>
+	 *   close <id>                      ok <id>
+	 * Failures are answered with "err [<id>] <reason>". Moves and boards are
+	 * written as in Notation.hpp. The games of every connection are kept
+	 * together in one SessionStore.
+	 *
+	 * With snapshots enabled, every session is saved periodically and when
+	 * the server stops. After a restart the saved games wait for their
+	 * clients to resume them with the key they were given, and are dropped
+	 * if no client has resumed them within a few minutes.
+	 */
+	class GameServer : boost::noncopyable {
+	public:
+
+		GameServer(unsigned int numWorkers, unsigned int hashMegabytes, unsigned int maxSessions);
+		~GameServer();
+
+		/**
+		 * Restores the sessions of the last snapshot and saves new ones every
+		 * so many seconds. Call before listen().
+		 */
+		void enableSnapshots(const std::string &path, unsigned int seconds);
+
+		/** Binds the socket, replacing a stale socket file; false with a message on stderr on failure */
+		bool listen(const std::string &path);
+
+		/** Serves clients until stop() is called */
+		void run();
+
+		/** Ends run() soon; safe to call from any thread or a signal handler */
+		void stop();
+
+	private:
+
+		int listenFd;
+		int epollFd;
+		int wakeFd;
+		int timerFd;
+		std::string socketPath;
+		boost::atomic<bool> stopping;
+
+		SessionStore sessions;
+		TranspositionTable table;
+		boost::scoped_ptr<WorkerPool> workers;
+
+		/** Indexed by file descriptor */
+		std::vector<boost::shared_ptr<Connection> > connections;
+		boost::uint64_t nextSerial;
+		std::vector<AiResult> results;
+
+		boost::scoped_ptr<SessionSnapshot> snapshot;
+		unsigned int snapshotSeconds;
+		/** When restored sessions no client has resumed are dropped; 0 once they have been */
+		std::time_t resumeDeadline;
+		/** Draws tokens only when the kernel's random source fails */
+		boost::random::mt19937_64 random;
+
+		/** @return A token that keeps other clients from resuming a game, read from the kernel's random source */
+		boost::uint64_t newToken();
+
+		void accept();
+		void read(Connection &connection);
+		void write(Connection &connection);
+		void close(Connection &connection);
+		void deliverResults();
+		void tick();
+		void releaseDetached();
+
+		void execute(Connection &connection, char *line);
+		Session *findGame(Connection &connection, const char *id, unsigned int &game);
+		void reply(Connection &connection, const char *format, ...);
+
+	};
+
+}
@@ -0,0 +1,31 @@
+/**
+ * @file Session.hpp
+ */
+#pragma once
+
+#include "Game.hpp"
+#include "Position.hpp"
+
+namespace quarto {
+
+	/**
+	 * @brief One game hosted by the server
+	 *
+	 * The state is kept as a Position rather than a Game so that sessions are
+	 * plain values: validating a move touches no heap memory.
+	 */
+	struct Session {
+		Session() : gameOver(false), thinking(false), detached(false), difficulty(MEDIUM), token(0) {}
+
+		bool gameOver;
+		/** Set while the worker pool is choosing a move; other moves are refused until it is played */
+		bool thinking;
+		/** Set for a session restored from a snapshot until a client resumes it */
+		bool detached;
+		Difficulty difficulty;
+		/** A random number the client must present with the session id to resume the game */
+		boost::uint64_t token;
+		Position position;
+	};
+
+}
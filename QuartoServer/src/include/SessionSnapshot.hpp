@@ -0,0 +1,68 @@
+/**
+ * @file SessionSnapshot.hpp
+ */
+#pragma once
+
+#include "SessionStore.hpp"
+#include <boost/noncopyable.hpp>
+#include <string>
+#include <sys/types.h>
+
+namespace quarto {
+
+	/**
+	 * @brief Saves every session to a file and loads them back after a restart
+	 *
+	 * A snapshot is written by a forked child, which sees the sessions as they
+	 * were at the fork while the server carries on; the kernel copies only the
+	 * pages the server changes meanwhile. The child writes a temporary file,
+	 * syncs it once, and renames it over the last snapshot, so a crash at any
+	 * point leaves a complete snapshot behind.
+	 *
+	 * Each session is saved as a 32-byte record: its id, token, board,
+	 * occupied squares, piece in hand, difficulty and whether it is over.
+	 * Searches in progress are not saved. The header also keeps a generation
+	 * above every id handed out, so a restored store never reuses an id
+	 * that a client may still hold.
+	 */
+	class SessionSnapshot : boost::noncopyable {
+	public:
+
+		explicit SessionSnapshot(const std::string &path);
+		~SessionSnapshot();
+
+		/** Starts writing a snapshot in the background; false if one is still being written or the fork failed */
+		bool begin(const SessionStore &sessions);
+
+		/** Collects a finished background write; false with a message on stderr if it failed */
+		bool poll();
+
+		inline bool isWriting() const { return child > 0; }
+
+		/** Waits for any background write, then writes a snapshot in this process */
+		bool write(const SessionStore &sessions);
+
+		/**
+		 * Loads the last snapshot into an empty store, marking every session detached.
+		 *
+		 * @return false if the snapshot is missing or malformed; sessions read before a bad record are kept
+		 */
+		bool restore(SessionStore &sessions) const;
+
+	private:
+
+		std::string path;
+		/** Built up front, since a forked child must not allocate */
+		std::string tempPath;
+		std::string directory;
+		pid_t child;
+
+		/** Waits for the child to exit; false if it failed */
+		bool reap(bool wait);
+
+		/** Writes the file with system calls alone, so it is safe in a forked child */
+		bool writeFile(const SessionStore &sessions) const;
+
+	};
+
+}
@@ -0,0 +1,104 @@
+/**
+ * @file SessionStore.hpp
+ */
+#pragma once
+
+#include "Session.hpp"
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_array.hpp>
+#include <vector>
+
+namespace quarto {
+
+	/** Names a session: the slot index in the low 32 bits and the slot's generation in the high 32 */
+	typedef boost::uint64_t SessionId;
+
+	/**
+	 * @brief Fixed-size slots holding every session, recycled through a free list
+	 *
+	 * Slots are allocated in chunks that never move, so a Session pointer
+	 * stays valid until its session is released. Creating, resetting, finding
+	 * and releasing a session are O(1) and allocate nothing, except when a
+	 * new chunk of slots is first needed. A released slot's generation is
+	 * advanced, so ids of released sessions are never found again.
+	 */
+	class SessionStore : boost::noncopyable {
+	public:
+
+		static const SessionId NO_SESSION = ~(SessionId)0;
+		static const unsigned int SLOTS_PER_CHUNK = 4096;
+
+		/** Constructs an empty store that can hold up to the given number of sessions */
+		explicit SessionStore(unsigned int capacity);
+
+		/** @return The id of a new game at the start position, or NO_SESSION if the store is full */
+		SessionId create(Difficulty difficulty);
+
+		/** @return The session, or NULL if the id is stale */
+		Session *find(SessionId id);
+
+		/** Returns the game to the start position, keeping its difficulty and token */
+		bool reset(SessionId id);
+
+		bool release(SessionId id);
+
+		/**
+		 * Puts a saved session back under its old id. Sessions must be
+		 * restored into an empty store in increasing order of slot.
+		 *
+		 * @return false if the id is out of order or beyond the capacity
+		 */
+		bool restore(SessionId id, const Session &session);
+
+		inline unsigned int getNumSessions() const { return numSessions; }
+		inline unsigned int getCapacity() const { return capacity; }
+
+		/** @return One more than the highest slot index ever used */
+		inline unsigned int getNumSlots() const { return numSlots; }
+
+		/** @return The session in the slot, setting its id, or NULL if the slot is free */
+		const Session *getSlotSession(boost::uint32_t index, SessionId &id) const;
+
+		/** @return A generation above that of every id the store has handed out */
+		inline boost::uint32_t getNextGeneration() const { return nextGeneration; }
+
+		/**
+		 * Starts every slot not yet made, including those restore() skips
+		 * over, at the given generation, so that ids handed out before a
+		 * restart are not handed out again. Call this before restore().
+		 */
+		void setFirstGeneration(boost::uint32_t generation);
+
+	private:
+
+		static const boost::uint32_t NO_SLOT = 0xFFFFFFFF;
+
+		struct Slot {
+			Session session;
+			boost::uint32_t generation;
+			/** The next free slot while this one is free; NO_SLOT while it is in use or last */
+			boost::uint32_t nextFree;
+			bool inUse;
+		};
+
+		std::vector<boost::shared_array<Slot> > chunks;
+		unsigned int capacity;
+		unsigned int numSlots;
+		unsigned int numSessions;
+		boost::uint32_t freeHead;
+		/** The generation new slots start at */
+		boost::uint32_t firstGeneration;
+		boost::uint32_t nextGeneration;
+
+		inline Slot &getSlot(boost::uint32_t index) { return chunks[index / SLOTS_PER_CHUNK][index % SLOTS_PER_CHUNK]; }
+		inline const Slot &getSlot(boost::uint32_t index) const { return chunks[index / SLOTS_PER_CHUNK][index % SLOTS_PER_CHUNK]; }
+
+		Slot *findSlot(SessionId id);
+
+		/** Makes a new slot at the end, allocating a chunk if needed; false if the store is at capacity */
+		bool addSlot();
+
+	};
+
+}
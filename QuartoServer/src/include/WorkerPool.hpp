@@ -0,0 +1,80 @@
+/**
+ * @file WorkerPool.hpp
+ */
+#pragma once
+
+#include "Game.hpp"
+#include "Position.hpp"
+#include "SessionStore.hpp"
+#include "TranspositionTable.hpp"
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+#include <vector>
+
+namespace quarto {
+
+	/**
+	 * @brief A request for a computer move, and where to deliver it
+	 */
+	struct AiJob {
+		int fd;
+		/** Tells the connection apart from later ones that reuse its file descriptor */
+		boost::uint64_t connection;
+		/** The connection's number for the game */
+		unsigned int game;
+		SessionId session;
+		Position position;
+		Difficulty difficulty;
+	};
+
+	struct AiResult {
+		int fd;
+		boost::uint64_t connection;
+		unsigned int game;
+		SessionId session;
+		Move move;
+	};
+
+	/**
+	 * @brief Threads that choose computer moves off the event loop
+	 *
+	 * Every worker searches with its own ComputerPlayer over one shared table.
+	 * Finished results are queued and announced by writing to an eventfd, so
+	 * the event loop can wait on them with everything else.
+	 */
+	class WorkerPool : boost::noncopyable {
+	public:
+
+		/**
+		 * @param notifyFd An eventfd to signal after each result
+		 */
+		WorkerPool(unsigned int numThreads, TranspositionTable &table, int notifyFd);
+		~WorkerPool();
+
+		void submit(const AiJob &job);
+
+		/** Appends the finished results to the vector and forgets them */
+		void collect(std::vector<AiResult> &results);
+
+	private:
+
+		TranspositionTable &table;
+		int notifyFd;
+
+		boost::mutex mutex;
+		boost::condition_variable jobAvailable;
+		std::deque<AiJob> jobs;
+		std::vector<AiResult> finished;
+		bool stopping;
+
+		boost::thread_group threads;
+
+		void run(unsigned int id);
+
+	};
+
+}
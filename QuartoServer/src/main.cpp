@@ -0,0 +1,49 @@
+/**
+* @file main.cpp
+*/
+#include "GameServer.hpp"
+#include <boost/thread/thread.hpp>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+using quarto::GameServer;
+
+namespace {
+
+	GameServer *server = NULL;
+
+	void handleSignal(int) {
+		if(server != NULL)
+			server->stop();
+	}
+
+}
+
+/** Entry point for the game server: quarto-server <socket> [workers] [hash megabytes] [max sessions] [snapshot file] [snapshot seconds] */
+int main(int argc, char **argv) {
+	if(argc < 2) {
+		std::cerr << "usage: quarto-server <socket> [workers] [hash megabytes] [max sessions] [snapshot file] [snapshot seconds]" << std::endl;
+		return 2;
+	}
+
+	unsigned int numWorkers = (argc > 2 ? (unsigned int)std::atoi(argv[2]) : boost::thread::hardware_concurrency());
+	unsigned int hashMegabytes = (argc > 3 ? (unsigned int)std::atoi(argv[3]) : 64);
+	unsigned int maxSessions = (argc > 4 ? (unsigned int)std::atoi(argv[4]) : 1 << 20);
+	unsigned int snapshotSeconds = (argc > 6 ? (unsigned int)std::atoi(argv[6]) : 10);
+
+	GameServer gameServer(numWorkers, hashMegabytes, maxSessions);
+	if(argc > 5)
+		gameServer.enableSnapshots(argv[5], snapshotSeconds);
+	if(!gameServer.listen(argv[1]))
+		return 1;
+
+	server = &gameServer;
+	std::signal(SIGINT, handleSignal);
+	std::signal(SIGTERM, handleSignal);
+
+	gameServer.run();
+
+	server = NULL;
+	return 0;
+}
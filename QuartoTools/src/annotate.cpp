@@ -0,0 +1,99 @@
+/**
+* @file annotate.cpp
+*/
+#include "GameAnnotator.hpp"
+#include "GameRecord.hpp"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace quarto;
+using boost::posix_time::microsec_clock;
+using boost::posix_time::ptime;
+
+namespace {
+
+	/** Games annotated together; larger batches find more shared positions but report progress less often */
+	const std::size_t BATCH_SIZE = 1 << 14;
+
+	void printUsage() {
+		std::cerr << "usage: quarto-annotate <records> <output> [text|binary] [threads] [depth] [hash megabytes]" << std::endl;
+	}
+
+	/** Writes throughput and an estimate of the time left from how much of the input has been read */
+	void reportProgress(const GameAnnotator &annotator, boost::uint64_t numGames, double seconds, double fractionRead) {
+		double rate = (seconds > 0.0 ? annotator.getNumSearched() / seconds : 0.0);
+		double hitRate = (annotator.getNumPositions() > 0 ? 1.0 - (double)annotator.getNumSearched() / annotator.getNumPositions() : 0.0);
+		std::cerr << numGames << " games, " << annotator.getNumPositions() << " positions, "
+			<< annotator.getNumSearched() << " searched (" << (boost::uint64_t)rate << "/s, "
+			<< (boost::uint64_t)(annotator.getNodes() / (seconds > 0.0 ? seconds : 1.0)) << " nodes/s), "
+			<< (int)(100.0 * hitRate) << "% cached";
+		if(fractionRead > 0.0 && fractionRead < 1.0)
+			std::cerr << ", eta " << (boost::uint64_t)(seconds * (1.0 - fractionRead) / fractionRead) << "s";
+		std::cerr << std::endl;
+	}
+
+}
+
+/** Entry point for the annotation job: marks every move of an archive as best, inaccuracy or blunder */
+int main(int argc, char **argv) {
+	if(argc < 3) {
+		printUsage();
+		return 2;
+	}
+
+	RecordFormat format = (argc > 3 && std::strcmp(argv[3], "binary") == 0 ? RECORD_BINARY : RECORD_TEXT);
+	unsigned int numThreads = (argc > 4 ? (unsigned int)std::atoi(argv[4]) : boost::thread::hardware_concurrency());
+	SearchLimits limits;
+	limits.depth = (argc > 5 ? (unsigned int)std::atoi(argv[5]) : 4);
+	unsigned int hashMegabytes = (argc > 6 ? (unsigned int)std::atoi(argv[6]) : 256);
+
+	std::ifstream in(argv[1], std::ios::binary);
+	if(!in) {
+		std::cerr << "could not open " << argv[1] << std::endl;
+		return 1;
+	}
+	in.seekg(0, std::ios::end);
+	double inputSize = (double)in.tellg();
+	in.seekg(0, std::ios::beg);
+
+	std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+	if(!out) {
+		std::cerr << "could not open " << argv[2] << std::endl;
+		return 1;
+	}
+
+	GameRecordReader reader(in, format);
+	GameAnnotator annotator(numThreads, hashMegabytes, limits);
+	std::vector<GameRecord> games;
+	std::vector<GameAnnotation> annotations;
+	boost::uint64_t numGames = 0;
+	ptime startTime = microsec_clock::universal_time();
+
+	for(bool more = true; more; ) {
+		games.clear();
+		GameRecord record;
+		while(games.size() < BATCH_SIZE && (more = reader.read(record)))
+			games.push_back(record);
+		if(games.empty())
+			break;
+
+		annotator.annotate(games, annotations);
+		for(std::size_t i = 0; i < games.size(); i++) {
+			out << GameAnnotator::toText(games[i], annotations[i]) << '\n';
+		}
+		numGames += games.size();
+
+		double seconds = (microsec_clock::universal_time() - startTime).total_microseconds() / 1e6;
+		double fractionRead = (in ? (double)in.tellg() / inputSize : 1.0);
+		reportProgress(annotator, numGames, seconds, fractionRead);
+	}
+
+	if(reader.hasError())
+		std::cerr << "stopped at a malformed record" << std::endl;
+	out.close();
+	return (reader.hasError() || !out) ? 1 : 0;
+}
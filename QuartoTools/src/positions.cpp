@@ -0,0 +1,124 @@
+/**
+* @file positions.cpp
+*/
+#include "GameRecord.hpp"
+#include "Notation.hpp"
+#include "PositionDatabase.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace quarto;
+
+namespace {
+
+	/** Games are indexed in memory until the builder holds this many entries, then written as a segment */
+	const std::size_t SEGMENT_ENTRIES = 1 << 22;
+
+	void printUsage() {
+		std::cerr << "usage: quarto-positions build <database> [text|binary] < records" << std::endl;
+		std::cerr << "       quarto-positions compact <database>" << std::endl;
+		std::cerr << "       quarto-positions query <database> board <board> <in hand>" << std::endl;
+		std::cerr << "       quarto-positions query <database> moves <move>..." << std::endl;
+	}
+
+	int build(PositionDatabase &database, RecordFormat format) {
+		GameRecordReader reader(std::cin, format);
+		PositionIndexBuilder builder;
+		GameRecord record;
+		unsigned long numGames = 0;
+		unsigned long numSkipped = 0;
+
+		while(reader.read(record)) {
+			if(builder.add(record))
+				numGames++;
+			else
+				numSkipped++;
+
+			if(builder.getNumEntries() >= SEGMENT_ENTRIES) {
+				if(!database.append(builder)) {
+					std::cerr << "could not write a segment" << std::endl;
+					return 1;
+				}
+				builder.clear();
+			}
+		}
+		if(reader.hasError())
+			std::cerr << "stopped at a malformed record" << std::endl;
+
+		if(!database.append(builder)) {
+			std::cerr << "could not write a segment" << std::endl;
+			return 1;
+		}
+
+		std::cout << numGames << " games indexed, " << numSkipped << " illegal records skipped, "
+			<< database.getNumSegments() << " segments, " << database.getNumEntries() << " entries" << std::endl;
+		return reader.hasError() ? 1 : 0;
+	}
+
+	int query(const PositionDatabase &database, int argc, char **argv) {
+		Position position;
+		if(argc == 3 && std::strcmp(argv[0], "board") == 0) {
+			if(!parseBoard(argv[1], argv[2], position)) {
+				std::cerr << "malformed board" << std::endl;
+				return 2;
+			}
+		} else if(argc >= 1 && std::strcmp(argv[0], "moves") == 0) {
+			for(int i = 1; i < argc; i++) {
+				Move move;
+				bool won;
+				if(!parseMove(argv[i], move) || !playMove(position, move, won)) {
+					std::cerr << "illegal move " << argv[i] << std::endl;
+					return 2;
+				}
+			}
+		} else {
+			printUsage();
+			return 2;
+		}
+
+		PositionStats stats = database.lookup(position);
+		std::cout << formatBoard(position) << " games " << stats.games << std::endl;
+		for(std::vector<MoveStats>::const_iterator i = stats.moves.begin(); i != stats.moves.end(); ++i) {
+			std::cout << (i->move.isNull() ? std::string("end") : formatMove(i->move))
+				<< " games " << i->games << " wins " << i->wins << " losses " << i->losses << std::endl;
+		}
+		return 0;
+	}
+
+}
+
+/** Entry point for the position index tool: builds, compacts and queries a PositionDatabase */
+int main(int argc, char **argv) {
+	std::ios::sync_with_stdio(false);
+
+	if(argc < 3) {
+		printUsage();
+		return 2;
+	}
+
+	std::string command = argv[1];
+	PositionDatabase database;
+	if(!database.open(argv[2])) {
+		std::cerr << "not a position database: " << argv[2] << std::endl;
+		return 1;
+	}
+
+	if(command == "build") {
+		RecordFormat format = (argc > 3 && std::strcmp(argv[3], "binary") == 0 ? RECORD_BINARY : RECORD_TEXT);
+		return build(database, format);
+	} else if(command == "compact") {
+		if(!database.compact()) {
+			std::cerr << "compaction failed" << std::endl;
+			return 1;
+		}
+		std::cout << database.getNumEntries() << " entries" << std::endl;
+		return 0;
+	} else if(command == "query") {
+		return query(database, argc - 3, argv + 3);
+	}
+
+	printUsage();
+	return 2;
+}
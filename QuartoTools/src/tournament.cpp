@@ -0,0 +1,135 @@
+/**
+* @file tournament.cpp
+*/
+#include "Tournament.hpp"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace quarto;
+
+namespace {
+
+	Tournament *tournament = NULL;
+
+	void handleSignal(int) {
+		if(tournament != NULL)
+			tournament->stop();
+	}
+
+	void printUsage() {
+		std::cerr << "usage: quarto-tournament <player> <player> [games=n] [threads=n] [hash=megabytes] [openings=moves]" << std::endl;
+		std::cerr << "                         [seed=n] [sprt=elo0,elo1] [alpha=p] [beta=p] [report=games]" << std::endl;
+		std::cerr << "A player is a level, easy, medium, hard or expert, and or settings: depth=n,nodes=n,blunder=percent" << std::endl;
+	}
+
+	/** Splits "name=value" at the first '='; the value is empty if there is none */
+	void splitOption(const std::string &option, std::string &name, std::string &value) {
+		std::string::size_type equals = option.find('=');
+		name = option.substr(0, equals);
+		value = (equals == std::string::npos ? std::string() : option.substr(equals + 1));
+	}
+
+	/** Parses a player such as "hard" or "medium,nodes=50000" or "depth=4,blunder=0" */
+	bool parsePlayer(const std::string &text, DifficultySettings &settings) {
+		static const char *levels[] = { "easy", "medium", "hard", "expert" };
+
+		settings = ComputerPlayer::getSettings(MEDIUM);
+		std::istringstream items(text);
+		std::string item;
+		while(std::getline(items, item, ',')) {
+			std::string name;
+			std::string value;
+			splitOption(item, name, value);
+
+			bool found = false;
+			for(unsigned int level = EASY; level <= EXPERT && value.empty(); level++) {
+				if(name == levels[level]) {
+					settings = ComputerPlayer::getSettings((Difficulty)level);
+					found = true;
+				}
+			}
+			if(found)
+				continue;
+			if(value.empty())
+				return false;
+
+			if(name == "depth")
+				settings.depth = (unsigned int)std::atoi(value.c_str());
+			else if(name == "nodes")
+				settings.nodes = (boost::uint64_t)std::atof(value.c_str());
+			else if(name == "blunder")
+				settings.blunderPercent = (unsigned int)std::atoi(value.c_str());
+			else
+				return false;
+		}
+		return true;
+	}
+
+	bool parseOption(const std::string &option, TournamentSettings &settings) {
+		std::string name;
+		std::string value;
+		splitOption(option, name, value);
+		if(value.empty())
+			return false;
+
+		if(name == "games")
+			settings.maxGames = (unsigned int)std::atoi(value.c_str());
+		else if(name == "threads")
+			settings.numThreads = (unsigned int)std::atoi(value.c_str());
+		else if(name == "hash")
+			settings.hashMegabytes = (unsigned int)std::atoi(value.c_str());
+		else if(name == "openings") {
+			settings.openingMoves = (unsigned int)std::atoi(value.c_str());
+			if(settings.openingMoves > Position::NUM_SQUARES - 1)
+				return false;
+		}
+		else if(name == "seed")
+			settings.seed = (boost::uint32_t)std::strtoul(value.c_str(), NULL, 10);
+		else if(name == "report")
+			settings.reportInterval = (unsigned int)std::atoi(value.c_str());
+		else if(name == "alpha")
+			settings.sprt.alpha = std::atof(value.c_str());
+		else if(name == "beta")
+			settings.sprt.beta = std::atof(value.c_str());
+		else if(name == "sprt") {
+			std::string::size_type comma = value.find(',');
+			if(comma == std::string::npos)
+				return false;
+			settings.sprt.enabled = true;
+			settings.sprt.elo0 = std::atof(value.substr(0, comma).c_str());
+			settings.sprt.elo1 = std::atof(value.substr(comma + 1).c_str());
+		} else
+			return false;
+		return true;
+	}
+
+}
+
+/** Entry point for the tournament runner: plays two engine settings against each other and estimates the Elo difference */
+int main(int argc, char **argv) {
+	TournamentSettings settings;
+	if(argc < 3 || !parsePlayer(argv[1], settings.players[0]) || !parsePlayer(argv[2], settings.players[1])) {
+		printUsage();
+		return 2;
+	}
+	for(int i = 3; i < argc; i++) {
+		if(!parseOption(argv[i], settings)) {
+			std::cerr << "bad option " << argv[i] << std::endl;
+			printUsage();
+			return 2;
+		}
+	}
+
+	Tournament runner(settings);
+	tournament = &runner;
+	std::signal(SIGINT, handleSignal);
+	std::signal(SIGTERM, handleSignal);
+
+	runner.run(&std::cout);
+
+	tournament = NULL;
+	return 0;
+}